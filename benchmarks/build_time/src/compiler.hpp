@@ -0,0 +1,92 @@
+//Copyright Florian Goujeon 2021 - 2023.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+#ifndef BUILD_TIME_COMPILER_HPP
+#define BUILD_TIME_COMPILER_HPP
+
+#include <string>
+#include <vector>
+#include <chrono>
+#include <stdexcept>
+#include <cerrno>
+#include <cstring>
+#include <sys/types.h>
+#include <sys/resource.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+namespace build_time
+{
+
+struct compilation_result
+{
+    //Duration of the compilation, as seen from the outside
+    double wall_time_s = 0;
+
+    //Peak resident set size of the compiler, in kilobytes
+    long max_rss_kb = 0;
+
+    //Exit status of the compiler, or -1 if it didn't exit normally
+    int exit_status = -1;
+};
+
+/*
+Run the given command (e.g. a compiler invocation) in a child process and wait
+for it to finish, measuring its resource usage.
+
+We use fork()/execvp()/wait4() rather than std::system() so that the reported
+memory usage is the one of the command itself, not of a shell.
+*/
+inline compilation_result run_command(const std::vector<std::string>& args)
+{
+    auto argv = std::vector<char*>{};
+    argv.reserve(args.size() + 1);
+    for(const auto& arg: args)
+    {
+        argv.push_back(const_cast<char*>(arg.c_str())); //NOLINT(cppcoreguidelines-pro-type-const-cast)
+    }
+    argv.push_back(nullptr);
+
+    const auto start_time = std::chrono::steady_clock::now();
+
+    const auto pid = fork();
+    if(pid < 0)
+    {
+        throw std::runtime_error{std::string{"fork() failed: "} + std::strerror(errno)};
+    }
+
+    if(pid == 0)
+    {
+        //Child process
+        execvp(argv[0], argv.data());
+        _exit(127); //Only reached if execvp() failed
+    }
+
+    auto status = 0;
+    auto usage = rusage{};
+    while(wait4(pid, &status, 0, &usage) < 0)
+    {
+        if(errno != EINTR)
+        {
+            throw std::runtime_error{std::string{"wait4() failed: "} + std::strerror(errno)};
+        }
+    }
+
+    const auto end_time = std::chrono::steady_clock::now();
+
+    auto result = compilation_result{};
+    result.wall_time_s = std::chrono::duration<double>{end_time - start_time}.count();
+    result.max_rss_kb = usage.ru_maxrss; //Kilobytes on Linux, bytes on macOS
+#ifdef __APPLE__
+    result.max_rss_kb /= 1024;
+#endif
+    result.exit_status = WIFEXITED(status) ? WEXITSTATUS(status) : -1; //NOLINT(hicpp-signed-bitwise)
+    return result;
+}
+
+} //namespace
+
+#endif
@@ -0,0 +1,191 @@
+//Copyright Florian Goujeon 2021 - 2023.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+#ifndef BUILD_TIME_GENERATOR_HPP
+#define BUILD_TIME_GENERATOR_HPP
+
+#include <string>
+#include <sstream>
+#include <cstddef>
+
+namespace build_time
+{
+
+/*
+Shape of a synthetic state machine.
+
+The root machine has region_count regions. Each region has state_count states
+and transition_count transitions, triggered by event_count event types (shared
+by all the regions).
+
+If depth is greater than 0, the last state of the first region is a submachine
+of the same shape (with a single region), recursively, depth times.
+*/
+struct machine_params
+{
+    std::string name;
+    std::size_t state_count = 0;
+    std::size_t transition_count = 0;
+    std::size_t region_count = 0;
+    std::size_t event_count = 0;
+    std::size_t depth = 0;
+};
+
+namespace generator_detail
+{
+    inline std::string state_name(const std::size_t level, const std::size_t region_index, const std::size_t state_index)
+    {
+        return "l" + std::to_string(level) + "_r" + std::to_string(region_index) + "_s" + std::to_string(state_index);
+    }
+
+    inline std::string event_name(const std::size_t event_index)
+    {
+        return "e" + std::to_string(event_index);
+    }
+
+    inline std::string transition_table_name(const std::size_t level, const std::size_t region_index)
+    {
+        return "transition_table_l" + std::to_string(level) + "_r" + std::to_string(region_index);
+    }
+
+    inline std::string submachine_name(const std::size_t level)
+    {
+        return "submachine_l" + std::to_string(level);
+    }
+
+    /*
+    Write the states and the transition table of the given region.
+    The transitions go through the states in a pseudo-random order.
+    */
+    inline void write_region
+    (
+        std::ostringstream& out,
+        const machine_params& params,
+        const std::size_t level,
+        const std::size_t region_index,
+        const bool has_submachine
+    )
+    {
+        for(auto i = std::size_t{0}; i < params.state_count; ++i)
+        {
+            const auto is_submachine = has_submachine && i == params.state_count - 1;
+            if(!is_submachine)
+            {
+                out << "struct " << state_name(level, region_index, i) << " { static constexpr auto conf = maki::default_state_conf; };\n";
+            }
+        }
+
+        out << "constexpr auto " << transition_table_name(level, region_index) << " = maki::empty_transition_table\n";
+        for(auto i = std::size_t{0}; i < params.transition_count; ++i)
+        {
+            const auto source_index = i % params.state_count;
+            const auto target_index = (i * 7 + 1) % params.state_count;
+
+            const auto state_type_name = [&](const std::size_t state_index)
+            {
+                if(has_submachine && state_index == params.state_count - 1)
+                {
+                    return submachine_name(level + 1);
+                }
+                return state_name(level, region_index, state_index);
+            };
+
+            out << "    .add_c<";
+            out << state_type_name(source_index) << ", ";
+            out << "events::" << event_name(i % params.event_count) << ", ";
+            out << state_type_name(target_index) << ", count>\n";
+        }
+        out << ";\n\n";
+    }
+
+    inline void write_submachines(std::ostringstream& out, const machine_params& params, const std::size_t level)
+    {
+        if(level > params.depth)
+        {
+            return;
+        }
+
+        //Innermost first
+        const auto has_submachine = level < params.depth;
+        if(has_submachine)
+        {
+            write_submachines(out, params, level + 1);
+        }
+
+        write_region(out, params, level, 0, has_submachine);
+
+        out << "struct " << submachine_name(level) << "\n";
+        out << "{\n";
+        out << "    static constexpr auto conf = maki::default_submachine_conf\n";
+        out << "        .set_transition_tables(" << transition_table_name(level, 0) << ")\n";
+        out << "    ;\n";
+        out << "};\n\n";
+    }
+}
+
+/*
+Generate a translation unit that defines a machine of the given shape and
+processes every event type once.
+*/
+inline std::string generate_source(const machine_params& params)
+{
+    using namespace generator_detail;
+
+    auto out = std::ostringstream{};
+
+    out << "//Generated by maki-build-bench: " << params.name << "\n";
+    out << "#include <maki.hpp>\n\n";
+    out << "struct context { int value = 0; };\n\n";
+    out << "inline void count(context& ctx) { ++ctx.value; }\n\n";
+
+    out << "namespace events\n{\n";
+    for(auto i = std::size_t{0}; i < params.event_count; ++i)
+    {
+        out << "struct " << event_name(i) << "{};\n";
+    }
+    out << "}\n\n";
+
+    out << "namespace states\n{\n";
+    write_submachines(out, params, 1);
+    for(auto r = std::size_t{0}; r < params.region_count; ++r)
+    {
+        write_region(out, params, 0, r, r == 0 && params.depth > 0);
+    }
+    out << "}\n\n";
+
+    out << "struct machine_def\n";
+    out << "{\n";
+    out << "    static constexpr auto conf = maki::default_machine_conf\n";
+    out << "        .set_transition_tables(";
+    for(auto r = std::size_t{0}; r < params.region_count; ++r)
+    {
+        if(r != 0)
+        {
+            out << ", ";
+        }
+        out << "states::" << transition_table_name(0, r);
+    }
+    out << ")\n";
+    out << "        .set_context<context>()\n";
+    out << "    ;\n";
+    out << "};\n\n";
+
+    out << "int main()\n";
+    out << "{\n";
+    out << "    auto machine = maki::machine<machine_def>{};\n";
+    for(auto i = std::size_t{0}; i < params.event_count; ++i)
+    {
+        out << "    machine.process_event(events::" << event_name(i) << "{});\n";
+    }
+    out << "    return machine.context().value == 0 ? 1 : 0;\n";
+    out << "}\n";
+
+    return out.str();
+}
+
+} //namespace
+
+#endif
@@ -0,0 +1,187 @@
+//Copyright Florian Goujeon 2021 - 2023.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+#include "generator.hpp"
+#include "compiler.hpp"
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string_view>
+#include <string>
+#include <vector>
+#include <exception>
+#include <cstdlib>
+
+/*
+Usage: maki-build-bench [options]
+
+Options:
+    --output <file>        CSV file to write the results into (default: stdout)
+    --work-dir <dir>       Directory of the generated sources (default: ./maki-build-bench)
+    --compiler <path>      C++ compiler (default: the one of the CMake build)
+    --flag <flag>          Extra compiler flag (can be repeated, e.g. --flag -O2)
+    --states <n>           \
+    --transitions <n>       |
+    --regions <n>           | Run a single machine of the given shape instead of
+    --events <n>            | the default set (missing values default to 1, and
+    --depth <n>            /  only the depth can be 0)
+*/
+
+namespace
+{
+    namespace fs = std::filesystem;
+
+    std::vector<build_time::machine_params> default_machine_params()
+    {
+        //name, states, transitions, regions, events, depth
+        return
+        {
+            {"baseline",          2,   2, 1,  1, 0},
+            {"states_25",        25,  25, 1,  5, 0},
+            {"states_100",      100, 100, 1, 10, 0},
+            {"transitions_100",  10, 100, 1, 10, 0},
+            {"transitions_200",  20, 200, 1, 20, 0},
+            {"transitions_400",  40, 400, 1, 40, 0},
+            {"events_50",        10,  50, 1, 50, 0},
+            {"regions_4",        10,  25, 4, 10, 0},
+            {"regions_16",       10,  25, 16, 10, 0},
+            {"depth_4",          10,  25, 1, 10, 4},
+            {"depth_8",          10,  25, 1, 10, 8}
+        };
+    }
+
+    struct options
+    {
+        std::string output_path;
+        std::string work_dir = "maki-build-bench";
+        std::string compiler = MAKI_BUILD_BENCH_CXX_COMPILER;
+        std::vector<std::string> extra_flags;
+        bool custom_params = false;
+        build_time::machine_params params{"custom", 1, 1, 1, 1, 0};
+    };
+
+    options parse_options(const int argc, char** const argv)
+    {
+        auto opts = options{};
+
+        for(auto i = 1; i < argc; ++i)
+        {
+            const auto arg = std::string_view{argv[i]}; //NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+            if(i + 1 == argc)
+            {
+                throw std::runtime_error{"Missing value for " + std::string{arg}};
+            }
+            const auto value = std::string{argv[++i]}; //NOLINT(cppcoreguidelines-pro-bounds-pointer-arithmetic)
+
+            const auto to_count = [&](const std::size_t min_count)
+            {
+                opts.custom_params = true;
+                const auto count = static_cast<std::size_t>(std::stoul(value));
+                if(count < min_count)
+                {
+                    throw std::runtime_error{"Value of " + std::string{arg} + " must be at least " + std::to_string(min_count)};
+                }
+                return count;
+            };
+
+            if(arg == "--output") { opts.output_path = value; }
+            else if(arg == "--work-dir") { opts.work_dir = value; }
+            else if(arg == "--compiler") { opts.compiler = value; }
+            else if(arg == "--flag") { opts.extra_flags.push_back(value); }
+            else if(arg == "--states") { opts.params.state_count = to_count(1); }
+            else if(arg == "--transitions") { opts.params.transition_count = to_count(1); }
+            else if(arg == "--regions") { opts.params.region_count = to_count(1); }
+            else if(arg == "--events") { opts.params.event_count = to_count(1); }
+            else if(arg == "--depth") { opts.params.depth = to_count(0); }
+            else
+            {
+                throw std::runtime_error{"Unknown option " + std::string{arg}};
+            }
+        }
+
+        return opts;
+    }
+
+    build_time::compilation_result compile
+    (
+        const options& opts,
+        const build_time::machine_params& params
+    )
+    {
+        const auto source_path = fs::path{opts.work_dir} / (params.name + ".cpp");
+        const auto object_path = fs::path{opts.work_dir} / (params.name + ".o");
+
+        {
+            auto source_file = std::ofstream{source_path};
+            source_file << build_time::generate_source(params);
+        }
+
+        auto args = std::vector<std::string>
+        {
+            opts.compiler,
+            "-std=c++17",
+            "-I", MAKI_BUILD_BENCH_INCLUDE_DIR,
+            "-c", source_path.string(),
+            "-o", object_path.string()
+        };
+        args.insert(args.end(), opts.extra_flags.begin(), opts.extra_flags.end());
+
+        return build_time::run_command(args);
+    }
+}
+
+int main(int argc, char** argv)
+{
+    try
+    {
+        const auto opts = parse_options(argc, argv);
+
+        fs::create_directories(opts.work_dir);
+
+        auto output_file = std::ofstream{};
+        if(!opts.output_path.empty())
+        {
+            output_file.open(opts.output_path);
+        }
+        auto& out = opts.output_path.empty() ? std::cout : output_file;
+
+        out << "name,states,transitions,regions,events,depth,wall_time_s,max_rss_kb,exit_status\n";
+
+        const auto machine_params_list = opts.custom_params ?
+            std::vector<build_time::machine_params>{opts.params} :
+            default_machine_params()
+        ;
+
+        auto all_succeeded = true;
+        for(const auto& params: machine_params_list)
+        {
+            std::cerr << "Compiling " << params.name << "...\n";
+
+            const auto result = compile(opts, params);
+            all_succeeded = all_succeeded && result.exit_status == 0;
+
+            out
+                << params.name << ','
+                << params.state_count << ','
+                << params.transition_count << ','
+                << params.region_count << ','
+                << params.event_count << ','
+                << params.depth << ','
+                << result.wall_time_s << ','
+                << result.max_rss_kb << ','
+                << result.exit_status << '\n'
+            ;
+            out.flush();
+        }
+
+        return all_succeeded ? EXIT_SUCCESS : EXIT_FAILURE;
+    }
+    catch(const std::exception& e)
+    {
+        std::cerr << "maki-build-bench: " << e.what() << '\n';
+        return EXIT_FAILURE;
+    }
+}
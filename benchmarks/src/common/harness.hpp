@@ -0,0 +1,74 @@
+//Copyright Florian Goujeon 2021 - 2023.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+#ifndef BENCHMARKS_COMMON_HARNESS_HPP
+#define BENCHMARKS_COMMON_HARNESS_HPP
+
+#include <vector>
+#include <cstddef>
+
+/*
+A minimal benchmark harness.
+
+A benchmark is a function that executes the measured operation the given
+number of times:
+    MAKI_BENCHMARK(my_benchmark)(const std::size_t iteration_count)
+    {
+        for(auto i = std::size_t{0}; i < iteration_count; ++i)
+        {
+            //...
+        }
+    }
+
+The harness increases the iteration count until the measured duration is long
+enough to be significant, and reports the average duration of an iteration.
+*/
+
+namespace bench
+{
+
+using benchmark_fn_t = void(*)(std::size_t);
+
+struct benchmark
+{
+    const char* name = nullptr;
+    benchmark_fn_t pfn = nullptr;
+};
+
+inline std::vector<benchmark>& benchmarks()
+{
+    static auto instance = std::vector<benchmark>{};
+    return instance;
+}
+
+struct registrar
+{
+    registrar(const char* const name, const benchmark_fn_t pfn)
+    {
+        benchmarks().push_back(benchmark{name, pfn});
+    }
+};
+
+//Prevent the compiler from optimizing away the computation of value
+template<class T>
+void do_not_optimize(T& value)
+{
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "r,m"(value) : "memory");
+#else
+    static volatile auto sink = static_cast<const void*>(nullptr);
+    sink = &value;
+#endif
+}
+
+} //namespace
+
+#define MAKI_BENCHMARK(name) /*NOLINT(cppcoreguidelines-macro-usage)*/ \
+    void name(std::size_t); \
+    const auto name##_registrar = bench::registrar{#name, &name}; \
+    void name
+
+#endif
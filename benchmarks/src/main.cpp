@@ -0,0 +1,59 @@
+//Copyright Florian Goujeon 2021 - 2023.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+#include "common/harness.hpp"
+#include <chrono>
+#include <string_view>
+#include <cstdio>
+
+namespace
+{
+    using clock_t = std::chrono::steady_clock;
+
+    constexpr auto min_duration = std::chrono::milliseconds{200};
+
+    double run(const bench::benchmark& bm)
+    {
+        //Warm up
+        bm.pfn(1);
+
+        auto iteration_count = std::size_t{1};
+        while(true)
+        {
+            const auto start = clock_t::now();
+            bm.pfn(iteration_count);
+            const auto duration = clock_t::now() - start;
+
+            if(duration >= min_duration)
+            {
+                const auto ns = std::chrono::duration<double, std::nano>{duration}.count();
+                return ns / static_cast<double>(iteration_count);
+            }
+
+            iteration_count *= 2;
+        }
+    }
+}
+
+//Usage: maki-bench [name-filter]
+int main(int argc, char** argv)
+{
+    const auto filter = argc > 1 ? std::string_view{argv[1]} : std::string_view{}; //NOLINT
+
+    std::printf("%-48s %12s\n", "benchmark", "ns/iteration");
+    for(const auto& bm: bench::benchmarks())
+    {
+        if(std::string_view{bm.name}.find(filter) == std::string_view::npos)
+        {
+            continue;
+        }
+
+        std::printf("%-48s %12.2f\n", bm.name, run(bm));
+        std::fflush(stdout);
+    }
+
+    return 0;
+}
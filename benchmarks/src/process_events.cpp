@@ -0,0 +1,171 @@
+//Copyright Florian Goujeon 2021 - 2023.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+#include "common/harness.hpp"
+#include <maki.hpp>
+#include <variant>
+#include <vector>
+
+/*
+Compares the processing of a batch of events through one process_event() call
+per event and through a single process_events() call.
+One iteration is the processing of one event.
+*/
+
+namespace
+{
+    constexpr auto batch_size = std::size_t{256};
+
+    struct context
+    {
+        int value = 0;
+    };
+
+    namespace events
+    {
+        struct toggle
+        {
+            int value = 0;
+        };
+
+        struct add
+        {
+            int value = 0;
+        };
+    }
+
+    namespace states
+    {
+        struct off { static constexpr auto conf = maki::default_state_conf; };
+        struct on { static constexpr auto conf = maki::default_state_conf; };
+    }
+
+    namespace actions
+    {
+        void toggle(context& ctx, const events::toggle& event)
+        {
+            ctx.value += event.value;
+        }
+
+        void add(context& ctx, const events::add& event)
+        {
+            ctx.value += event.value;
+        }
+    }
+
+    constexpr auto transition_table = maki::empty_transition_table
+        .add_c<states::off, events::toggle, states::on,  actions::toggle>
+        .add_c<states::on,  events::toggle, states::off, actions::toggle>
+        .add_c<maki::any,   events::add,    maki::null,  actions::add>
+    ;
+
+    struct machine_def
+    {
+        static constexpr auto conf = maki::default_machine_conf
+            .set_transition_tables(transition_table)
+            .set_context<context>()
+        ;
+    };
+
+    using machine_t = maki::machine<machine_def>;
+
+    using event_variant = std::variant<events::toggle, events::add>;
+
+    const auto toggle_batch = std::vector<events::toggle>(batch_size, events::toggle{1});
+
+    const auto variant_batch = []
+    {
+        auto batch = std::vector<event_variant>{};
+        for(auto i = std::size_t{0}; i < batch_size; ++i)
+        {
+            if(i % 2 == 0)
+            {
+                batch.emplace_back(events::toggle{1});
+            }
+            else
+            {
+                batch.emplace_back(events::add{1});
+            }
+        }
+        return batch;
+    }();
+
+    template<class Batch, class F>
+    void run_batches(const std::size_t iteration_count, const Batch& batch, const F& process)
+    {
+        auto machine = machine_t{};
+        for(auto i = std::size_t{0}; i < iteration_count; i += batch_size)
+        {
+            process(machine, batch);
+        }
+        bench::do_not_optimize(machine.context().value);
+    }
+
+    MAKI_BENCHMARK(process_event_loop)(const std::size_t iteration_count)
+    {
+        run_batches
+        (
+            iteration_count,
+            toggle_batch,
+            [](machine_t& machine, const auto& batch)
+            {
+                for(const auto& event: batch)
+                {
+                    machine.process_event(event);
+                }
+            }
+        );
+    }
+
+    MAKI_BENCHMARK(process_events)(const std::size_t iteration_count)
+    {
+        run_batches
+        (
+            iteration_count,
+            toggle_batch,
+            [](machine_t& machine, const auto& batch)
+            {
+                machine.process_events(batch);
+            }
+        );
+    }
+
+    MAKI_BENCHMARK(process_event_loop_variant)(const std::size_t iteration_count)
+    {
+        run_batches
+        (
+            iteration_count,
+            variant_batch,
+            [](machine_t& machine, const auto& batch)
+            {
+                for(const auto& event: batch)
+                {
+                    std::visit
+                    (
+                        [&machine](const auto& alternative)
+                        {
+                            machine.process_event(alternative);
+                        },
+                        event
+                    );
+                }
+            }
+        );
+    }
+
+    MAKI_BENCHMARK(process_events_variant)(const std::size_t iteration_count)
+    {
+        run_batches
+        (
+            iteration_count,
+            variant_batch,
+            [](machine_t& machine, const auto& batch)
+            {
+                machine.process_events(batch);
+            }
+        );
+    }
+}
@@ -0,0 +1,144 @@
+//Copyright Florian Goujeon 2021 - 2023.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+#include "../common/harness.hpp"
+#include <maki.hpp>
+#include <array>
+
+/*
+A chain of nested submachines, where every event triggers a transition in the
+innermost one.
+One iteration is the processing of one event.
+*/
+
+namespace
+{
+    constexpr auto depth = 6;
+
+    struct context
+    {
+        int value = 0;
+    };
+
+    namespace events
+    {
+        struct toggle{};
+        struct reset{};
+    }
+
+    void count(context& ctx)
+    {
+        ++ctx.value;
+    }
+
+    namespace states
+    {
+        struct off { static constexpr auto conf = maki::default_state_conf; };
+        struct on { static constexpr auto conf = maki::default_state_conf; };
+
+        constexpr auto innermost_transition_table = maki::empty_transition_table
+            .add_c<off, events::toggle, on,  count>
+            .add_c<on,  events::toggle, off, count>
+        ;
+
+        template<int Level>
+        struct level;
+
+        template<int Level>
+        constexpr auto make_transition_table()
+        {
+            if constexpr(Level == depth)
+            {
+                return innermost_transition_table;
+            }
+            else
+            {
+                return maki::empty_transition_table
+                    .add_c<level<Level + 1>, events::reset, level<Level + 1>>
+                ;
+            }
+        }
+
+        template<int Level>
+        struct level
+        {
+            static constexpr auto conf = maki::default_submachine_conf
+                .set_transition_tables(make_transition_table<Level>())
+            ;
+        };
+    }
+
+    struct machine_def
+    {
+        static constexpr auto conf = maki::default_machine_conf
+            .set_transition_tables
+            (
+                maki::empty_transition_table
+                    .add_c<states::level<1>, events::reset, states::level<1>>
+            )
+            .set_context<context>()
+        ;
+    };
+
+    MAKI_BENCHMARK(deep_nesting_maki)(const std::size_t iteration_count)
+    {
+        auto machine = maki::machine<machine_def>{};
+        for(auto i = std::size_t{0}; i < iteration_count; ++i)
+        {
+            machine.process_event(events::toggle{});
+        }
+        bench::do_not_optimize(machine.context().value);
+    }
+
+    MAKI_BENCHMARK(deep_nesting_switch)(const std::size_t iteration_count)
+    {
+        enum class level_state
+        {
+            stopped,
+            nested
+        };
+
+        enum class innermost_state
+        {
+            off,
+            on
+        };
+
+        auto ctx = context{};
+        auto level_states = std::array<level_state, depth>{};
+        level_states.fill(level_state::nested);
+        auto state = innermost_state::off;
+
+        for(auto i = std::size_t{0}; i < iteration_count; ++i)
+        {
+            //Don't let the compiler track the states across iterations
+            bench::do_not_optimize(level_states);
+            bench::do_not_optimize(state);
+
+            //Go down to the innermost level
+            auto nested = true;
+            for(const auto level_state: level_states)
+            {
+                if(level_state != level_state::nested)
+                {
+                    nested = false;
+                    break;
+                }
+            }
+            if(!nested)
+            {
+                continue;
+            }
+
+            switch(state)
+            {
+                case innermost_state::off: state = innermost_state::on; count(ctx); break;
+                case innermost_state::on: state = innermost_state::off; count(ctx); break;
+            }
+        }
+        bench::do_not_optimize(ctx.value);
+    }
+}
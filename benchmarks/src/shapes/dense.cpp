@@ -0,0 +1,150 @@
+//Copyright Florian Goujeon 2021 - 2023.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+#include "../common/harness.hpp"
+#include <maki.hpp>
+
+/*
+A fully connected state machine, where every event type triggers a transition
+from every state.
+One iteration is the processing of one event.
+*/
+
+namespace
+{
+    constexpr auto state_count = 6;
+    constexpr auto event_count = 6;
+
+    struct context
+    {
+        int value = 0;
+    };
+
+    namespace events
+    {
+        template<int Index>
+        struct event{};
+    }
+
+    namespace states
+    {
+        template<int Index>
+        struct state
+        {
+            static constexpr auto conf = maki::default_state_conf;
+        };
+    }
+
+    void count(context& ctx)
+    {
+        ++ctx.value;
+    }
+
+    constexpr int target_state_index(const int source_state_index, const int event_index)
+    {
+        return (source_state_index + event_index + 1) % state_count;
+    }
+
+    template<int Index = 0, class TransitionTable>
+    constexpr auto make_transition_table(const TransitionTable table)
+    {
+        if constexpr(Index == state_count * event_count)
+        {
+            return table;
+        }
+        else
+        {
+            constexpr auto source_state_index = Index / event_count;
+            constexpr auto event_index = Index % event_count;
+            return make_transition_table<Index + 1>
+            (
+                table.template add_c
+                <
+                    states::state<source_state_index>,
+                    events::event<event_index>,
+                    states::state<target_state_index(source_state_index, event_index)>,
+                    count
+                >
+            );
+        }
+    }
+
+    constexpr auto transition_table = make_transition_table(maki::empty_transition_table);
+
+    struct machine_def
+    {
+        static constexpr auto conf = maki::default_machine_conf
+            .set_transition_tables(transition_table)
+            .set_context<context>()
+        ;
+    };
+
+    //Process event<0>, event<1>, ..., event<event_count - 1>
+    template<class F, int... EventIndexes>
+    void for_each_event(F& fun, std::integer_sequence<int, EventIndexes...> /*indexes*/)
+    {
+        (fun(events::event<EventIndexes>{}), ...);
+    }
+
+    MAKI_BENCHMARK(dense_maki)(const std::size_t iteration_count)
+    {
+        auto machine = maki::machine<machine_def>{};
+        auto process = [&machine](const auto& event)
+        {
+            machine.process_event(event);
+        };
+        for(auto i = std::size_t{0}; i < iteration_count; i += event_count)
+        {
+            for_each_event(process, std::make_integer_sequence<int, event_count>{});
+        }
+        bench::do_not_optimize(machine.context().value);
+    }
+
+    class switch_machine
+    {
+    public:
+        template<int EventIndex>
+        void process_event(const events::event<EventIndex>& /*event*/)
+        {
+            //Don't let the compiler track the state across calls
+            bench::do_not_optimize(state_);
+
+            switch(state_)
+            {
+                case 0: state_ = target_state_index(0, EventIndex); count(ctx_); break;
+                case 1: state_ = target_state_index(1, EventIndex); count(ctx_); break;
+                case 2: state_ = target_state_index(2, EventIndex); count(ctx_); break;
+                case 3: state_ = target_state_index(3, EventIndex); count(ctx_); break;
+                case 4: state_ = target_state_index(4, EventIndex); count(ctx_); break;
+                case 5: state_ = target_state_index(5, EventIndex); count(ctx_); break;
+                default: break;
+            }
+        }
+
+        context& ctx()
+        {
+            return ctx_;
+        }
+
+    private:
+        int state_ = 0;
+        context ctx_;
+    };
+
+    MAKI_BENCHMARK(dense_switch)(const std::size_t iteration_count)
+    {
+        auto machine = switch_machine{};
+        auto process = [&machine](const auto& event)
+        {
+            machine.process_event(event);
+        };
+        for(auto i = std::size_t{0}; i < iteration_count; i += event_count)
+        {
+            for_each_event(process, std::make_integer_sequence<int, event_count>{});
+        }
+        bench::do_not_optimize(machine.ctx().value);
+    }
+}
@@ -0,0 +1,136 @@
+//Copyright Florian Goujeon 2021 - 2023.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+#include "../common/harness.hpp"
+#include <maki.hpp>
+
+/*
+A state machine where the target state of each transition is selected by a
+guard, among many guarded transitions for the same event type.
+One iteration is the processing of one event.
+*/
+
+namespace
+{
+    constexpr auto state_count = 8;
+
+    struct context
+    {
+        int value = 0;
+    };
+
+    namespace events
+    {
+        struct input
+        {
+            int value = 0;
+        };
+    }
+
+    namespace states
+    {
+        template<int Index>
+        struct state
+        {
+            static constexpr auto conf = maki::default_state_conf;
+        };
+    }
+
+    namespace guards
+    {
+        template<int Value>
+        bool has_value(context& /*ctx*/, const events::input& event)
+        {
+            return event.value == Value;
+        }
+    }
+
+    void count(context& ctx)
+    {
+        ++ctx.value;
+    }
+
+    template<int Index = 0, class TransitionTable>
+    constexpr auto make_transition_table(const TransitionTable table)
+    {
+        if constexpr(Index == state_count)
+        {
+            return table;
+        }
+        else
+        {
+            return make_transition_table<Index + 1>
+            (
+                table.template add_c
+                <
+                    maki::any,
+                    events::input,
+                    states::state<Index>,
+                    count,
+                    guards::has_value<Index>
+                >
+            );
+        }
+    }
+
+    //The initial state is the source of the first transition, which must not be
+    //a pattern
+    constexpr auto transition_table = make_transition_table
+    (
+        maki::empty_transition_table
+            .add_c<states::state<0>, events::input, states::state<0>, count, guards::has_value<-1>>
+    );
+
+    struct machine_def
+    {
+        static constexpr auto conf = maki::default_machine_conf
+            .set_transition_tables(transition_table)
+            .set_context<context>()
+        ;
+    };
+
+    int input_value(const std::size_t iteration_index)
+    {
+        //Use a pseudo-random sequence to defeat branch prediction a bit
+        return static_cast<int>((iteration_index * 5) % state_count);
+    }
+
+    MAKI_BENCHMARK(guards_maki)(const std::size_t iteration_count)
+    {
+        auto machine = maki::machine<machine_def>{};
+        for(auto i = std::size_t{0}; i < iteration_count; ++i)
+        {
+            machine.process_event(events::input{input_value(i)});
+        }
+        bench::do_not_optimize(machine.context().value);
+    }
+
+    MAKI_BENCHMARK(guards_switch)(const std::size_t iteration_count)
+    {
+        auto ctx = context{};
+        auto state = 0;
+        for(auto i = std::size_t{0}; i < iteration_count; ++i)
+        {
+            //Don't let the compiler track the state across iterations
+            bench::do_not_optimize(state);
+
+            const auto event = events::input{input_value(i)};
+            switch(state)
+            {
+                case 0: case 1: case 2: case 3: case 4: case 5: case 6: case 7:
+                    if(event.value >= 0 && event.value < state_count)
+                    {
+                        state = event.value;
+                        count(ctx);
+                    }
+                    break;
+                default:
+                    break;
+            }
+        }
+        bench::do_not_optimize(ctx.value);
+    }
+}
@@ -0,0 +1,130 @@
+//Copyright Florian Goujeon 2021 - 2023.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+#include "../common/harness.hpp"
+#include <maki.hpp>
+
+/*
+A chain of states, where each event moves to the next state (and the last state
+loops back to the first one).
+One iteration is the processing of one event.
+*/
+
+namespace
+{
+    constexpr auto state_count = 16;
+
+    struct context
+    {
+        int value = 0;
+    };
+
+    namespace events
+    {
+        struct next{};
+    }
+
+    namespace states
+    {
+        template<int Index>
+        struct state
+        {
+            static constexpr auto conf = maki::default_state_conf;
+        };
+    }
+
+    void count(context& ctx)
+    {
+        ++ctx.value;
+    }
+
+    template<int Index = 0, class TransitionTable>
+    constexpr auto make_transition_table(const TransitionTable table)
+    {
+        if constexpr(Index == state_count)
+        {
+            return table;
+        }
+        else
+        {
+            return make_transition_table<Index + 1>
+            (
+                table.template add_c
+                <
+                    states::state<Index>,
+                    events::next,
+                    states::state<(Index + 1) % state_count>,
+                    count
+                >
+            );
+        }
+    }
+
+    constexpr auto transition_table = make_transition_table(maki::empty_transition_table);
+
+    constexpr auto base_conf = maki::default_machine_conf
+        .set_transition_tables(transition_table)
+        .set_context<context>()
+    ;
+
+    template<bool RunToCompletion>
+    struct machine_def
+    {
+        static constexpr auto conf = RunToCompletion ?
+            base_conf :
+            base_conf.disable_run_to_completion()
+        ;
+    };
+
+    template<bool RunToCompletion>
+    void run_maki(const std::size_t iteration_count)
+    {
+        auto machine = maki::machine<machine_def<RunToCompletion>>{};
+        for(auto i = std::size_t{0}; i < iteration_count; ++i)
+        {
+            machine.process_event(events::next{});
+        }
+        bench::do_not_optimize(machine.context().value);
+    }
+
+    MAKI_BENCHMARK(linear_chain_maki)(const std::size_t iteration_count)
+    {
+        run_maki<true>(iteration_count);
+    }
+
+    MAKI_BENCHMARK(linear_chain_maki_no_run_to_completion)(const std::size_t iteration_count)
+    {
+        run_maki<false>(iteration_count);
+    }
+
+    MAKI_BENCHMARK(linear_chain_switch)(const std::size_t iteration_count)
+    {
+        auto ctx = context{};
+        auto state = 0;
+        for(auto i = std::size_t{0}; i < iteration_count; ++i)
+        {
+            //Don't let the compiler track the state across iterations
+            bench::do_not_optimize(state);
+
+            switch(state)
+            {
+                case 0: case 1: case 2: case 3: case 4: case 5: case 6:
+                case 7: case 8: case 9: case 10: case 11: case 12: case 13:
+                case 14:
+                    ++state;
+                    count(ctx);
+                    break;
+                case 15:
+                    state = 0;
+                    count(ctx);
+                    break;
+                default:
+                    break;
+            }
+        }
+        bench::do_not_optimize(ctx.value);
+    }
+}
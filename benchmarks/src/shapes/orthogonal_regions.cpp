@@ -0,0 +1,105 @@
+//Copyright Florian Goujeon 2021 - 2023.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+#include "../common/harness.hpp"
+#include <maki.hpp>
+#include <array>
+
+/*
+A state machine made of many orthogonal regions, where every event triggers a
+transition in every region.
+One iteration is the processing of one event.
+*/
+
+namespace
+{
+    constexpr auto region_count = 8;
+
+    struct context
+    {
+        int value = 0;
+    };
+
+    namespace events
+    {
+        struct toggle{};
+    }
+
+    namespace states
+    {
+        template<int RegionIndex>
+        struct off
+        {
+            static constexpr auto conf = maki::default_state_conf;
+        };
+
+        template<int RegionIndex>
+        struct on
+        {
+            static constexpr auto conf = maki::default_state_conf;
+        };
+    }
+
+    void count(context& ctx)
+    {
+        ++ctx.value;
+    }
+
+    template<int RegionIndex>
+    constexpr auto transition_table = maki::empty_transition_table
+        .template add_c<states::off<RegionIndex>, events::toggle, states::on<RegionIndex>,  count>
+        .template add_c<states::on<RegionIndex>,  events::toggle, states::off<RegionIndex>, count>
+    ;
+
+    template<int... RegionIndexes>
+    constexpr auto make_conf(std::integer_sequence<int, RegionIndexes...> /*indexes*/)
+    {
+        return maki::default_machine_conf
+            .set_context<context>()
+            .set_transition_tables(transition_table<RegionIndexes>...)
+        ;
+    }
+
+    struct machine_def
+    {
+        static constexpr auto conf = make_conf(std::make_integer_sequence<int, region_count>{});
+    };
+
+    MAKI_BENCHMARK(orthogonal_regions_maki)(const std::size_t iteration_count)
+    {
+        auto machine = maki::machine<machine_def>{};
+        for(auto i = std::size_t{0}; i < iteration_count; ++i)
+        {
+            machine.process_event(events::toggle{});
+        }
+        bench::do_not_optimize(machine.context().value);
+    }
+
+    MAKI_BENCHMARK(orthogonal_regions_switch)(const std::size_t iteration_count)
+    {
+        enum class state
+        {
+            off,
+            on
+        };
+
+        auto ctx = context{};
+        auto region_states = std::array<state, region_count>{};
+        for(auto i = std::size_t{0}; i < iteration_count; ++i)
+        {
+            for(auto& region_state: region_states)
+            {
+                switch(region_state)
+                {
+                    case state::off: region_state = state::on; count(ctx); break;
+                    case state::on: region_state = state::off; count(ctx); break;
+                }
+            }
+            bench::do_not_optimize(region_states);
+        }
+        bench::do_not_optimize(ctx.value);
+    }
+}
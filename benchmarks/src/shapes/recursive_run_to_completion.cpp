@@ -0,0 +1,136 @@
+//Copyright Florian Goujeon 2021 - 2023.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+#include "../common/harness.hpp"
+#include <maki.hpp>
+
+/*
+A state machine whose actions process other events, which the run-to-completion
+mechanism enqueues and processes once the current transition is complete.
+One iteration is the processing of one external event, and thus of one
+enqueued event.
+*/
+
+namespace
+{
+    struct context
+    {
+        int value = 0;
+    };
+
+    namespace events
+    {
+        struct request
+        {
+            int value = 0;
+        };
+
+        struct response
+        {
+            int value = 0;
+        };
+    }
+
+    namespace states
+    {
+        struct idle { static constexpr auto conf = maki::default_state_conf; };
+        struct waiting { static constexpr auto conf = maki::default_state_conf; };
+    }
+
+    namespace actions
+    {
+        constexpr auto send_request = [](auto& mach, context& /*ctx*/, const events::request& event)
+        {
+            mach.process_event(events::response{event.value});
+        };
+
+        void handle_response(context& ctx, const events::response& event)
+        {
+            ctx.value += event.value;
+        }
+    }
+
+    constexpr auto transition_table = maki::empty_transition_table
+        .add_c<states::idle,    events::request,  states::waiting, actions::send_request>
+        .add_c<states::waiting, events::response, states::idle,    actions::handle_response>
+    ;
+
+    struct machine_def
+    {
+        static constexpr auto conf = maki::default_machine_conf
+            .set_transition_tables(transition_table)
+            .set_context<context>()
+        ;
+    };
+
+    MAKI_BENCHMARK(recursive_run_to_completion_maki)(const std::size_t iteration_count)
+    {
+        auto machine = maki::machine<machine_def>{};
+        for(auto i = std::size_t{0}; i < iteration_count; ++i)
+        {
+            machine.process_event(events::request{1});
+        }
+        bench::do_not_optimize(machine.context().value);
+    }
+
+    class switch_machine
+    {
+    public:
+        void process_event(const events::request& event)
+        {
+            //Don't let the compiler track the state across calls
+            bench::do_not_optimize(state_);
+
+            switch(state_)
+            {
+                case state::idle:
+                    state_ = state::waiting;
+                    process_event(events::response{event.value});
+                    break;
+                case state::waiting:
+                    break;
+            }
+        }
+
+        void process_event(const events::response& event)
+        {
+            switch(state_)
+            {
+                case state::idle:
+                    break;
+                case state::waiting:
+                    state_ = state::idle;
+                    actions::handle_response(ctx_, event);
+                    break;
+            }
+        }
+
+        context& ctx()
+        {
+            return ctx_;
+        }
+
+    private:
+        enum class state
+        {
+            idle,
+            waiting
+        };
+
+        state state_ = state::idle;
+        context ctx_;
+    };
+
+    MAKI_BENCHMARK(recursive_run_to_completion_switch)(const std::size_t iteration_count)
+    {
+        auto machine = switch_machine{};
+        for(auto i = std::size_t{0}; i < iteration_count; ++i)
+        {
+            machine.process_event(events::request{1});
+        }
+        bench::do_not_optimize(machine.ctx().value);
+    }
+}
@@ -0,0 +1,94 @@
+//Copyright Florian Goujeon 2021 - 2023.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+#include "common/harness.hpp"
+#include <maki.hpp>
+
+/*
+Measures the overhead of the transition trace.
+One iteration is one state transition.
+*/
+
+namespace
+{
+    struct context
+    {
+        int value = 0;
+    };
+
+    namespace events
+    {
+        struct toggle{};
+    }
+
+    namespace states
+    {
+        struct off { static constexpr auto conf = maki::default_state_conf; };
+        struct on { static constexpr auto conf = maki::default_state_conf; };
+    }
+
+    void count(context& ctx)
+    {
+        ++ctx.value;
+    }
+
+    constexpr auto transition_table = maki::empty_transition_table
+        .add_c<states::off, events::toggle, states::on,  count>
+        .add_c<states::on,  events::toggle, states::off, count>
+    ;
+
+    //A clock that costs nothing, to measure the cost of recording alone
+    std::int64_t sequence_clock()
+    {
+        static auto value = std::int64_t{0};
+        return value++;
+    }
+
+    constexpr auto base_conf = maki::default_machine_conf
+        .set_transition_tables(transition_table)
+        .set_context<context>()
+    ;
+
+    template<const auto& Conf>
+    struct machine_def
+    {
+        static constexpr auto conf = Conf;
+    };
+
+    constexpr auto trace_conf = base_conf
+        .set_trace_capacity(1024)
+    ;
+
+    constexpr auto trace_sequence_clock_conf = trace_conf
+        .set_trace_clock(&sequence_clock)
+    ;
+
+    template<const auto& Conf>
+    void run(const std::size_t iteration_count)
+    {
+        auto machine = maki::machine<machine_def<Conf>>{};
+        for(auto i = std::size_t{0}; i < iteration_count; ++i)
+        {
+            machine.process_event(events::toggle{});
+        }
+        bench::do_not_optimize(machine.context().value);
+    }
+
+    MAKI_BENCHMARK(transition_without_trace)(const std::size_t iteration_count)
+    {
+        run<base_conf>(iteration_count);
+    }
+
+    MAKI_BENCHMARK(transition_with_trace)(const std::size_t iteration_count)
+    {
+        run<trace_conf>(iteration_count);
+    }
+
+    MAKI_BENCHMARK(transition_with_trace_sequence_clock)(const std::size_t iteration_count)
+    {
+        run<trace_sequence_clock_conf>(iteration_count);
+    }
+}
@@ -15,19 +15,28 @@
 */
 
 #include "maki/events.hpp"
+#include "maki/explicit_instantiation.hpp"
 #include "maki/guard.hpp"
+#include "maki/layout_report.hpp"
 #include "maki/machine.hpp"
 #include "maki/machine_conf.hpp"
 #include "maki/machine_fwd.hpp"
+#include "maki/machine_pool.hpp"
 #include "maki/machine_ref.hpp"
 #include "maki/machine_ref_conf.hpp"
+#include "maki/machine_snapshot.hpp"
 #include "maki/pretty_name.hpp"
 #include "maki/region_path.hpp"
 #include "maki/state_conf.hpp"
 #include "maki/states.hpp"
+#include "maki/timer_service.hpp"
+#include "maki/timer_service_conf.hpp"
 #include "maki/submachine_conf.hpp"
+#include "maki/trace_decoder.hpp"
+#include "maki/trace_record.hpp"
 #include "maki/transition_table.hpp"
 #include "maki/type.hpp"
 #include "maki/type_list.hpp"
 #include "maki/type_patterns.hpp"
 #include "maki/version.hpp"
+#include "maki/warm_start.hpp"
@@ -0,0 +1,41 @@
+//Copyright Florian Goujeon 2021 - 2023.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+#ifndef MAKI_DETAIL_BITSET_HPP
+#define MAKI_DETAIL_BITSET_HPP
+
+#include <cstdint>
+#include <cstddef>
+
+namespace maki::detail
+{
+
+/*
+A minimal constexpr-friendly bitset. Unlike std::bitset, it can be built and
+modified in constant expressions in C++17.
+*/
+template<std::size_t Size>
+struct bitset
+{
+    static constexpr std::size_t word_size = 64;
+    static constexpr std::size_t word_count = (Size + word_size - 1) / word_size;
+
+    constexpr void set(const std::size_t index)
+    {
+        words[index / word_size] |= std::uint64_t{1} << (index % word_size); //NOLINT(cppcoreguidelines-pro-bounds-constant-array-index)
+    }
+
+    [[nodiscard]] constexpr bool test(const std::size_t index) const
+    {
+        return ((words[index / word_size] >> (index % word_size)) & 1U) != 0; //NOLINT(cppcoreguidelines-pro-bounds-constant-array-index)
+    }
+
+    std::uint64_t words[word_count == 0 ? 1 : word_count] = {}; //NOLINT(cppcoreguidelines-avoid-c-arrays)
+};
+
+} //namespace
+
+#endif
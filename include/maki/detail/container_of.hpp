@@ -0,0 +1,45 @@
+//Copyright Florian Goujeon 2021 - 2023.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+#ifndef MAKI_DETAIL_CONTAINER_OF_HPP
+#define MAKI_DETAIL_CONTAINER_OF_HPP
+
+#include <cstddef>
+
+/*
+Defines a constexpr variable named `var`, equal to `offsetof(type, member)`.
+
+Using offsetof on a non-standard-layout type is conditionally-supported. All the
+compilers we support do support it as long as the type doesn't have any virtual
+base, but GCC and Clang warn about it.
+*/
+#if defined(__GNUC__)
+#define MAKI_DETAIL_OFFSET_OF(var, type, member) /*NOLINT(cppcoreguidelines-macro-usage)*/ \
+    _Pragma("GCC diagnostic push") \
+    _Pragma("GCC diagnostic ignored \"-Winvalid-offsetof\"") \
+    constexpr auto var = offsetof(type, member); \
+    _Pragma("GCC diagnostic pop")
+#else
+#define MAKI_DETAIL_OFFSET_OF(var, type, member) /*NOLINT(cppcoreguidelines-macro-usage)*/ \
+    constexpr auto var = offsetof(type, member);
+#endif
+
+namespace maki::detail
+{
+
+/*
+Returns the object of type Container whose member subobject (located at the
+given offset) is the given object.
+*/
+template<class Container, class Member>
+Container& container_of(Member& member, const std::size_t offset)
+{
+    return *reinterpret_cast<Container*>(reinterpret_cast<char*>(&member) - offset); //NOLINT(cppcoreguidelines-pro-type-reinterpret-cast, cppcoreguidelines-pro-bounds-pointer-arithmetic)
+}
+
+} //namespace
+
+#endif
@@ -0,0 +1,145 @@
+//Copyright Florian Goujeon 2021 - 2023.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+#ifndef MAKI_DETAIL_DATA_CONTAINER_HPP
+#define MAKI_DETAIL_DATA_CONTAINER_HPP
+
+#include <utility>
+#include <type_traits>
+#include <cstddef>
+
+namespace maki::detail
+{
+
+/*
+A container for an object of any type, with small object optimization, along
+with a pointer to the function that must be called with this object.
+
+The interface is designed so that the types of the arguments given to the
+constructors don't change, whatever FunHolder and Data are.
+This makes build time shorter and binary smaller.
+*/
+template
+<
+    class Arg,
+    std::size_t StaticStorageSize,
+    std::size_t StaticStorageAlignment = alignof(std::max_align_t)
+>
+class data_container
+{
+public:
+    using call_fn_ptr_t = void (*)(const void*, Arg);
+    using delete_fn_ptr_t = void (*)(const void*);
+
+    //To be called when the Data constructor used by set_data() can throw
+    data_container //NOLINT
+    (
+        const call_fn_ptr_t pcall
+    ):
+        pcall_(pcall)
+    {
+    }
+
+    //To be called when the Data constructor used by set_data() cannot throw
+    data_container //NOLINT
+    (
+        const call_fn_ptr_t pcall,
+        const delete_fn_ptr_t pdelete
+    ):
+        pcall_(pcall),
+        pdelete_(pdelete)
+    {
+    }
+
+    data_container(const data_container&) = delete;
+    data_container(data_container&& other) = delete;
+
+    ~data_container()
+    {
+        pdelete_(pdata_);
+    }
+
+    void operator=(const data_container&) = delete;
+    void operator=(data_container&& other) = delete;
+
+    template<class Data>
+    void set_data(Data&& data)
+    {
+        using data_type = std::decay_t<Data>;
+
+        //Copy or move data into the data_container
+        if constexpr(suitable_for_static_storage<data_type>())
+        {
+            pdata_ = new(static_storage_) data_type{std::forward<Data>(data)}; //NOLINT
+        }
+        else
+        {
+            pdata_ = new data_type{std::forward<Data>(data)}; //NOLINT
+        }
+    }
+
+    void set_delete(const delete_fn_ptr_t pdelete)
+    {
+        pdelete_ = pdelete;
+    }
+
+    void call(Arg arg)
+    {
+        pcall_(pdata_, arg);
+    }
+
+    //Call FunHolder::call(data, arg)
+    template<class Data, class FunHolder>
+    static void call_data(const void* const pdata, Arg arg)
+    {
+        const Data& data = *reinterpret_cast<const Data*>(pdata); //NOLINT
+        FunHolder::call(data, arg);
+    }
+
+    static void dont_call_data(const void* const /*pdata*/, Arg /*arg*/)
+    {
+    }
+
+    template<class Data>
+    static void delete_data(const void* const pdata)
+    {
+        if constexpr(suitable_for_static_storage<Data>())
+        {
+            reinterpret_cast<const Data*>(pdata)->~Data(); //NOLINT
+        }
+        else
+        {
+            delete reinterpret_cast<const Data*>(pdata); //NOLINT
+        }
+    }
+
+    static void dont_delete_data(const void* const /*pdata*/)
+    {
+    }
+
+private:
+    template<class Data>
+    static constexpr bool suitable_for_static_storage()
+    {
+        return
+            sizeof(Data) <= StaticStorageSize &&
+            alignof(Data) <= StaticStorageAlignment
+        ;
+    }
+
+    //Storage for small object optimization, properly aligned for an object
+    //whose alignment requirement is less than or equal to
+    //StaticStorageAlignment
+    alignas(StaticStorageAlignment) char static_storage_[StaticStorageSize]; //NOLINT
+
+    void* pdata_ = nullptr; //NOLINT
+    call_fn_ptr_t pcall_ = nullptr;
+    delete_fn_ptr_t pdelete_ = &dont_delete_data;
+};
+
+} //namespace
+
+#endif
@@ -0,0 +1,90 @@
+//Copyright Florian Goujeon 2021 - 2023.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+#ifndef MAKI_DETAIL_EVENT_TYPE_LIST_HPP
+#define MAKI_DETAIL_EVENT_TYPE_LIST_HPP
+
+#include "tlu.hpp"
+#include "../type_patterns.hpp"
+#include "../transition_table.hpp"
+#include "../type_list.hpp"
+#include <type_traits>
+
+namespace maki::detail
+{
+
+/*
+Utilities to list the event types that are explicitly named by transition
+tables and on_event_for lists.
+
+add_event_type_t adds the types matched by an event type pattern to a type list:
+- a regular type (except null) is added as is;
+- the types of an any_of<Ts...> are added recursively;
+- other patterns (any, any_but, etc.) don't match an enumerable set of types
+  and are ignored.
+Duplicates are ignored.
+*/
+
+template<class TList, class EventPattern>
+struct add_event_type;
+
+template<class TList, class EventPattern>
+using add_event_type_t = typename add_event_type<TList, EventPattern>::type;
+
+template<class TList, class EventPattern>
+struct add_event_type
+{
+    using type = tlu::push_back_if_t
+    <
+        TList,
+        EventPattern,
+        (
+            !tlu::contains_v<TList, EventPattern> &&
+            !std::is_same_v<EventPattern, null> &&
+            !is_type_pattern_v<EventPattern>
+        )
+    >;
+};
+
+template<class TList, class... Ts>
+struct add_event_type<TList, any_of<Ts...>>
+{
+    using type = tlu::left_fold_t
+    <
+        type_list<Ts...>,
+        add_event_type_t,
+        TList
+    >;
+};
+
+//Add the event types of the given list of event type patterns
+template<class TList, class EventPatternList>
+using add_event_types_t = tlu::left_fold_t
+<
+    EventPatternList,
+    add_event_type_t,
+    TList
+>;
+
+template<class TList, class Transition>
+using add_transition_event_type_t = add_event_type_t
+<
+    TList,
+    typename Transition::event_type_pattern
+>;
+
+//Add the event types of the transitions of the given transition table
+template<class TList, class TransitionTable>
+using add_transition_table_event_types_t = tlu::left_fold_t
+<
+    TransitionTable,
+    add_transition_event_type_t,
+    TList
+>;
+
+} //namespace
+
+#endif
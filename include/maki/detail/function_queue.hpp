@@ -7,7 +7,11 @@
 #ifndef MAKI_DETAIL_FUNCTION_QUEUE_HPP
 #define MAKI_DETAIL_FUNCTION_QUEUE_HPP
 
-#include <queue>
+#include "function_ring.hpp"
+#include <memory>
+#include <utility>
+#include <type_traits>
+#include <algorithm>
 #include <cstddef>
 
 namespace maki::detail
@@ -15,161 +19,107 @@ namespace maki::detail
 
 /*
 A kind of std::queue<std::function<void(Arg)>>, optimized for our needs
+
+Records are stored inline, at their exact size and alignment, in a chain of
+growing ring buffers. When the back ring is full, a new ring that is (at least)
+twice as big is appended to the chain. Rings are freed as soon as they're
+drained, except for the last one, which is kept for subsequent pushes. In
+steady state, the queue is therefore made of a single ring and doesn't
+allocate.
 */
-template
-<
-    class Arg,
-    std::size_t StaticStorageSize,
-    std::size_t StaticStorageAlignment = alignof(std::max_align_t)
->
+template<class Arg>
 class function_queue
 {
 public:
-    //Push call to FunHolder::call(data, arg)
+    //Push call to FunHolder::call(data, arg), where data is copied or moved
+    //(depending on its value category) into the queue
     template<class FunHolder, class Data>
-    void push(const Data& data)
+    void push(Data&& data)
     {
-        if constexpr(std::is_nothrow_copy_constructible_v<Data>)
+        //Note: A failed ring push doesn't move from data, so that forwarding
+        //data twice is fine.
+        if(pback_ == nullptr || !pback_->ring.template push<FunHolder>(std::forward<Data>(data)))
         {
-            queue_.emplace(&call<Data, FunHolder>, &delete_data<Data>).set_data(data);
-        }
-        else
-        {
-            /*
-            First make pdelete point to dont_delete_data() (which doesn't do
-            anything) in case the Data copy constructor throws.
-            Once the data is copied, we can safely make pdelete point to
-            delete_data().
-            */
-
-            auto& cont = queue_.emplace(&call<Data, FunHolder>);
-            cont.set_data(data);
-            cont.set_delete(&delete_data<Data>);
+            const auto capacity = std::max
+            ({
+                min_block_capacity,
+                pback_ == nullptr ? std::size_t{0} : pback_->ring.capacity() * 2,
+                ring_type::template min_capacity_for<std::decay_t<Data>>()
+            });
+            append_block(capacity).ring.template push<FunHolder>(std::forward<Data>(data));
         }
     }
 
     void invoke_and_pop_all(Arg arg)
     {
-        while(!queue_.empty())
+        while(pfront_ != nullptr)
         {
-            queue_.front().call(arg);
-            queue_.pop();
+            if(pfront_->ring.empty())
+            {
+                if(pfront_->pnext == nullptr)
+                {
+                    //Keep the last block for subsequent pushes
+                    return;
+                }
+
+                pfront_ = std::move(pfront_->pnext);
+                continue;
+            }
+
+            pfront_->ring.invoke_and_pop_front(arg);
         }
     }
 
 private:
-    using call_fn_ptr_t = void (*)(const void*, Arg);
-    using delete_fn_ptr_t = void (*)(const void*);
+    using ring_type = function_ring<Arg>;
 
-    /*
-    A container for an object of any type, with small object optimization.
+    static constexpr auto min_block_capacity = std::size_t{256};
 
-    The interface is designed so that the types of the arguments given to
-    queue_.emplace() don't change, whatever FunHolder and Data are.
-    This makes build time shorter and binary smaller.
-    */
-    struct data_container
+    struct block
     {
-        //To be called when Data copy constructor can throw
-        data_container //NOLINT
-        (
-            const call_fn_ptr_t pcall_
-        ):
-            pcall_(pcall_)
+        explicit block(const std::size_t capacity):
+            pstorage(std::make_unique<storage_unit[]>(storage_unit_count(capacity))), //NOLINT
+            ring(pstorage.get(), storage_unit_count(capacity) * sizeof(storage_unit))
         {
         }
 
-        //To be called when Data copy constructor cannot throw
-        data_container //NOLINT
-        (
-            const call_fn_ptr_t pcall_,
-            const delete_fn_ptr_t pdelete_
-        ):
-            pcall_(pcall_),
-            pdelete_(pdelete_)
+        //Unit of allocation, so that the storage is properly aligned for any
+        //fundamental type
+        struct storage_unit
         {
-        }
-
-        data_container(const data_container&) = delete;
-        data_container(data_container&& other) = delete;
+            alignas(std::max_align_t) unsigned char bytes[alignof(std::max_align_t)]; //NOLINT
+        };
 
-        ~data_container()
+        static std::size_t storage_unit_count(const std::size_t capacity)
         {
-            pdelete_(pdata_);
-        }
-
-        void operator=(const data_container&) = delete;
-        void operator=(data_container&& other) = delete;
-
-        template<class Data>
-        void set_data(const Data& data)
-        {
-            //Copy data into the data_container
-            if constexpr(suitable_for_static_storage<Data>())
-            {
-                pdata_ = new(static_storage_) Data{data}; //NOLINT
-            }
-            else
-            {
-                pdata_ = new Data{data}; //NOLINT
-            }
+            return (capacity + sizeof(storage_unit) - 1) / sizeof(storage_unit);
         }
 
-        void set_delete(const delete_fn_ptr_t pdelete)
-        {
-            pdelete_ = pdelete;
-        }
-
-        void call(Arg arg)
-        {
-            pcall_(pdata_, arg);
-        }
-
-    private:
-        //Storage for small object optimization, properly aligned for an object
-        //whose alignment requirement is less than or equal to
-        //StaticStorageAlignment
-        alignas(StaticStorageAlignment) char static_storage_[StaticStorageSize]; //NOLINT
-
-        void* pdata_; //NOLINT
-        call_fn_ptr_t pcall_ = nullptr;
-        delete_fn_ptr_t pdelete_ = &dont_delete_data;
+        std::unique_ptr<storage_unit[]> pstorage; //NOLINT
+        ring_type ring;
+        std::unique_ptr<block> pnext;
     };
 
-    template<class Data>
-    static constexpr bool suitable_for_static_storage()
-    {
-        return
-            sizeof(Data) <= StaticStorageSize &&
-            alignof(Data) <= StaticStorageAlignment
-        ;
-    }
-
-    template<class Data, class FunHolder>
-    static void call(const void* const pdata, Arg arg)
-    {
-        const Data& data = *reinterpret_cast<const Data*>(pdata); //NOLINT
-        FunHolder::call(data, arg);
-    }
-
-    static void dont_delete_data(const void* const /*pdata*/)
+    block& append_block(const std::size_t capacity)
     {
-    }
+        auto pblock = std::make_unique<block>(capacity);
+        auto& blk = *pblock;
 
-    template<class Data>
-    static void delete_data(const void* const pdata)
-    {
-        if constexpr(suitable_for_static_storage<Data>())
+        if(pback_ == nullptr)
         {
-            reinterpret_cast<const Data*>(pdata)->~Data(); //NOLINT
+            pfront_ = std::move(pblock);
         }
         else
         {
-            delete reinterpret_cast<const Data*>(pdata); //NOLINT
+            pback_->pnext = std::move(pblock);
         }
+        pback_ = &blk;
+
+        return blk;
     }
 
-    std::queue<data_container> queue_;
+    std::unique_ptr<block> pfront_;
+    block* pback_ = nullptr;
 };
 
 } //namespace
@@ -0,0 +1,273 @@
+//Copyright Florian Goujeon 2021 - 2023.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+#ifndef MAKI_DETAIL_FUNCTION_RING_HPP
+#define MAKI_DETAIL_FUNCTION_RING_HPP
+
+#include <new>
+#include <utility>
+#include <type_traits>
+#include <cstdint>
+#include <cstddef>
+
+namespace maki::detail
+{
+
+/*
+A FIFO of calls to FunHolder::call(data, arg), stored in a contiguous byte
+buffer (which function_ring doesn't own) used as a ring.
+
+Each record is made of a small header, which contains pointers to the functions
+that call and destroy the data, immediately followed by the data itself, at its
+exact size and alignment:
+    [header|padding|data|padding][header|padding|data|padding]...
+
+When a record doesn't fit at the end of the buffer, a wrap marker (a header
+with a null call pointer) is written, and the record is written at the
+beginning of the buffer.
+*/
+template<class Arg>
+class function_ring
+{
+public:
+    function_ring() = default;
+
+    function_ring(void* const pbuffer, const std::size_t capacity):
+        pbuffer_(static_cast<unsigned char*>(pbuffer)),
+        capacity_(capacity)
+    {
+    }
+
+    function_ring(const function_ring&) = delete;
+    function_ring(function_ring&&) = delete;
+    function_ring& operator=(const function_ring&) = delete;
+    function_ring& operator=(function_ring&&) = delete;
+
+    ~function_ring()
+    {
+        while(!empty())
+        {
+            auto& hdr = front_header();
+            hdr.pdestroy(data_of(hdr));
+            pop(hdr);
+        }
+    }
+
+    [[nodiscard]] bool empty() const
+    {
+        return read_pos_ == write_pos_;
+    }
+
+    [[nodiscard]] std::size_t capacity() const
+    {
+        return capacity_;
+    }
+
+    //The minimal buffer capacity required to store a record of Data
+    template<class Data>
+    static constexpr std::size_t min_capacity_for()
+    {
+        return align_up(header_size + alignof(Data) - 1 + sizeof(Data), header_align);
+    }
+
+    /*
+    Push call to FunHolder::call(data, arg), where data is copied or moved
+    (depending on its value category) into the buffer.
+    Return false if there's not enough room in the buffer, in which case data
+    isn't pushed (nor moved from).
+    If the constructor of data throws, the ring is left unchanged.
+    */
+    template<class FunHolder, class Data>
+    bool push(Data&& data)
+    {
+        using data_type = std::decay_t<Data>;
+
+        auto pos = write_pos_;
+        auto layout = make_record_layout<data_type>(pos);
+        auto wrap = false;
+
+        if(write_pos_ >= read_pos_)
+        {
+            if(layout.end_pos > capacity_)
+            {
+                //Try at the beginning of the buffer
+                pos = 0;
+                layout = make_record_layout<data_type>(pos);
+                if(layout.end_pos >= read_pos_)
+                {
+                    return false;
+                }
+                wrap = true;
+            }
+        }
+        else if(layout.end_pos >= read_pos_)
+        {
+            return false;
+        }
+
+        //Copy or move data (may throw)
+        ::new(pbuffer_ + layout.data_pos) data_type{std::forward<Data>(data)}; //NOLINT
+
+        if(wrap && capacity_ - write_pos_ >= header_size)
+        {
+            ::new(pbuffer_ + write_pos_) header{}; //NOLINT
+        }
+
+        ::new(pbuffer_ + pos) header //NOLINT
+        {
+            &call_data<data_type, FunHolder>,
+            &destroy_data<data_type>,
+            static_cast<std::uint32_t>(layout.data_pos - pos),
+            static_cast<std::uint32_t>(layout.end_pos - pos)
+        };
+
+        write_pos_ = layout.end_pos;
+
+        return true;
+    }
+
+    /*
+    Call the front record, destroy its data and pop it (even if the call
+    throws).
+    Ring must not be empty.
+    */
+    void invoke_and_pop_front(Arg arg)
+    {
+        auto& hdr = front_header();
+        auto grd = pop_guard{*this, hdr};
+        hdr.pcall(data_of(hdr), arg);
+    }
+
+private:
+    using call_fn_ptr_t = void (*)(const void*, Arg);
+    using destroy_fn_ptr_t = void (*)(const void*);
+
+    struct header
+    {
+        //nullptr for wrap markers
+        call_fn_ptr_t pcall = nullptr;
+
+        destroy_fn_ptr_t pdestroy = nullptr;
+
+        //Offsets relative to header position
+        std::uint32_t data_offset = 0;
+        std::uint32_t size = 0;
+    };
+
+    static constexpr auto header_size = sizeof(header);
+    static constexpr auto header_align = alignof(header);
+
+    struct record_layout
+    {
+        std::size_t data_pos = 0;
+        std::size_t end_pos = 0;
+    };
+
+    class pop_guard
+    {
+    public:
+        pop_guard(function_ring& self, header& hdr):
+            self_(self),
+            hdr_(hdr)
+        {
+        }
+
+        pop_guard(const pop_guard&) = delete;
+        pop_guard(pop_guard&&) = delete;
+        pop_guard& operator=(const pop_guard&) = delete;
+        pop_guard& operator=(pop_guard&&) = delete;
+
+        ~pop_guard()
+        {
+            hdr_.pdestroy(self_.data_of(hdr_));
+            self_.pop(hdr_);
+        }
+
+    private:
+        function_ring& self_; //NOLINT(cppcoreguidelines-avoid-const-or-ref-data-members)
+        header& hdr_; //NOLINT(cppcoreguidelines-avoid-const-or-ref-data-members)
+    };
+
+    static constexpr std::size_t align_up(const std::size_t value, const std::size_t alignment)
+    {
+        return (value + alignment - 1) / alignment * alignment;
+    }
+
+    template<class Data>
+    record_layout make_record_layout(const std::size_t pos) const
+    {
+        static_assert(min_capacity_for<Data>() <= UINT32_MAX);
+
+        //Align the data on its actual address
+        const auto address = reinterpret_cast<std::uintptr_t>(pbuffer_ + pos + header_size); //NOLINT
+        const auto data_pos = pos + header_size + (align_up(address, alignof(Data)) - address);
+
+        return record_layout
+        {
+            data_pos,
+            align_up(data_pos + sizeof(Data), header_align)
+        };
+    }
+
+    header& front_header()
+    {
+        //Skip wrap marker, if any
+        if
+        (
+            capacity_ - read_pos_ < header_size ||
+            header_at(read_pos_).pcall == nullptr
+        )
+        {
+            read_pos_ = 0;
+        }
+
+        return header_at(read_pos_);
+    }
+
+    header& header_at(const std::size_t pos)
+    {
+        return *std::launder(reinterpret_cast<header*>(pbuffer_ + pos)); //NOLINT
+    }
+
+    void* data_of(const header& hdr)
+    {
+        return const_cast<unsigned char*>(reinterpret_cast<const unsigned char*>(&hdr)) + hdr.data_offset; //NOLINT
+    }
+
+    void pop(const header& hdr)
+    {
+        read_pos_ += hdr.size;
+
+        //Rewind when empty to reduce fragmentation
+        if(read_pos_ == write_pos_)
+        {
+            read_pos_ = 0;
+            write_pos_ = 0;
+        }
+    }
+
+    template<class Data, class FunHolder>
+    static void call_data(const void* const pdata, Arg arg)
+    {
+        const Data& data = *std::launder(reinterpret_cast<const Data*>(pdata)); //NOLINT
+        FunHolder::call(data, arg);
+    }
+
+    template<class Data>
+    static void destroy_data(const void* const pdata)
+    {
+        std::launder(reinterpret_cast<const Data*>(pdata))->~Data(); //NOLINT
+    }
+
+    unsigned char* pbuffer_ = nullptr;
+    std::size_t capacity_ = 0;
+    std::size_t read_pos_ = 0;
+    std::size_t write_pos_ = 0;
+};
+
+} //namespace
+
+#endif
@@ -0,0 +1,75 @@
+//Copyright Florian Goujeon 2021 - 2023.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+#ifndef MAKI_DETAIL_INTEGER_HPP
+#define MAKI_DETAIL_INTEGER_HPP
+
+#include <type_traits>
+#include <cstdint>
+#include <cstddef>
+
+namespace maki::detail
+{
+
+/*
+Number of bits required to represent the given value.
+*/
+constexpr int bit_width(std::uint64_t value)
+{
+    auto width = 0;
+    while(value != 0)
+    {
+        value >>= 1U;
+        ++width;
+    }
+    return width;
+}
+
+/*
+Smallest unsigned integer type that can represent the given value.
+*/
+template<std::uint64_t MaxValue>
+using smallest_unsigned_t = std::conditional_t
+<
+    (MaxValue <= UINT8_MAX),
+    std::uint8_t,
+    std::conditional_t
+    <
+        (MaxValue <= UINT16_MAX),
+        std::uint16_t,
+        std::conditional_t
+        <
+            (MaxValue <= UINT32_MAX),
+            std::uint32_t,
+            std::uint64_t
+        >
+    >
+>;
+
+/*
+Smallest unsigned integer type that has at least the given number of bits.
+*/
+template<int BitCount>
+using smallest_unsigned_of_width_t = std::conditional_t
+<
+    (BitCount <= 8),
+    std::uint8_t,
+    std::conditional_t
+    <
+        (BitCount <= 16),
+        std::uint16_t,
+        std::conditional_t
+        <
+            (BitCount <= 32),
+            std::uint32_t,
+            std::uint64_t
+        >
+    >
+>;
+
+} //namespace
+
+#endif
@@ -0,0 +1,85 @@
+//Copyright Florian Goujeon 2021 - 2023.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+#ifndef MAKI_DETAIL_LAZY_STATE_STORAGE_HPP
+#define MAKI_DETAIL_LAZY_STATE_STORAGE_HPP
+
+#include "machine_object_holder.hpp"
+#include <algorithm>
+#include <new>
+#include <cstddef>
+
+namespace maki::detail
+{
+
+/*
+Storage shared by the lazily constructed states of a region (see
+state_conf::enable_lazy_construction()). Since at most one state of a region is
+active at a time, the storage is sized and aligned for the largest state.
+
+The storage doesn't know which state (if any) it holds. Its owner is
+responsible for calling destroy() on the state it constructed.
+*/
+template<class... States>
+class lazy_state_storage
+{
+public:
+    //Matches the signature of machine_object_holder's constructor, so that we
+    //can be an element of a state holder tuple.
+    template<class Machine, class Context>
+    lazy_state_storage(Machine& /*mach*/, Context& /*ctx*/)
+    {
+    }
+
+    lazy_state_storage(const lazy_state_storage&) = delete;
+    lazy_state_storage(lazy_state_storage&&) = delete;
+    lazy_state_storage& operator=(const lazy_state_storage&) = delete;
+    lazy_state_storage& operator=(lazy_state_storage&&) = delete;
+    ~lazy_state_storage() = default;
+
+    template<class State, class Machine, class Context>
+    void construct(Machine& mach, Context& ctx)
+    {
+        ::new(static_cast<void*>(&storage_)) machine_object_holder<State>(mach, ctx);
+    }
+
+    template<class State>
+    void destroy()
+    {
+        holder<State>().~machine_object_holder<State>();
+    }
+
+    template<class State>
+    State& get()
+    {
+        return holder<State>().get();
+    }
+
+    template<class State>
+    const State& get() const
+    {
+        return holder<State>().get();
+    }
+
+private:
+    template<class State>
+    machine_object_holder<State>& holder()
+    {
+        return *std::launder(reinterpret_cast<machine_object_holder<State>*>(&storage_)); //NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+    }
+
+    template<class State>
+    const machine_object_holder<State>& holder() const
+    {
+        return *std::launder(reinterpret_cast<const machine_object_holder<State>*>(&storage_)); //NOLINT(cppcoreguidelines-pro-type-reinterpret-cast)
+    }
+
+    alignas(machine_object_holder<States>...) unsigned char storage_[std::max({sizeof(machine_object_holder<States>)...})]; //NOLINT(cppcoreguidelines-avoid-c-arrays)
+};
+
+} //namespace
+
+#endif
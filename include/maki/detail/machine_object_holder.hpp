@@ -73,6 +73,12 @@ public:
     {
         return static_cast<const T&>(*this);
     }
+
+    //Returns the holder of the given object
+    static machine_object_holder& from_object(T& obj)
+    {
+        return static_cast<machine_object_holder&>(obj);
+    }
 };
 
 } //namespace
@@ -0,0 +1,250 @@
+//Copyright Florian Goujeon 2021 - 2023.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+#ifndef MAKI_DETAIL_MPSC_FUNCTION_QUEUE_HPP
+#define MAKI_DETAIL_MPSC_FUNCTION_QUEUE_HPP
+
+#include "data_container.hpp"
+#include <atomic>
+#include <new>
+#include <utility>
+#include <type_traits>
+#include <cstddef>
+
+namespace maki::detail
+{
+
+/*
+A bounded, lock-free, multi-producer/single-consumer variant of
+function_queue.
+
+push() can be called from any thread, while invoke_and_pop_all() must always be
+called from the same (consumer) thread.
+
+This is an adaptation of Dmitry Vyukov's bounded MPMC queue: each cell holds a
+sequence number that tells whether the cell is free for the producer of a
+given position, or ready for the consumer.
+*/
+template
+<
+    class Arg,
+    std::size_t Capacity,
+    std::size_t StaticStorageSize,
+    std::size_t StaticStorageAlignment = alignof(std::max_align_t)
+>
+class mpsc_function_queue
+{
+public:
+    static_assert
+    (
+        Capacity != 0 && (Capacity & (Capacity - 1)) == 0,
+        "The capacity of the posted event queue must be a power of two"
+    );
+
+    mpsc_function_queue()
+    {
+        for(auto i = std::size_t{0}; i < Capacity; ++i)
+        {
+            cells_[i].sequence.store(i, std::memory_order_relaxed); //NOLINT
+        }
+    }
+
+    mpsc_function_queue(const mpsc_function_queue&) = delete;
+    mpsc_function_queue(mpsc_function_queue&&) = delete;
+    mpsc_function_queue& operator=(const mpsc_function_queue&) = delete;
+    mpsc_function_queue& operator=(mpsc_function_queue&&) = delete;
+
+    ~mpsc_function_queue()
+    {
+        //Destroy the data that haven't been consumed
+        while(auto pcell = ready_cell())
+        {
+            release(*pcell);
+        }
+    }
+
+    /*
+    Push call to FunHolder::call(data, arg), where data is copied or moved
+    (depending on its value category) into the queue.
+    Return false if the queue is full, in which case data isn't pushed (nor
+    moved from).
+    */
+    template<class FunHolder, class Data>
+    bool push(Data&& data)
+    {
+        using data_type = std::decay_t<Data>;
+
+        auto pos = enqueue_pos_.load(std::memory_order_relaxed);
+        auto pcell = static_cast<cell*>(nullptr);
+
+        //Claim the cell at position pos
+        while(true)
+        {
+            pcell = &cells_[pos & mask]; //NOLINT
+            const auto seq = pcell->sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::ptrdiff_t>(seq - pos);
+            if(diff == 0)
+            {
+                if(enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                {
+                    break;
+                }
+            }
+            else if(diff < 0)
+            {
+                //Queue is full
+                return false;
+            }
+            else
+            {
+                //Another producer claimed the cell
+                pos = enqueue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+
+        if constexpr(std::is_nothrow_constructible_v<data_type, Data&&>)
+        {
+            new(&pcell->storage) data_container_type //NOLINT
+            {
+                &data_container_type::template call_data<data_type, FunHolder>,
+                &data_container_type::template delete_data<data_type>
+            };
+            container(*pcell).set_data(std::forward<Data>(data));
+        }
+        else
+        {
+            new(&pcell->storage) data_container_type //NOLINT
+            {
+                &data_container_type::template call_data<data_type, FunHolder>
+            };
+
+            try
+            {
+                container(*pcell).set_data(std::forward<Data>(data));
+            }
+            catch(...)
+            {
+                /*
+                The cell has been claimed. We must publish it anyway so that
+                the consumer doesn't wait for it forever.
+                */
+                container(*pcell).~data_container_type();
+                new(&pcell->storage) data_container_type //NOLINT
+                {
+                    &data_container_type::dont_call_data
+                };
+                pcell->sequence.store(pos + 1, std::memory_order_release);
+                throw;
+            }
+
+            container(*pcell).set_delete(&data_container_type::template delete_data<data_type>);
+        }
+
+        //Publish the cell to the consumer
+        pcell->sequence.store(pos + 1, std::memory_order_release);
+
+        return true;
+    }
+
+    /*
+    Invoke and pop the calls that have been pushed before the beginning of this
+    call. The calls that are pushed in the meantime are left for the next
+    invoke_and_pop_all() call, so that constant pushes from the producers can't
+    keep the consumer here forever.
+    */
+    void invoke_and_pop_all(Arg arg)
+    {
+        const auto end_pos = enqueue_pos_.load(std::memory_order_relaxed);
+        while(dequeue_pos_ != end_pos)
+        {
+            const auto pcell = ready_cell();
+            if(pcell == nullptr)
+            {
+                //The cell has been claimed but its data isn't published yet
+                return;
+            }
+
+            //Release the cell even if the call throws
+            auto grd = release_guard{*this, *pcell};
+            container(*pcell).call(arg);
+        }
+    }
+
+private:
+    using data_container_type = data_container
+    <
+        Arg,
+        StaticStorageSize,
+        StaticStorageAlignment
+    >;
+
+    struct cell
+    {
+        std::atomic<std::size_t> sequence;
+        alignas(data_container_type) unsigned char storage[sizeof(data_container_type)]; //NOLINT
+    };
+
+    class release_guard
+    {
+    public:
+        release_guard(mpsc_function_queue& self, cell& c):
+            self_(self),
+            cell_(c)
+        {
+        }
+
+        release_guard(const release_guard&) = delete;
+        release_guard(release_guard&&) = delete;
+        release_guard& operator=(const release_guard&) = delete;
+        release_guard& operator=(release_guard&&) = delete;
+
+        ~release_guard()
+        {
+            self_.release(cell_);
+        }
+
+    private:
+        mpsc_function_queue& self_; //NOLINT(cppcoreguidelines-avoid-const-or-ref-data-members)
+        cell& cell_; //NOLINT(cppcoreguidelines-avoid-const-or-ref-data-members)
+    };
+
+    static constexpr auto mask = Capacity - 1;
+
+    //Size of a cache line, to avoid false sharing between producers and consumer
+    static constexpr auto cache_line_size = std::size_t{64};
+
+    static data_container_type& container(cell& c)
+    {
+        return *std::launder(reinterpret_cast<data_container_type*>(&c.storage)); //NOLINT
+    }
+
+    //Return the next cell to be consumed, if it's ready
+    cell* ready_cell()
+    {
+        auto& c = cells_[dequeue_pos_ & mask]; //NOLINT
+        if(c.sequence.load(std::memory_order_acquire) != dequeue_pos_ + 1)
+        {
+            return nullptr;
+        }
+        return &c;
+    }
+
+    //Destroy data of consumed cell and make the cell available to producers
+    void release(cell& c)
+    {
+        container(c).~data_container_type();
+        c.sequence.store(dequeue_pos_ + Capacity, std::memory_order_release);
+        ++dequeue_pos_;
+    }
+
+    cell cells_[Capacity]; //NOLINT
+    alignas(cache_line_size) std::atomic<std::size_t> enqueue_pos_ = 0;
+    alignas(cache_line_size) std::size_t dequeue_pos_ = 0;
+};
+
+} //namespace
+
+#endif
@@ -0,0 +1,72 @@
+//Copyright Florian Goujeon 2021 - 2023.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+#ifndef MAKI_DETAIL_PP_FOR_EACH_HPP
+#define MAKI_DETAIL_PP_FOR_EACH_HPP
+
+/*
+MAKI_DETAIL_PP_FOR_EACH(macro, data, x0, x1, ...) expands to:
+    macro(data, x0) macro(data, x1) ...
+
+Up to 32 elements are supported.
+
+The MAKI_DETAIL_PP_EXPAND() indirections are required by MSVC's traditional
+preprocessor, which otherwise passes __VA_ARGS__ as a single argument.
+*/
+
+#define MAKI_DETAIL_PP_EXPAND(x) x
+
+#define MAKI_DETAIL_PP_CAT_IMPL(a, b) a##b
+#define MAKI_DETAIL_PP_CAT(a, b) MAKI_DETAIL_PP_CAT_IMPL(a, b)
+
+//The trailing 0 makes sure the variadic part is never empty (which is an
+//extension before C++20).
+#define MAKI_DETAIL_PP_ARG_COUNT(...) /*NOLINT*/ \
+    MAKI_DETAIL_PP_EXPAND(MAKI_DETAIL_PP_ARG_COUNT_IMPL(__VA_ARGS__, 32, 31, 30, 29, 28, 27, 26, 25, 24, 23, 22, 21, 20, 19, 18, 17, 16, 15, 14, 13, 12, 11, 10, 9, 8, 7, 6, 5, 4, 3, 2, 1, 0))
+
+#define MAKI_DETAIL_PP_ARG_COUNT_IMPL(_1, _2, _3, _4, _5, _6, _7, _8, _9, _10, _11, _12, _13, _14, _15, _16, _17, _18, _19, _20, _21, _22, _23, _24, _25, _26, _27, _28, _29, _30, _31, _32, N, ...) N
+
+#define MAKI_DETAIL_PP_FOR_EACH(macro, data, ...) /*NOLINT*/ \
+    MAKI_DETAIL_PP_EXPAND \
+    ( \
+        MAKI_DETAIL_PP_CAT(MAKI_DETAIL_PP_FOR_EACH_, MAKI_DETAIL_PP_ARG_COUNT(__VA_ARGS__)) \
+        (macro, data, __VA_ARGS__) \
+    )
+
+#define MAKI_DETAIL_PP_FOR_EACH_1(m, d, x) m(d, x)
+#define MAKI_DETAIL_PP_FOR_EACH_2(m, d, x, ...) m(d, x) MAKI_DETAIL_PP_EXPAND(MAKI_DETAIL_PP_FOR_EACH_1(m, d, __VA_ARGS__))
+#define MAKI_DETAIL_PP_FOR_EACH_3(m, d, x, ...) m(d, x) MAKI_DETAIL_PP_EXPAND(MAKI_DETAIL_PP_FOR_EACH_2(m, d, __VA_ARGS__))
+#define MAKI_DETAIL_PP_FOR_EACH_4(m, d, x, ...) m(d, x) MAKI_DETAIL_PP_EXPAND(MAKI_DETAIL_PP_FOR_EACH_3(m, d, __VA_ARGS__))
+#define MAKI_DETAIL_PP_FOR_EACH_5(m, d, x, ...) m(d, x) MAKI_DETAIL_PP_EXPAND(MAKI_DETAIL_PP_FOR_EACH_4(m, d, __VA_ARGS__))
+#define MAKI_DETAIL_PP_FOR_EACH_6(m, d, x, ...) m(d, x) MAKI_DETAIL_PP_EXPAND(MAKI_DETAIL_PP_FOR_EACH_5(m, d, __VA_ARGS__))
+#define MAKI_DETAIL_PP_FOR_EACH_7(m, d, x, ...) m(d, x) MAKI_DETAIL_PP_EXPAND(MAKI_DETAIL_PP_FOR_EACH_6(m, d, __VA_ARGS__))
+#define MAKI_DETAIL_PP_FOR_EACH_8(m, d, x, ...) m(d, x) MAKI_DETAIL_PP_EXPAND(MAKI_DETAIL_PP_FOR_EACH_7(m, d, __VA_ARGS__))
+#define MAKI_DETAIL_PP_FOR_EACH_9(m, d, x, ...) m(d, x) MAKI_DETAIL_PP_EXPAND(MAKI_DETAIL_PP_FOR_EACH_8(m, d, __VA_ARGS__))
+#define MAKI_DETAIL_PP_FOR_EACH_10(m, d, x, ...) m(d, x) MAKI_DETAIL_PP_EXPAND(MAKI_DETAIL_PP_FOR_EACH_9(m, d, __VA_ARGS__))
+#define MAKI_DETAIL_PP_FOR_EACH_11(m, d, x, ...) m(d, x) MAKI_DETAIL_PP_EXPAND(MAKI_DETAIL_PP_FOR_EACH_10(m, d, __VA_ARGS__))
+#define MAKI_DETAIL_PP_FOR_EACH_12(m, d, x, ...) m(d, x) MAKI_DETAIL_PP_EXPAND(MAKI_DETAIL_PP_FOR_EACH_11(m, d, __VA_ARGS__))
+#define MAKI_DETAIL_PP_FOR_EACH_13(m, d, x, ...) m(d, x) MAKI_DETAIL_PP_EXPAND(MAKI_DETAIL_PP_FOR_EACH_12(m, d, __VA_ARGS__))
+#define MAKI_DETAIL_PP_FOR_EACH_14(m, d, x, ...) m(d, x) MAKI_DETAIL_PP_EXPAND(MAKI_DETAIL_PP_FOR_EACH_13(m, d, __VA_ARGS__))
+#define MAKI_DETAIL_PP_FOR_EACH_15(m, d, x, ...) m(d, x) MAKI_DETAIL_PP_EXPAND(MAKI_DETAIL_PP_FOR_EACH_14(m, d, __VA_ARGS__))
+#define MAKI_DETAIL_PP_FOR_EACH_16(m, d, x, ...) m(d, x) MAKI_DETAIL_PP_EXPAND(MAKI_DETAIL_PP_FOR_EACH_15(m, d, __VA_ARGS__))
+#define MAKI_DETAIL_PP_FOR_EACH_17(m, d, x, ...) m(d, x) MAKI_DETAIL_PP_EXPAND(MAKI_DETAIL_PP_FOR_EACH_16(m, d, __VA_ARGS__))
+#define MAKI_DETAIL_PP_FOR_EACH_18(m, d, x, ...) m(d, x) MAKI_DETAIL_PP_EXPAND(MAKI_DETAIL_PP_FOR_EACH_17(m, d, __VA_ARGS__))
+#define MAKI_DETAIL_PP_FOR_EACH_19(m, d, x, ...) m(d, x) MAKI_DETAIL_PP_EXPAND(MAKI_DETAIL_PP_FOR_EACH_18(m, d, __VA_ARGS__))
+#define MAKI_DETAIL_PP_FOR_EACH_20(m, d, x, ...) m(d, x) MAKI_DETAIL_PP_EXPAND(MAKI_DETAIL_PP_FOR_EACH_19(m, d, __VA_ARGS__))
+#define MAKI_DETAIL_PP_FOR_EACH_21(m, d, x, ...) m(d, x) MAKI_DETAIL_PP_EXPAND(MAKI_DETAIL_PP_FOR_EACH_20(m, d, __VA_ARGS__))
+#define MAKI_DETAIL_PP_FOR_EACH_22(m, d, x, ...) m(d, x) MAKI_DETAIL_PP_EXPAND(MAKI_DETAIL_PP_FOR_EACH_21(m, d, __VA_ARGS__))
+#define MAKI_DETAIL_PP_FOR_EACH_23(m, d, x, ...) m(d, x) MAKI_DETAIL_PP_EXPAND(MAKI_DETAIL_PP_FOR_EACH_22(m, d, __VA_ARGS__))
+#define MAKI_DETAIL_PP_FOR_EACH_24(m, d, x, ...) m(d, x) MAKI_DETAIL_PP_EXPAND(MAKI_DETAIL_PP_FOR_EACH_23(m, d, __VA_ARGS__))
+#define MAKI_DETAIL_PP_FOR_EACH_25(m, d, x, ...) m(d, x) MAKI_DETAIL_PP_EXPAND(MAKI_DETAIL_PP_FOR_EACH_24(m, d, __VA_ARGS__))
+#define MAKI_DETAIL_PP_FOR_EACH_26(m, d, x, ...) m(d, x) MAKI_DETAIL_PP_EXPAND(MAKI_DETAIL_PP_FOR_EACH_25(m, d, __VA_ARGS__))
+#define MAKI_DETAIL_PP_FOR_EACH_27(m, d, x, ...) m(d, x) MAKI_DETAIL_PP_EXPAND(MAKI_DETAIL_PP_FOR_EACH_26(m, d, __VA_ARGS__))
+#define MAKI_DETAIL_PP_FOR_EACH_28(m, d, x, ...) m(d, x) MAKI_DETAIL_PP_EXPAND(MAKI_DETAIL_PP_FOR_EACH_27(m, d, __VA_ARGS__))
+#define MAKI_DETAIL_PP_FOR_EACH_29(m, d, x, ...) m(d, x) MAKI_DETAIL_PP_EXPAND(MAKI_DETAIL_PP_FOR_EACH_28(m, d, __VA_ARGS__))
+#define MAKI_DETAIL_PP_FOR_EACH_30(m, d, x, ...) m(d, x) MAKI_DETAIL_PP_EXPAND(MAKI_DETAIL_PP_FOR_EACH_29(m, d, __VA_ARGS__))
+#define MAKI_DETAIL_PP_FOR_EACH_31(m, d, x, ...) m(d, x) MAKI_DETAIL_PP_EXPAND(MAKI_DETAIL_PP_FOR_EACH_30(m, d, __VA_ARGS__))
+#define MAKI_DETAIL_PP_FOR_EACH_32(m, d, x, ...) m(d, x) MAKI_DETAIL_PP_EXPAND(MAKI_DETAIL_PP_FOR_EACH_31(m, d, __VA_ARGS__))
+
+#endif
@@ -13,32 +13,181 @@
 #include "transition_table_digest.hpp"
 #include "transition_table_filters.hpp"
 #include "state_type_list_filters.hpp"
+#include "event_type_list.hpp"
 #include "machine_object_holder_tuple.hpp"
+#include "lazy_state_storage.hpp"
+#include "container_of.hpp"
+#include "integer.hpp"
+#include "bitset.hpp"
+#include "timing_wheel.hpp"
 #include "tlu.hpp"
 #include "../submachine_conf.hpp"
 #include "../states.hpp"
+#include "../events.hpp"
+#include "../pretty_name.hpp"
+#include "../trace_record.hpp"
 #include <type_traits>
+#include <algorithm>
+#include <string>
+#include <cstdint>
 #include <exception>
+#include <cstddef>
 
 namespace maki::detail
 {
 
 namespace
 {
-    template<class StateList, class State>
+    template<class Digest, class StateDef>
+    struct index_of_state_def
+    {
+        static constexpr auto value = Digest::template state_def_index_v<StateDef>;
+    };
+
+    //The stopped pseudo-state comes right after the last state
+    template<class Digest>
+    struct index_of_state_def<Digest, states::stopped>
+    {
+        static constexpr auto value = static_cast<int>(tlu::size_v<typename Digest::state_def_type_list>);
+    };
+
+    template<class Digest, class StateDef>
+    inline constexpr auto index_of_state_def_v = index_of_state_def<Digest, StateDef>::value;
+
+    template<class Digest, class State>
     struct index_of_state
     {
-        static constexpr auto value = tlu::index_of_v<StateList, State>;
+        static constexpr auto value = Digest::template state_index_v<State>;
+    };
+
+    template<class Digest>
+    struct index_of_state<Digest, states::stopped>
+    {
+        static constexpr auto value = static_cast<int>(tlu::size_v<typename Digest::state_type_list>);
+    };
+
+    template<class Digest, class State>
+    inline constexpr auto index_of_state_v = index_of_state<Digest, State>::value;
+
+    /*
+    Aggregates the flat_* constants of the given regions or submachines.
+    */
+    template<class TList>
+    struct flat_info_of;
+
+    template<template<class...> class TList, class... Ts>
+    struct flat_info_of<TList<Ts...>>
+    {
+        static constexpr auto region_count = (Ts::flat_region_count + ... + std::size_t{0});
+        static constexpr auto max_state_count = std::max({0, Ts::flat_max_state_count...});
+        static constexpr auto has_submachine_context = (Ts::flat_has_submachine_context || ...);
+        static constexpr auto back_reference_size = (Ts::flat_back_reference_size + ... + std::size_t{0});
+        static constexpr auto state_index_bit_count = (Ts::flat_state_index_bit_count + ... + 0);
+        static constexpr auto has_timed_state = (Ts::flat_has_timed_state || ...);
+        static constexpr auto has_lazy_state = (Ts::flat_has_lazy_state || ...);
+        static constexpr auto has_stateful_state = (Ts::flat_has_stateful_state || ...);
+    };
+
+    /*
+    Sum of the flat_region_count constants of the regions or submachines that
+    precede T in the given list.
+    */
+    template<class TList, class T>
+    struct flat_region_count_before;
+
+    template<template<class...> class TList, class... Ts, class T>
+    struct flat_region_count_before<TList<Ts...>, T>
+    {
+        static constexpr auto value = []
+        {
+            constexpr std::size_t counts[] = {Ts::flat_region_count..., 0}; //NOLINT
+            constexpr auto index = static_cast<std::size_t>(tlu::index_of_v<TList<Ts...>, T>);
+            auto sum = std::size_t{0};
+            for(auto i = std::size_t{0}; i < index; ++i)
+            {
+                sum += counts[i]; //NOLINT(cppcoreguidelines-pro-bounds-constant-array-index)
+            }
+            return sum;
+        }();
+    };
+
+    template<class TList, class T>
+    inline constexpr auto flat_region_count_before_v = flat_region_count_before<TList, T>::value;
+
+    //List of the layout_type of the given regions or submachines
+    template<class... Ts>
+    using layout_type_list_t = type_list<typename Ts::layout_type...>;
+
+    /*
+    Finds the pretty name of the state of the given index in the region of the
+    given flat index, among the given regions or submachines.
+    */
+    struct flat_state_pretty_name_in
+    {
+        template<class T>
+        static bool call(std::size_t& region_index, const std::size_t& state_index, std::string& name)
+        {
+            if(region_index < T::flat_region_count)
+            {
+                name = T::flat_state_pretty_name(region_index, state_index);
+                return true;
+            }
+            region_index -= T::flat_region_count;
+            return false;
+        }
     };
 
-    template<class StateList>
-    struct index_of_state<StateList, states::stopped>
+    struct state_def_pretty_name_at
     {
-        static constexpr auto value = -1;
+        template<class StateDef>
+        static bool call(std::size_t& state_index, std::string& name)
+        {
+            if(state_index == 0)
+            {
+                name = std::string{pretty_name<StateDef>()};
+                return true;
+            }
+            --state_index;
+            return false;
+        }
     };
 
-    template<class StateList, class State>
-    inline constexpr auto index_of_state_v = index_of_state<StateList, State>::value;
+    template<class StateList, class Event>
+    struct any_state_handles_event;
+
+    template<template<class...> class TList, class... States, class Event>
+    struct any_state_handles_event<TList<States...>, Event>
+    {
+        static constexpr auto value = (state_traits::handles_event_v<States, Event> || ...);
+    };
+
+    /*
+    Adds the event types explicitly handled by the given state (see
+    region::event_type_list) to TList.
+    */
+    template<class TList, class State, bool IsSubmachine = state_traits::is_submachine_v<State>>
+    struct add_state_event_types
+    {
+        using type = add_event_types_t<TList, decltype(State::conf.has_on_event_for)>;
+    };
+
+    template<class TList, class State>
+    struct add_state_event_types<TList, State, true>
+    {
+        using type = add_event_types_t<TList, typename State::event_type_list>;
+    };
+
+    template<class TList, class State>
+    using add_state_event_types_t = typename add_state_event_types<TList, State>::type;
+
+    template<class RegionList, class Event>
+    struct any_region_handles_event;
+
+    template<template<class...> class TList, class... Regions, class Event>
+    struct any_region_handles_event<TList<Regions...>, Event>
+    {
+        static constexpr auto value = (Regions::template handles_event_v<Event> || ...);
+    };
 
     template<class State>
     auto& state_def_of(State& state)
@@ -54,6 +203,133 @@ namespace
     }
 }
 
+//Whether a state of the given region has a timeout (see state_conf::timeout)
+template<class ParentSm, int Index>
+constexpr auto region_has_timed_state_v = state_traits::any_has_timeout
+<
+    typename transition_table_digest_detail::digest_with_type_lists
+    <
+        tlu::get_t<typename ParentSm::transition_table_type_list, Index>
+    >::state_def_type_list
+>::value;
+
+/*
+Whether the given state definition has a timeout or, for a submachine, whether
+a state of its subtree (recursively) has one.
+
+Unlike submachine::flat_has_timed_state, only requires the state definitions,
+so that it can be used before the machine type is complete.
+*/
+template<class StateDef, class Enable = void>
+struct flat_has_timed_state
+{
+    static constexpr auto value = state_traits::has_timeout_v<StateDef>;
+};
+
+template<class StateDefList>
+struct any_flat_has_timed_state;
+
+template<template<class...> class TList, class... StateDefs>
+struct any_flat_has_timed_state<TList<StateDefs...>>
+{
+    static constexpr auto value = (flat_has_timed_state<StateDefs>::value || ...);
+};
+
+template<class TransitionTableList>
+struct any_transition_table_has_timed_state;
+
+template<template<class...> class TList, class... TransitionTables>
+struct any_transition_table_has_timed_state<TList<TransitionTables...>>
+{
+    static constexpr auto value =
+    (
+        any_flat_has_timed_state
+        <
+            typename transition_table_digest_detail::digest_with_type_lists<TransitionTables>::state_def_type_list
+        >::value ||
+        ...
+    );
+};
+
+//Whether a state of the given machine or submachine definition (recursively)
+//has a timeout
+template<class Def>
+constexpr auto def_has_timed_state_v = any_transition_table_has_timed_state
+<
+    decltype(Def::conf.transition_tables)
+>::value;
+
+template<class StateDef>
+struct flat_has_timed_state
+<
+    StateDef,
+    std::enable_if_t<is_submachine_conf_v<std::decay_t<decltype(StateDef::conf)>>>
+>
+{
+    static constexpr auto value =
+        state_traits::has_timeout_v<StateDef> ||
+        def_has_timed_state_v<StateDef>
+    ;
+};
+
+/*
+The timer of the timeout of the active state of a region. The region derives
+from this class so that, when no state has a timeout, the empty base
+optimization applies and the region doesn't grow.
+*/
+template<bool HasTimedState>
+struct region_timeout_timer
+{
+};
+
+template<>
+struct region_timeout_timer<true>
+{
+    timing_wheel_node timeout_timer;
+};
+
+template<class Event>
+struct is_timeout_event
+{
+    static constexpr auto value = false;
+};
+
+template<class State>
+struct is_timeout_event<events::timeout<State>>
+{
+    static constexpr auto value = true;
+};
+
+template<class Event>
+constexpr auto is_timeout_event_v = is_timeout_event<Event>::value;
+
+/*
+The references a region stores to its root machine and to its context, for
+faster access. In compact layout mode (see machine_conf::compact_layout), the
+region doesn't store anything and finds these objects from its own address
+instead.
+*/
+template<class RootSm, class Context, bool Compact = RootSm::conf.compact_layout>
+struct region_back_references
+{
+    region_back_references(RootSm& root_sm, Context& ctx):
+        root_sm_(root_sm),
+        ctx_(ctx)
+    {
+    }
+
+    RootSm& root_sm_; //NOLINT(cppcoreguidelines-avoid-const-or-ref-data-members)
+    Context& ctx_; //NOLINT(cppcoreguidelines-avoid-const-or-ref-data-members)
+};
+
+template<class RootSm, class Context>
+struct region_back_references<RootSm, Context, true>
+{
+    region_back_references(RootSm& /*root_sm*/, Context& /*ctx*/)
+    {
+    }
+};
+
 template<class ParentSm, int Index>
 class region;
 
@@ -70,15 +346,20 @@ struct machine_of<region<ParentSm, Index>>
 };
 
 template<class ParentSm, int Index>
-class region
+class region:
+    private region_back_references
+    <
+        root_sm_of_t<ParentSm>,
+        std::decay_t<typename ParentSm::context_type>
+    >,
+    private region_timeout_timer<region_has_timed_state_v<ParentSm, Index>>
 {
 public:
     using parent_sm_type = ParentSm;
 
     explicit region(ParentSm& parent_sm):
-        root_sm_(machine_of<ParentSm>::get(parent_sm)),
-        ctx_(parent_sm.context()),
-        state_holders_(uniform_construct, root_sm_, ctx_)
+        back_references_type(machine_of<ParentSm>::get(parent_sm), parent_sm.context()),
+        state_holders_(uniform_construct, machine_of<ParentSm>::get(parent_sm), parent_sm.context())
     {
     }
 
@@ -86,7 +367,62 @@ public:
     region(region&&) = delete;
     region& operator=(const region&) = delete;
     region& operator=(region&&) = delete;
-    ~region() = default;
+
+    ~region()
+    {
+        //The timeout scheduler outlives the regions, so it must forget about
+        //our timer
+        if constexpr(has_timed_state)
+        {
+            disarm_timeout();
+        }
+
+        if constexpr(!tlu::empty_v<lazy_state_type_list>)
+        {
+            tlu::for_each_or<lazy_state_type_list, destroy_lazy_state_if_active>(*this);
+        }
+    }
+
+    ParentSm& parent_sm()
+    {
+        return ParentSm::from_region(*this);
+    }
+
+    auto& root_sm()
+    {
+        if constexpr(machine_conf.compact_layout)
+        {
+            return machine_of<ParentSm>::get(parent_sm());
+        }
+        else
+        {
+            return this->root_sm_;
+        }
+    }
+
+    auto& ctx()
+    {
+        if constexpr(machine_conf.compact_layout)
+        {
+            return parent_sm().context();
+        }
+        else
+        {
+            return this->ctx_;
+        }
+    }
+
+    //Returns the region that holds the given state object
+    template<class State>
+    static region& from_state(State& state)
+    {
+        auto& holders = static_cast<state_holder_tuple_type&>
+        (
+            machine_object_holder<State>::from_object(state)
+        );
+        MAKI_DETAIL_OFFSET_OF(offset, region, state_holders_)
+        return container_of<region>(holders, offset);
+    }
 
     template<const auto& StateRegionPath, class StateDef>
     const StateDef& state_def() const
@@ -177,6 +513,11 @@ public:
     template<class Event>
     void process_event(const Event& event)
     {
+        if(!contains_recipient_of(event))
+        {
+            return;
+        }
+
         //List the transitions whose event type pattern matches Event
         using candidate_transition_type_list = transition_table_filters::by_event_t
         <
@@ -184,7 +525,9 @@ public:
             Event
         >;
 
-        //List the state types that require us to call their on_event()
+        //List the state types that require us to call their on_event() (which,
+        //for submachines, excludes those that can't handle Event anywhere in
+        //their subtree)
         using candidate_state_type_list =
             state_type_list_filters::by_required_on_event_t
             <
@@ -217,6 +560,11 @@ public:
     template<class Event>
     void process_event(const Event& event, bool& processed)
     {
+        if(!contains_recipient_of(event))
+        {
+            return;
+        }
+
         //List the transitions whose event type pattern matches Event
         using candidate_transition_type_list = transition_table_filters::by_event_t
         <
@@ -224,7 +572,9 @@ public:
             Event
         >;
 
-        //List the state types that require us to call their on_event()
+        //List the state types that require us to call their on_event() (which,
+        //for submachines, excludes those that can't handle Event anywhere in
+        //their subtree)
         using candidate_state_type_list =
             state_type_list_filters::by_required_on_event_t
             <
@@ -262,6 +612,14 @@ private:
     using root_sm_type = root_sm_of_t<ParentSm>;
     static constexpr auto machine_conf = root_sm_type::conf;
 
+    using back_references_type = region_back_references
+    <
+        root_sm_type,
+        std::decay_t<typename ParentSm::context_type>
+    >;
+
+    using timeout_timer_type = region_timeout_timer<region_has_timed_state_v<ParentSm, Index>>;
+
     using transition_table_type = tlu::get_t<typename ParentSm::transition_table_type_list, Index>;
 
     using transition_table_digest_type =
@@ -272,15 +630,399 @@ private:
 
     using state_type_list = typename transition_table_digest_type::state_type_list;
 
-    using non_empty_state_type_list = tlu::filter_t
+    using eager_state_type_list = tlu::filter_t
     <
         state_type_list,
-        state_traits::needs_unique_instance
+        state_traits::needs_eager_unique_instance
+    >;
+
+    using lazy_state_type_list = tlu::filter_t
+    <
+        state_type_list,
+        state_traits::is_lazily_constructed
+    >;
+
+    using lazy_state_storage_type = tlu::apply_t<lazy_state_type_list, lazy_state_storage>;
+
+    //The lazy state storage (if any) is the last element of the tuple
+    using state_holder_tuple_type = tlu::push_back_if_t
+    <
+        tlu::apply_t<eager_state_type_list, machine_object_holder_tuple_t>,
+        lazy_state_storage_type,
+        !tlu::empty_v<lazy_state_type_list>
     >;
-    using state_holder_tuple_type = tlu::apply_t<non_empty_state_type_list, machine_object_holder_tuple_t>;
 
     using initial_state_def_type = detail::tlu::front_t<state_def_type_list>;
 
+    /*
+    The index of the active state (or stopped_state_index if the region is
+    stopped) is stored in the smallest unsigned type that can hold it.
+    */
+    static constexpr auto stopped_state_index_value = tlu::size_v<state_def_type_list>;
+    using active_state_index_type = smallest_unsigned_t<stopped_state_index_value>;
+    static constexpr auto state_index_bit_count = bit_width(stopped_state_index_value);
+
+public:
+    static constexpr auto stopped_state_index = static_cast<active_state_index_type>(stopped_state_index_value);
+
+private:
+
+    using submachine_type_list = tlu::filter_t
+    <
+        state_type_list,
+        state_traits::is_submachine
+    >;
+
+public:
+    /*
+    Whether processing Event can have any effect on this region, i.e. whether
+    Event can trigger a transition or a call to on_event(), in this region or in
+    the regions of its submachines (recursively).
+    */
+    template<class Event>
+    static constexpr auto handles_event_v =
+        !tlu::empty_v<transition_table_filters::by_event_t<transition_table_type, Event>> ||
+        any_state_handles_event<state_type_list, Event>::value
+    ;
+
+    /*
+    The event types that are explicitly named by the transition table of this
+    region, by the on_event_for lists of its states and, recursively, by its
+    submachines.
+    */
+    using event_type_list = tlu::left_fold_t
+    <
+        state_type_list,
+        add_state_event_types_t,
+        add_transition_table_event_types_t<type_list<>, transition_table_type>
+    >;
+
+    /*
+    Flat view of this region and of the regions of its submachines
+    (recursively, depth-first), used by machine_pool.
+    */
+    static constexpr auto flat_region_count = 1 + flat_info_of<submachine_type_list>::region_count;
+    static constexpr auto flat_max_state_count = std::max
+    (
+        static_cast<int>(tlu::size_v<state_def_type_list>),
+        flat_info_of<submachine_type_list>::max_state_count
+    );
+    static constexpr auto flat_has_submachine_context = flat_info_of<submachine_type_list>::has_submachine_context;
+    static constexpr auto flat_back_reference_size =
+        (std::is_empty_v<back_references_type> ? 0 : sizeof(back_references_type)) +
+        flat_info_of<submachine_type_list>::back_reference_size
+    ;
+    static constexpr auto flat_state_index_bit_count =
+        state_index_bit_count +
+        flat_info_of<submachine_type_list>::state_index_bit_count
+    ;
+
+    //Whether a state of this region has a timeout (see state_conf::timeout)
+    static constexpr auto has_timed_state = region_has_timed_state_v<ParentSm, Index>;
+
+    static constexpr auto flat_has_timed_state =
+        has_timed_state ||
+        flat_info_of<submachine_type_list>::has_timed_state
+    ;
+
+    //Whether a state of this region is lazily constructed (see
+    //state_conf::lazy_construction)
+    static constexpr auto flat_has_lazy_state =
+        !tlu::empty_v<lazy_state_type_list> ||
+        flat_info_of<submachine_type_list>::has_lazy_state
+    ;
+
+    //Whether a state of this region may hold per-instance data (see
+    //state_traits::is_stateful_v)
+    static constexpr auto flat_has_stateful_state =
+        state_traits::any_is_stateful<state_def_type_list>::value ||
+        flat_info_of<submachine_type_list>::has_stateful_state
+    ;
+
+    /*
+    A type that identifies the layout of this region, i.e. its state
+    definitions and, recursively, the layouts of its submachines.
+    */
+    using layout_type = type_list
+    <
+        state_def_type_list,
+        tlu::apply_t<submachine_type_list, layout_type_list_t>
+    >;
+
+    /*
+    Calls fun(region) for this region and for the regions of its submachines
+    (recursively, depth-first).
+    */
+    template<class F>
+    void for_each_region(F& fun)
+    {
+        fun(*this);
+        tlu::for_each<submachine_type_list, submachine_for_each_region>(*this, fun);
+    }
+
+    template<class F>
+    void for_each_region(F& fun) const
+    {
+        fun(*this);
+        tlu::for_each<submachine_type_list, submachine_for_each_region>(*this, fun);
+    }
+
+    [[nodiscard]] std::size_t active_state_index() const
+    {
+        return active_state_index_;
+    }
+
+    /*
+    Makes the state of the given index (which can be stopped_state_index) the
+    active state, without calling any on_exit() or on_entry() function. Lazily
+    constructed states are destroyed and constructed as needed.
+    */
+    void restore_active_state_index(const std::size_t index)
+    {
+        if constexpr(!tlu::empty_v<lazy_state_type_list>)
+        {
+            tlu::for_each_or<lazy_state_type_list, destroy_lazy_state_if_active>(*this);
+
+            //Don't let the region refer to a destroyed state, in case the
+            //construction of the new state throws.
+            active_state_index_ = stopped_state_index;
+
+            tlu::for_each_or<lazy_state_type_list, construct_lazy_state_of_index>(*this, index);
+        }
+
+        active_state_index_ = static_cast<active_state_index_type>(index);
+
+        //Give the restored state a whole new timeout
+        if constexpr(has_timed_state)
+        {
+            disarm_timeout();
+            with_active_state_def<state_def_type_list, arm_timeout_of_active_state>(*this);
+        }
+    }
+
+    /*
+    Calls the on_entry() function of the active state (if any), as if it had
+    just been entered, without executing any transition. For a submachine, also
+    does so in its regions.
+    */
+    template<class Event>
+    void call_on_entry_of_active_state(const Event& event)
+    {
+        with_active_state_def<state_def_type_list, call_on_entry_of_active_state_2>
+        (
+            *this,
+            event
+        );
+    }
+
+    /*
+    Calls fun(active_state_index, stopped_state_index) for this region and for
+    the regions of its submachines (recursively, depth-first).
+    */
+    template<class F>
+    void for_each_active_state_index(F& fun)
+    {
+        fun(active_state_index_, stopped_state_index);
+        tlu::for_each<submachine_type_list, submachine_for_each_active_state_index>(*this, fun);
+    }
+
+    /*
+    Whether the given active state indexes (one per region of the flat view of
+    the root machine) are consistent for this region and, recursively, for the
+    regions of its submachines:
+    - the index of the active state must be valid;
+    - the region must be stopped if and only if it isn't running (i.e. if its
+      parent submachine isn't active).
+    */
+    template<class Indexes>
+    static bool is_valid_configuration(const Indexes& indexes, const bool running)
+    {
+        const auto index = static_cast<std::size_t>(indexes[flat_region_index()]);
+        if(index > stopped_state_index || (index != stopped_state_index) != running)
+        {
+            return false;
+        }
+
+        return !tlu::for_each_or<submachine_type_list, submachine_has_invalid_configuration>(indexes, index);
+    }
+
+    //Index of this region in the flat view
+    static constexpr std::size_t flat_region_index()
+    {
+        return ParentSm::template flat_region_index_of<region>();
+    }
+
+    //Flat index of the first region of the given submachine
+    template<class Submachine>
+    static constexpr std::size_t flat_region_offset_of()
+    {
+        return flat_region_index() + 1 + flat_region_count_before_v<submachine_type_list, Submachine>;
+    }
+
+    /*
+    Pretty name of the state of the given index, in the region of the given
+    flat index (relative to this region).
+    Empty if there's no such state.
+    */
+    static std::string flat_state_pretty_name(std::size_t region_index, std::size_t state_index)
+    {
+        auto name = std::string{};
+        if(region_index == 0)
+        {
+            tlu::for_each_or<state_def_type_list, state_def_pretty_name_at>(state_index, name);
+        }
+        else
+        {
+            --region_index;
+            tlu::for_each_or<submachine_type_list, flat_state_pretty_name_in>(region_index, state_index, name);
+        }
+        return name;
+    }
+
+private:
+    struct call_on_entry_of_active_state_2
+    {
+        template<class ActiveStateDef, class Event>
+        static void call(region& self, const Event& event)
+        {
+            self.arm_timeout<ActiveStateDef>();
+
+            auto& state = self.state_from_state_def<ActiveStateDef>();
+            if constexpr(state_traits::is_submachine_v<std::decay_t<decltype(state)>>)
+            {
+                state.call_on_entry_of_active_states(event);
+            }
+            else
+            {
+                detail::call_on_entry(state, self.root_sm(), event);
+            }
+        }
+    };
+
+    struct arm_timeout_of_active_state
+    {
+        template<class ActiveStateDef>
+        static void call(region& self)
+        {
+            self.arm_timeout<ActiveStateDef>();
+        }
+    };
+
+    template<class StateDef>
+    void arm_timeout()
+    {
+        if constexpr(state_traits::has_timeout_v<StateDef>)
+        {
+            this->timeout_timer.pfire = &process_timeout_event<StateDef>;
+            root_sm().timeout_scheduler.arm(this->timeout_timer, state_traits::timeout_of_v<StateDef>);
+        }
+    }
+
+    template<class StateDef>
+    void disarm_timeout_of()
+    {
+        if constexpr(state_traits::has_timeout_v<StateDef>)
+        {
+            disarm_timeout();
+        }
+    }
+
+    void disarm_timeout()
+    {
+        root_sm().timeout_scheduler.disarm(this->timeout_timer);
+    }
+
+    //Called by the timeout scheduler of the root machine
+    template<class StateDef>
+    static void process_timeout_event(timing_wheel_node& timer)
+    {
+        MAKI_DETAIL_OFFSET_OF(offset, timeout_timer_type, timeout_timer)
+        auto& self = static_cast<region&>(container_of<timeout_timer_type>(timer, offset));
+        self.root_sm().process_event(events::timeout<StateDef>{flat_region_index()});
+    }
+
+    /*
+    Whether this region is the recipient of the given event, or contains it
+    (through submachines). Every region is the recipient of every event, except
+    for timeout events, whose recipient is the region of the timed state.
+    */
+    template<class Event>
+    static bool contains_recipient_of([[maybe_unused]] const Event& event)
+    {
+        if constexpr(is_timeout_event_v<Event>)
+        {
+            return
+                event.region_index == Event::any_region ||
+                (
+                    event.region_index >= flat_region_index() &&
+                    event.region_index < flat_region_index() + flat_region_count
+                )
+            ;
+        }
+        else
+        {
+            return true;
+        }
+    }
+
+    struct submachine_for_each_region
+    {
+        template<class Submachine, class Self, class F>
+        static void call(Self& self, F& fun)
+        {
+            self.template state<Submachine>().for_each_region(fun);
+        }
+    };
+
+    struct submachine_has_invalid_configuration
+    {
+        template<class Submachine, class Indexes>
+        static bool call(const Indexes& indexes, const std::size_t index)
+        {
+            const auto active = index == static_cast<std::size_t>(index_of_state_v<transition_table_digest_type, Submachine>);
+            return !Submachine::is_valid_configuration(indexes, active);
+        }
+    };
+
+    struct construct_lazy_state_of_index
+    {
+        template<class State>
+        static bool call(region& self, const std::size_t index)
+        {
+            if(index != static_cast<std::size_t>(index_of_state_v<transition_table_digest_type, State>))
+            {
+                return false;
+            }
+
+            self.lazy_states().template construct<State>(self.root_sm(), self.ctx());
+            return true;
+        }
+    };
+
+    struct submachine_for_each_active_state_index
+    {
+        template<class Submachine, class F>
+        static void call(region& self, F& fun)
+        {
+            self.state<Submachine>().for_each_active_state_index(fun);
+        }
+    };
+
+    struct destroy_lazy_state_if_active
+    {
+        template<class State>
+        static bool call(region& self)
+        {
+            if(!self.is_active_state_type<State>())
+            {
+                return false;
+            }
+
+            self.lazy_states().template destroy<State>();
+            return true;
+        }
+    };
+
     struct stop_2
     {
         template<class ActiveState, class Event>
@@ -298,13 +1040,106 @@ private:
     template<class TransitionTypeList, class Event, class... ExtraArgs>
     bool try_processing_event_in_transitions(const Event& event, ExtraArgs&... extra_args)
     {
-        return tlu::for_each_or
+        if constexpr(machine_conf.jump_table_dispatch)
+        {
+            constexpr const auto& jump_table = transition_jump_table
+            <
+                TransitionTypeList,
+                Event,
+                ExtraArgs...
+            >::value;
+
+            return jump_table[active_state_index_]
+            (
+                *this,
+                event,
+                extra_args...
+            );
+        }
+        else
+        {
+            return tlu::for_each_or
+            <
+                TransitionTypeList,
+                try_processing_event_in_transition
+            >(*this, event, extra_args...);
+        }
+    }
+
+    template<class SourceStateDef, class TransitionTypeList, class Event, class... ExtraArgs>
+    static bool try_processing_event_in_state_transitions(region& self, const Event& event, ExtraArgs&... extra_args)
+    {
+        //List the transitions whose source state pattern matches SourceStateDef
+        using candidate_transition_type_list = transition_table_filters::by_source_state_t
         <
             TransitionTypeList,
-            try_processing_event_in_transition
-        >(*this, event, extra_args...);
+            SourceStateDef
+        >;
+
+        return tlu::for_each_or
+        <
+            candidate_transition_type_list,
+            try_processing_event_in_transition_from<SourceStateDef>
+        >(self, event, extra_args...);
     }
 
+    /*
+    A table of function pointers indexed by the active state index. Each
+    function only tries the transitions (of the given transition list) whose
+    source state pattern matches the corresponding state. The last entry
+    corresponds to the stopped pseudo-state, so that stopped regions don't need
+    a dedicated check.
+    */
+    template<class TransitionTypeList, class Event, class... ExtraArgs>
+    struct transition_jump_table
+    {
+        using fn_ptr_t = bool(*)(region&, const Event&, ExtraArgs&...);
+
+        static bool ignore_event_in_stopped_state(region& /*self*/, const Event& /*event*/, ExtraArgs&... /*extra_args*/)
+        {
+            return false;
+        }
+
+        template<class... StateDefs>
+        struct for_state_defs
+        {
+            static constexpr fn_ptr_t value[] = //NOLINT(cppcoreguidelines-avoid-c-arrays)
+            {
+                &try_processing_event_in_state_transitions
+                <
+                    StateDefs,
+                    TransitionTypeList,
+                    Event,
+                    ExtraArgs...
+                >...,
+                &ignore_event_in_stopped_state
+            };
+        };
+
+        static constexpr const auto& value = tlu::apply_t
+        <
+            state_def_type_list,
+            for_state_defs
+        >::value;
+    };
+
+    //Check guard only, source state being known to be the active state
+    template<class SourceStateDef>
+    struct try_processing_event_in_transition_from
+    {
+        template<class Transition, class Event, class... ExtraArgs>
+        static bool call(region& self, const Event& event, ExtraArgs&... extra_args)
+        {
+            return self.try_executing_transition
+            <
+                SourceStateDef,
+                typename Transition::target_state_type,
+                Transition::action,
+                Transition::guard
+            >(event, extra_args...);
+        }
+    };
+
     //Check active state and guard
     struct try_processing_event_in_transition
     {
@@ -325,16 +1160,22 @@ private:
 
                 static_assert(!tlu::empty_v<matching_state_def_type_list>);
 
-                return tlu::for_each_or
+                //Single bit test
+                if(!self.does_active_state_def_match_pattern<source_state_t>())
+                {
+                    return false;
+                }
+
+                //The active state matches: jump directly to the transition from
+                //it, without visiting every matching state
+                constexpr const auto& jump_table = pattern_transition_jump_table
                 <
-                    matching_state_def_type_list,
-                    try_processing_event_in_transition_2
-                    <
-                        target_state_t,
-                        Transition::action,
-                        Transition::guard
-                    >
-                >(self, event, extra_args...);
+                    Transition,
+                    Event,
+                    ExtraArgs...
+                >::value;
+
+                return jump_table[self.active_state_index_](self, event, extra_args...);
             }
             else
             {
@@ -348,6 +1189,55 @@ private:
         }
     };
 
+    /*
+    A table of function pointers indexed by the active state index, that try
+    the given transition (whose source state is a type pattern) from the
+    corresponding state. The entries of the states that don't match the pattern
+    (and the last one, which corresponds to the stopped pseudo-state) do
+    nothing.
+    */
+    template<class Transition, class Event, class... ExtraArgs>
+    struct pattern_transition_jump_table
+    {
+        using fn_ptr_t = bool(*)(region&, const Event&, ExtraArgs&...);
+
+        static bool ignore_event(region& /*self*/, const Event& /*event*/, ExtraArgs&... /*extra_args*/)
+        {
+            return false;
+        }
+
+        //Note: Unlike the conditional operator, this doesn't instantiate the
+        //transition for the states that don't match the pattern.
+        template<class StateDef>
+        static constexpr fn_ptr_t fn_ptr()
+        {
+            if constexpr(matches_pattern_v<StateDef, typename Transition::source_state_type_pattern>)
+            {
+                return &try_processing_event_in_transition_from<StateDef>::template call<Transition, Event, ExtraArgs...>;
+            }
+            else
+            {
+                return &ignore_event;
+            }
+        }
+
+        template<class... StateDefs>
+        struct for_state_defs
+        {
+            static constexpr fn_ptr_t value[] = //NOLINT(cppcoreguidelines-avoid-c-arrays)
+            {
+                fn_ptr<StateDefs>()...,
+                &ignore_event
+            };
+        };
+
+        static constexpr const auto& value = tlu::apply_t
+        <
+            state_def_type_list,
+            for_state_defs
+        >::value;
+    };
+
     template<class TargetStateDef, const auto& Action, const auto& Guard>
     struct try_processing_event_in_transition_2
     {
@@ -360,23 +1250,43 @@ private:
                 return false;
             }
 
-            //Check guard
-            if(!detail::call_action_or_guard<Guard>(self.root_sm_, self.ctx_, event))
-            {
-                return false;
-            }
-
-            self.process_event_in_transition
+            return self.try_executing_transition
             <
                 SourceStateDef,
                 TargetStateDef,
-                Action
+                Action,
+                Guard
             >(event, extra_args...);
-
-            return true;
         }
     };
 
+    template
+    <
+        class SourceStateDef,
+        class TargetStateDef,
+        const auto& Action,
+        const auto& Guard,
+        class Event,
+        class... ExtraArgs
+    >
+    bool try_executing_transition(const Event& event, ExtraArgs&... extra_args)
+    {
+        //Check guard
+        if(!detail::call_action_or_guard<Guard>(root_sm(), ctx(), event))
+        {
+            return false;
+        }
+
+        process_event_in_transition
+        <
+            SourceStateDef,
+            TargetStateDef,
+            Action
+        >(event, extra_args...);
+
+        return true;
+    }
+
     template<class SourceStateDef, class TargetStateDef, const auto& Action, class Event>
     void process_event_in_transition(const Event& event, bool& processed)
     {
@@ -397,7 +1307,7 @@ private:
         {
             if constexpr(machine_conf.has_before_state_transition)
             {
-                root_sm_.def().template before_state_transition
+                root_sm().def().template before_state_transition
                 <
                     path,
                     SourceStateDef,
@@ -408,25 +1318,48 @@ private:
 
             if constexpr(!std::is_same_v<SourceStateDef, states::stopped>)
             {
+                disarm_timeout_of<SourceStateDef>();
+
                 detail::call_on_exit
                 (
                     state_from_state_def<SourceStateDef>(),
-                    root_sm_,
+                    root_sm(),
                     event
                 );
+
+                if constexpr(is_lazily_constructed_state_def_v<SourceStateDef>)
+                {
+                    lazy_states().template destroy<SourceStateDef>();
+
+                    //Don't let the region refer to a destroyed state, in case
+                    //the construction of the target state throws.
+                    active_state_index_ = stopped_state_index;
+                }
             }
 
-            active_state_index_ = index_of_state_v
-            <
-                state_def_type_list,
-                TargetStateDef
-            >;
+            if constexpr(is_lazily_constructed_state_def_v<TargetStateDef>)
+            {
+                lazy_states().template construct<TargetStateDef>(root_sm(), ctx());
+            }
+
+            active_state_index_ = static_cast<active_state_index_type>
+            (
+                index_of_state_def_v<transition_table_digest_type, TargetStateDef>
+            );
+
+            if constexpr(machine_conf.trace_capacity != 0)
+            {
+                root_sm().trace_buffer_.push
+                (
+                    make_trace_record<SourceStateDef, TargetStateDef, Event>()
+                );
+            }
         }
 
         detail::call_action_or_guard<Action>
         (
-            root_sm_,
-            ctx_,
+            root_sm(),
+            ctx(),
             event
         );
 
@@ -434,17 +1367,19 @@ private:
         {
             if constexpr(!std::is_same_v<TargetStateDef, states::stopped>)
             {
+                arm_timeout<TargetStateDef>();
+
                 detail::call_on_entry
                 (
                     state_from_state_def<TargetStateDef>(),
-                    root_sm_,
+                    root_sm(),
                     event
                 );
             }
 
             if constexpr(machine_conf.has_after_state_transition)
             {
-                root_sm_.def().template after_state_transition
+                root_sm().def().template after_state_transition
                 <
                     path,
                     SourceStateDef,
@@ -467,6 +1402,46 @@ private:
         }
     }
 
+    template<class StateDef>
+    static constexpr auto is_lazily_constructed_state_def_v = state_traits::is_lazily_constructed
+    <
+        state_traits::state_def_to_state_t<StateDef, region>
+    >::value;
+
+    template<class StateDef>
+    static constexpr std::uint16_t trace_state_id()
+    {
+        if constexpr(std::is_same_v<StateDef, states::stopped>)
+        {
+            return trace_record::stopped_state_id;
+        }
+        else
+        {
+            return static_cast<std::uint16_t>(index_of_state_def_v<transition_table_digest_type, StateDef>);
+        }
+    }
+
+    template<class SourceStateDef, class TargetStateDef, class Event>
+    static trace_record make_trace_record()
+    {
+        using event_type_list = typename root_sm_type::event_type_list;
+
+        auto rec = trace_record{};
+        rec.timestamp = machine_conf.trace_clock();
+        rec.region_index = static_cast<std::uint16_t>(flat_region_index());
+        rec.source_state_id = trace_state_id<SourceStateDef>();
+        rec.target_state_id = trace_state_id<TargetStateDef>();
+        if constexpr(tlu::contains_v<event_type_list, Event>)
+        {
+            rec.event_id = static_cast<std::uint16_t>(tlu::index_of_v<event_type_list, Event>);
+        }
+        else
+        {
+            rec.event_id = trace_record::unlisted_event_id;
+        }
+        return rec;
+    }
+
     /*
     Call active_state.on_event(event)
     */
@@ -491,7 +1466,7 @@ private:
             }
 
             auto& state = self.state<State>();
-            call_on_event(state, self.root_sm_, self.ctx_, event, extra_args...);
+            call_on_event(state, self.root_sm(), self.ctx(), event, extra_args...);
             return true;
         }
     };
@@ -501,46 +1476,63 @@ private:
     {
         constexpr auto given_state_index = index_of_state_v
         <
-            state_type_list,
+            transition_table_digest_type,
             State
         >;
-        return given_state_index == active_state_index_;
+        return static_cast<active_state_index_type>(given_state_index) == active_state_index_;
     }
 
     template<class StateDef>
     [[nodiscard]] bool is_active_state_def_type() const
     {
-        constexpr auto given_state_index = index_of_state_v
+        constexpr auto given_state_index = index_of_state_def_v
         <
-            state_def_type_list,
+            transition_table_digest_type,
             StateDef
         >;
-        return given_state_index == active_state_index_;
+        return static_cast<active_state_index_type>(given_state_index) == active_state_index_;
     }
 
     template<class TypePattern>
     [[nodiscard]] bool does_active_state_def_match_pattern() const
     {
-        auto matches = false;
-        with_active_state_def
-        <
-            tlu::push_back_t<state_def_type_list, states::stopped>,
-            does_active_state_def_match_pattern_2<TypePattern>
-        >(matches);
-        return matches;
+        return state_index_mask_of_pattern<TypePattern>::value.test(active_state_index_);
     }
 
+    /*
+    The set of the indices of the states (including the stopped pseudo-state)
+    that match the given pattern, so that matching the active state against a
+    pattern is a single bit test, whatever the number of states.
+    */
     template<class TypePattern>
-    struct does_active_state_def_match_pattern_2
+    struct state_index_mask_of_pattern
     {
-        template<class ActiveState>
-        static void call([[maybe_unused]] bool& matches)
+        using mask_type = bitset<stopped_state_index_value + 1>;
+
+        template<class... StateDefs>
+        struct for_state_defs
         {
-            if constexpr(matches_pattern_v<ActiveState, TypePattern>)
+            static constexpr mask_type make()
             {
-                matches = true;
+                auto mask = mask_type{};
+                auto index = std::size_t{0};
+                (
+                    (
+                        matches_pattern_v<StateDefs, TypePattern> ?
+                            mask.set(index++) :
+                            static_cast<void>(index++)
+                    ),
+                    ...
+                );
+                return mask;
             }
-        }
+        };
+
+        static constexpr mask_type value = tlu::apply_t
+        <
+            tlu::push_back_t<state_def_type_list, states::stopped>,
+            for_state_defs
+        >::make();
     };
 
     template<class StateDefTypeList, class F, class... Args>
@@ -597,7 +1589,11 @@ private:
     template<class State, class Self>
     static auto& static_state(Self& reg)
     {
-        if constexpr(state_traits::needs_unique_instance<State>::value)
+        if constexpr(state_traits::is_lazily_constructed<State>::value)
+        {
+            return get<lazy_state_storage_type>(reg.state_holders_).template get<State>();
+        }
+        else if constexpr(state_traits::needs_unique_instance<State>::value)
         {
             return get<machine_object_holder<State>>(reg.state_holders_).get();
         }
@@ -609,16 +1605,17 @@ private:
         }
     }
 
+    lazy_state_storage_type& lazy_states()
+    {
+        return get<lazy_state_storage_type>(state_holders_);
+    }
+
     template<class T>
     static T static_instance; //NOLINT
 
-    //Store references for faster access
-    root_sm_type& root_sm_; //NOLINT(cppcoreguidelines-avoid-const-or-ref-data-members)
-    std::decay_t<typename ParentSm::context_type>& ctx_; //NOLINT(cppcoreguidelines-avoid-const-or-ref-data-members)
-
     state_holder_tuple_type state_holders_;
 
-    int active_state_index_ = index_of_state_v<state_def_type_list, states::stopped>;
+    active_state_index_type active_state_index_ = stopped_state_index;
 };
 
 template<class ParentSm, int Index>
@@ -14,6 +14,7 @@
 #include "../state_conf.hpp"
 #include "../submachine_conf.hpp"
 #include <type_traits>
+#include <chrono>
 
 namespace maki::detail::state_traits
 {
@@ -114,6 +115,32 @@ constexpr auto requires_on_event_v = std::conditional_t
 >::template value<State, Event>;
 
 
+//handles_event
+
+/*
+Whether Event must be given to the given state, i.e. whether we must call its
+on_event() or, for a submachine, dispatch Event to its regions.
+
+Submachines accept any event (see submachine::conf), so for them we check
+whether Event can have any effect in their subtree instead (see
+submachine::handles_event_v).
+*/
+template<class State, class Event, bool IsSubmachine = is_submachine_v<State>>
+struct handles_event
+{
+    static constexpr auto value = requires_on_event_v<State, Event>;
+};
+
+template<class State, class Event>
+struct handles_event<State, Event, true>
+{
+    static constexpr auto value = State::template handles_event_v<Event>;
+};
+
+template<class State, class Event>
+constexpr auto handles_event_v = handles_event<State, Event>::value;
+
+
 //needs_unique_instance
 
 template<class State>
@@ -122,6 +149,91 @@ struct needs_unique_instance
     static constexpr auto value = !(std::is_empty_v<State> && std::is_trivially_default_constructible_v<State>);
 };
 
+
+//is_lazily_constructed
+
+//Tolerates confs that don't have a lazy_construction member
+template<class State, class Enable = void>
+struct has_lazy_construction_conf
+{
+    static constexpr auto value = false;
+};
+
+template<class State>
+struct has_lazy_construction_conf<State, std::void_t<decltype(State::conf.lazy_construction)>>
+{
+    static constexpr auto value = State::conf.lazy_construction;
+};
+
+template<class State>
+struct is_lazily_constructed
+{
+    static constexpr auto value = needs_unique_instance<State>::value && has_lazy_construction_conf<State>::value;
+};
+
+template<class State>
+struct needs_eager_unique_instance
+{
+    static constexpr auto value = needs_unique_instance<State>::value && !is_lazily_constructed<State>::value;
+};
+
+
+//timeout
+
+//Tolerates confs that don't have a timeout member
+template<class StateDef, class Enable = void>
+struct timeout_of
+{
+    static constexpr auto value = std::chrono::nanoseconds::zero();
+};
+
+template<class StateDef>
+struct timeout_of<StateDef, std::void_t<decltype(StateDef::conf.timeout)>>
+{
+    static constexpr auto value = StateDef::conf.timeout;
+};
+
+template<class StateDef>
+constexpr auto timeout_of_v = timeout_of<StateDef>::value;
+
+template<class StateDef>
+constexpr auto has_timeout_v = timeout_of_v<StateDef> != std::chrono::nanoseconds::zero();
+
+template<class TList>
+struct any_has_timeout;
+
+template<template<class...> class TList, class... StateDefs>
+struct any_has_timeout<TList<StateDefs...>>
+{
+    static constexpr auto value = (has_timeout_v<StateDefs> || ...);
+};
+
+
+//is_stateful
+
+/*
+Whether the given state definition may hold data that are specific to a machine
+instance. Only empty types and types made of a single reference (typically to
+the context or to the machine) are known not to. Without reflection, the size of
+a pointer and the lack of copy assignment operator are the best approximation of
+the latter we can get.
+*/
+template<class StateDef>
+constexpr auto is_stateful_v = !
+(
+    std::is_empty_v<StateDef> ||
+    (sizeof(StateDef) == sizeof(void*) && !std::is_copy_assignable_v<StateDef>)
+);
+
+template<class TList>
+struct any_is_stateful;
+
+template<template<class...> class TList, class... StateDefs>
+struct any_is_stateful<TList<StateDefs...>>
+{
+    static constexpr auto value = (is_stateful_v<StateDefs> || ...);
+};
+
 } //namespace
 
 #endif
@@ -43,7 +43,7 @@ namespace by_required_on_event_detail
         template<class StateDef>
         struct requires_on_event
         {
-            static constexpr auto value = state_traits::requires_on_event_v
+            static constexpr auto value = state_traits::handles_event_v
             <
                 state_traits::state_def_to_state_t<StateDef, Region>,
                 Event
@@ -0,0 +1,58 @@
+//Copyright Florian Goujeon 2021 - 2023.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+#ifndef MAKI_DETAIL_STATIC_FUNCTION_QUEUE_HPP
+#define MAKI_DETAIL_STATIC_FUNCTION_QUEUE_HPP
+
+#include "function_ring.hpp"
+#include <utility>
+#include <cstddef>
+
+namespace maki::detail
+{
+
+/*
+A variant of function_queue whose storage is a fixed-size buffer that is part
+of the object itself. It never allocates.
+*/
+template<class Arg, std::size_t Size>
+class static_function_queue
+{
+public:
+    static_function_queue() = default;
+
+    static_function_queue(const static_function_queue&) = delete;
+    static_function_queue(static_function_queue&&) = delete;
+    static_function_queue& operator=(const static_function_queue&) = delete;
+    static_function_queue& operator=(static_function_queue&&) = delete;
+    ~static_function_queue() = default;
+
+    /*
+    Push call to FunHolder::call(data, arg).
+    Return false if the queue is full, in which case data isn't pushed.
+    */
+    template<class FunHolder, class Data>
+    bool push(Data&& data)
+    {
+        return ring_.template push<FunHolder>(std::forward<Data>(data));
+    }
+
+    void invoke_and_pop_all(Arg arg)
+    {
+        while(!ring_.empty())
+        {
+            ring_.invoke_and_pop_front(arg);
+        }
+    }
+
+private:
+    alignas(std::max_align_t) unsigned char storage_[Size]; //NOLINT
+    function_ring<Arg> ring_{storage_, Size};
+};
+
+} //namespace
+
+#endif
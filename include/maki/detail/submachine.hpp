@@ -15,12 +15,15 @@
 #include "context_holder.hpp"
 #include "submachine_fwd.hpp"
 #include "tuple.hpp"
+#include "container_of.hpp"
 #include "../machine_fwd.hpp"
 #include "../state_conf.hpp"
 #include "../transition_table.hpp"
 #include "../region_path.hpp"
 #include "../type_patterns.hpp"
 #include <type_traits>
+#include <string>
+#include <cstddef>
 
 namespace maki::detail
 {
@@ -110,8 +113,63 @@ struct region_tuple
     >;
 };
 
+/*
+The reference a submachine stores to its root machine, for faster access, and
+its context (or a reference to the context of its parent). In compact layout
+mode (see machine_conf::compact_layout), the submachine only stores its own
+context, if any, and finds the other objects from its own address instead.
+*/
+template
+<
+    class RootSm,
+    class Context,
+    bool StoresRootSm = !RootSm::conf.compact_layout,
+    bool StoresContext = StoresRootSm || !std::is_reference_v<Context>
+>
+struct submachine_back_references
+{
+    template<class... ContextArgs>
+    submachine_back_references(RootSm& root_sm, ContextArgs&&... ctx_args):
+        root_sm_(root_sm),
+        ctx_holder_(root_sm, std::forward<ContextArgs>(ctx_args)...)
+    {
+    }
+
+    RootSm& root_sm_; //NOLINT(cppcoreguidelines-avoid-const-or-ref-data-members)
+    context_holder<Context> ctx_holder_;
+};
+
+template<class RootSm, class Context>
+struct submachine_back_references<RootSm, Context, false, true>
+{
+    template<class... ContextArgs>
+    submachine_back_references(RootSm& root_sm, ContextArgs&&... ctx_args):
+        ctx_holder_(root_sm, std::forward<ContextArgs>(ctx_args)...)
+    {
+    }
+
+    context_holder<Context> ctx_holder_;
+};
+
+template<class RootSm, class Context>
+struct submachine_back_references<RootSm, Context, false, false>
+{
+    template<class... ContextArgs>
+    submachine_back_references(RootSm& /*root_sm*/, ContextArgs&&... /*ctx_args*/)
+    {
+    }
+};
+
+template<class TList, class Region>
+using add_region_event_types_t = add_event_types_t<TList, typename Region::event_type_list>;
+
 template<class Def, class ParentRegion>
-class submachine
+class submachine:
+    private submachine_back_references
+    <
+        root_sm_of_t<submachine<Def, ParentRegion>>,
+        typename submachine_context<Def, ParentRegion>::type
+    >
 {
 public:
     static constexpr auto conf = default_state_conf
@@ -128,8 +186,7 @@ public:
 
     template<class... ContextArgs>
     submachine(root_sm_type& root_sm, ContextArgs&&... ctx_args):
-        root_sm_(root_sm),
-        ctx_holder_(root_sm, std::forward<ContextArgs>(ctx_args)...),
+        back_references_type(root_sm, std::forward<ContextArgs>(ctx_args)...),
         def_holder_(root_sm, context()),
         regions_(uniform_construct, *this)
     {
@@ -137,12 +194,40 @@ public:
 
     root_sm_type& root_sm()
     {
-        return root_sm_;
+        if constexpr(!root_sm_type::conf.compact_layout)
+        {
+            return this->root_sm_;
+        }
+        else if constexpr(std::is_void_v<ParentRegion>)
+        {
+            return root_sm_type::from_submachine(*this);
+        }
+        else
+        {
+            return ParentRegion::from_state(*this).root_sm();
+        }
     }
 
     context_type& context()
     {
-        return ctx_holder_.get();
+        if constexpr(std::is_empty_v<back_references_type>)
+        {
+            //Our context is the one of our parent
+            return ParentRegion::from_state(*this).ctx();
+        }
+        else
+        {
+            return this->ctx_holder_.get();
+        }
+    }
+
+    //Returns the submachine that owns the given region
+    template<class Region>
+    static submachine& from_region(Region& reg)
+    {
+        auto& regions = static_cast<region_tuple_type&>(reg);
+        MAKI_DETAIL_OFFSET_OF(offset, submachine, regions_)
+        return container_of<submachine>(regions, offset);
     }
 
     Def& def()
@@ -230,16 +315,27 @@ public:
     template<class Event>
     void on_entry(const Event& event)
     {
-        call_on_entry(def_holder_.get(), root_sm_, event);
+        call_on_entry(def_holder_.get(), root_sm(), event);
         tlu::for_each<region_tuple_type, region_start>(*this, event);
     }
 
+    /*
+    Same as on_entry(), except that the regions aren't started, but call the
+    on_entry() function of their active state instead.
+    */
+    template<class Event>
+    void call_on_entry_of_active_states(const Event& event)
+    {
+        call_on_entry(def_holder_.get(), root_sm(), event);
+        tlu::for_each<region_tuple_type, region_call_on_entry_of_active_state>(*this, event);
+    }
+
     template<class Event>
     void on_event(const Event& event)
     {
         if constexpr(state_traits::requires_on_event_v<Def, Event>)
         {
-            call_on_event(def_holder_.get(), root_sm_, context(), event);
+            call_on_event(def_holder_.get(), root_sm(), context(), event);
         }
 
         tlu::for_each<region_tuple_type, region_process_event>(*this, event);
@@ -250,7 +346,7 @@ public:
     {
         if constexpr(state_traits::requires_on_event_v<Def, Event>)
         {
-            call_on_event(def_holder_.get(), root_sm_, context(), event);
+            call_on_event(def_holder_.get(), root_sm(), context(), event);
             tlu::for_each<region_tuple_type, region_process_event>(*this, event);
             processed = true;
         }
@@ -264,16 +360,163 @@ public:
     void on_exit(const Event& event)
     {
         tlu::for_each<region_tuple_type, region_stop>(*this, event);
-        call_on_exit(def_holder_.get(), root_sm_, event);
+        call_on_exit(def_holder_.get(), root_sm(), event);
     }
 
 private:
+    using back_references_type = submachine_back_references
+    <
+        root_sm_type,
+        context_type
+    >;
+
     using region_tuple_type = typename region_tuple
     <
         submachine,
         std::make_integer_sequence<int, tlu::size_v<transition_table_type_list>>
     >::type;
 
+public:
+    /*
+    Whether processing Event can have any effect on this submachine (see
+    region::handles_event_v).
+    */
+    template<class Event>
+    static constexpr auto handles_event_v =
+        state_traits::requires_on_event_v<Def, Event> ||
+        any_region_handles_event<region_tuple_type, Event>::value
+    ;
+
+    /*
+    The event types that are explicitly named by the on_event_for list of the
+    definition and by the regions of this submachine (see
+    region::event_type_list).
+    */
+    using event_type_list = tlu::left_fold_t
+    <
+        region_tuple_type,
+        add_region_event_types_t,
+        add_event_types_t<type_list<>, decltype(Def::conf.has_on_event_for)>
+    >;
+
+    /*
+    Flat view of the regions of this submachine (recursively, depth-first),
+    used by machine_pool.
+    */
+    static constexpr auto flat_region_count = flat_info_of<region_tuple_type>::region_count;
+    static constexpr auto flat_max_state_count = flat_info_of<region_tuple_type>::max_state_count;
+    static constexpr auto flat_has_submachine_context =
+        (!std::is_void_v<ParentRegion> && !(Def::conf.context == type_c<void>)) ||
+        flat_info_of<region_tuple_type>::has_submachine_context
+    ;
+    static constexpr auto flat_back_reference_size =
+        (root_sm_type::conf.compact_layout ? 0 : sizeof(root_sm_type*)) +
+        (root_sm_type::conf.compact_layout || !std::is_reference_v<context_type> ? 0 : sizeof(void*)) +
+        flat_info_of<region_tuple_type>::back_reference_size
+    ;
+    static constexpr auto flat_state_index_bit_count = flat_info_of<region_tuple_type>::state_index_bit_count;
+    static constexpr auto flat_has_timed_state = flat_info_of<region_tuple_type>::has_timed_state;
+    static constexpr auto flat_has_lazy_state = flat_info_of<region_tuple_type>::has_lazy_state;
+    static constexpr auto flat_has_stateful_state = flat_info_of<region_tuple_type>::has_stateful_state;
+
+    //See region::layout_type
+    using layout_type = tlu::apply_t<region_tuple_type, layout_type_list_t>;
+
+    //See region::for_each_region()
+    template<class F>
+    void for_each_region(F& fun)
+    {
+        tlu::for_each<region_tuple_type, region_for_each_region>(*this, fun);
+    }
+
+    template<class F>
+    void for_each_region(F& fun) const
+    {
+        tlu::for_each<region_tuple_type, region_for_each_region>(*this, fun);
+    }
+
+    template<class F>
+    void for_each_active_state_index(F& fun)
+    {
+        tlu::for_each<region_tuple_type, region_for_each_active_state_index>(*this, fun);
+    }
+
+    //See region::is_valid_configuration()
+    template<class Indexes>
+    static bool is_valid_configuration(const Indexes& indexes, const bool running)
+    {
+        return !tlu::for_each_or<region_tuple_type, region_has_invalid_configuration>(indexes, running);
+    }
+
+    //Flat index of the first region of this submachine
+    static constexpr std::size_t flat_region_offset()
+    {
+        if constexpr(std::is_void_v<ParentRegion>)
+        {
+            return 0;
+        }
+        else
+        {
+            return ParentRegion::template flat_region_offset_of<submachine>();
+        }
+    }
+
+    //Flat index of the given region of this submachine
+    template<class Region>
+    static constexpr std::size_t flat_region_index_of()
+    {
+        return flat_region_offset() + flat_region_count_before_v<region_tuple_type, Region>;
+    }
+
+    /*
+    Pretty name of the state of the given index, in the region of the given
+    flat index (relative to the first region of this submachine).
+    Empty if there's no such state.
+    */
+    static std::string flat_state_pretty_name(std::size_t region_index, const std::size_t state_index)
+    {
+        auto name = std::string{};
+        tlu::for_each_or<region_tuple_type, flat_state_pretty_name_in>(region_index, state_index, name);
+        return name;
+    }
+
+private:
+    struct region_has_invalid_configuration
+    {
+        template<class Region, class Indexes>
+        static bool call(const Indexes& indexes, const bool running)
+        {
+            return !Region::is_valid_configuration(indexes, running);
+        }
+    };
+
+    struct region_for_each_region
+    {
+        template<class Region, class Self, class F>
+        static void call(Self& self, F& fun)
+        {
+            get<Region>(self.regions_).for_each_region(fun);
+        }
+    };
+
+    struct region_for_each_active_state_index
+    {
+        template<class Region, class F>
+        static void call(submachine& self, F& fun)
+        {
+            get<Region>(self.regions_).for_each_active_state_index(fun);
+        }
+    };
+
+    struct region_call_on_entry_of_active_state
+    {
+        template<class Region, class Event>
+        static void call(submachine& self, const Event& event)
+        {
+            get<Region>(self.regions_).call_on_entry_of_active_state(event);
+        }
+    };
+
     struct region_start
     {
         template<class Region, class Event>
@@ -301,10 +544,6 @@ private:
         }
     };
 
-    //Store references for faster access
-    root_sm_type& root_sm_; //NOLINT(cppcoreguidelines-avoid-const-or-ref-data-members)
-
-    context_holder<context_type> ctx_holder_;
     detail::machine_object_holder<Def> def_holder_;
     region_tuple_type regions_;
 };
@@ -0,0 +1,84 @@
+//Copyright Florian Goujeon 2021 - 2023.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+#ifndef MAKI_DETAIL_TIMEOUT_SCHEDULER_HPP
+#define MAKI_DETAIL_TIMEOUT_SCHEDULER_HPP
+
+#include "timing_wheel.hpp"
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+
+namespace maki::detail
+{
+
+/*
+The timing wheel of the state timeouts of a machine, along with the conversion
+from the time of the clock to ticks of the wheel.
+
+The timers themselves are nodes embedded into the regions, so that arming one
+never allocates.
+*/
+template<class Clock, class Resolution>
+class timeout_scheduler
+{
+public:
+    timeout_scheduler():
+        epoch_(Clock::now())
+    {
+    }
+
+    void arm(timing_wheel_node& node, const std::chrono::nanoseconds timeout)
+    {
+        wheel_.disarm(node);
+
+        //Compute the expiry from the exact current time (rather than from the
+        //current tick, which is rounded down), so that the timeout never
+        //expires early
+        const auto expiry_tick = std::chrono::ceil<Resolution>(Clock::now() - epoch_ + timeout).count();
+        wheel_.arm(node, expiry_tick > 0 ? static_cast<std::uint64_t>(expiry_tick) : 0);
+    }
+
+    void disarm(timing_wheel_node& node)
+    {
+        wheel_.disarm(node);
+    }
+
+    std::size_t process()
+    {
+        return wheel_.advance_to(now_tick());
+    }
+
+private:
+    [[nodiscard]] std::uint64_t now_tick() const
+    {
+        const auto elapsed = std::chrono::duration_cast<Resolution>(Clock::now() - epoch_).count();
+        return elapsed > 0 ? static_cast<std::uint64_t>(elapsed) : 0;
+    }
+
+    typename Clock::time_point epoch_;
+    timing_wheel<> wheel_;
+};
+
+/*
+The timeout scheduler of a machine. The machine derives from this class so
+that, when no state has a timeout, the empty base optimization applies and the
+machine doesn't grow.
+*/
+template<class Clock, class Resolution, bool HasTimedState>
+struct timeout_scheduler_holder
+{
+};
+
+template<class Clock, class Resolution>
+struct timeout_scheduler_holder<Clock, Resolution, true>
+{
+    detail::timeout_scheduler<Clock, Resolution> timeout_scheduler;
+};
+
+} //namespace
+
+#endif
@@ -0,0 +1,338 @@
+//Copyright Florian Goujeon 2021 - 2023.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+#ifndef MAKI_DETAIL_TIMING_WHEEL_HPP
+#define MAKI_DETAIL_TIMING_WHEEL_HPP
+
+#include "integer.hpp"
+#include "container_of.hpp"
+#include <cstdint>
+#include <cstddef>
+
+namespace maki::detail
+{
+
+/*
+An intrusive node of timing_wheel. Whoever owns the node (a timer service, a
+state...) embeds it, so that arming a timer never allocates.
+*/
+struct timing_wheel_node
+{
+    [[nodiscard]] bool is_armed() const
+    {
+        return pprev != nullptr;
+    }
+
+    //Called (with the node already disarmed) when the timer expires
+    void(*pfire)(timing_wheel_node&) = nullptr;
+
+    std::uint64_t expiry_tick = 0;
+
+    //Index of the slot that contains the node, as given by the wheel
+    std::size_t slot_id = 0;
+
+    //Intrusive doubly-linked list, for O(1) removal
+    timing_wheel_node* pnext = nullptr;
+    timing_wheel_node** pprev = nullptr;
+};
+
+/*
+A hierarchical timing wheel, as described by Varghese and Lauck.
+
+The wheel is made of LevelCount levels of 64 slots. A slot of level N covers
+64^N ticks. Each timer is stored into the slot of the lowest level that can
+tell its expiry tick from the current tick. When the current tick reaches the
+start of the range covered by a slot of a higher level, the timers of this slot
+are cascaded down into the lower levels.
+
+Arming and disarming a timer are O(1). Advancing the wheel skips empty slots of
+the lowest level, using a bitmap of the non-empty slots.
+
+Each slot is a FIFO list: timers are appended to it, both when they're armed
+and when they're cascaded. Timers that expire on the same tick therefore fire
+in the order in which they've been armed.
+
+Timers that are too far into the future for the top level are kept into an
+overflow list, which is redistributed whenever the top level wraps around.
+*/
+template<std::size_t LevelCount = 4>
+class timing_wheel
+{
+public:
+    timing_wheel() = default;
+    timing_wheel(const timing_wheel&) = delete;
+    timing_wheel(timing_wheel&&) = delete;
+    timing_wheel& operator=(const timing_wheel&) = delete;
+    timing_wheel& operator=(timing_wheel&&) = delete;
+
+    ~timing_wheel()
+    {
+        for(auto& level: levels_)
+        {
+            for(auto& slot: level.slots)
+            {
+                disarm_all(slot);
+            }
+        }
+        disarm_all(overflow_);
+    }
+
+    [[nodiscard]] std::uint64_t current_tick() const
+    {
+        return current_tick_;
+    }
+
+    [[nodiscard]] std::size_t armed_count() const
+    {
+        return armed_count_;
+    }
+
+    /*
+    Arms the given (disarmed) node. A node whose expiry tick isn't after the
+    current tick fires at the next advance.
+    */
+    void arm(timing_wheel_node& node, const std::uint64_t expiry_tick)
+    {
+        node.expiry_tick = expiry_tick <= current_tick_ ? current_tick_ + 1 : expiry_tick;
+        insert(node);
+        ++armed_count_;
+    }
+
+    //Does nothing if the node isn't armed
+    void disarm(timing_wheel_node& node)
+    {
+        if(node.is_armed())
+        {
+            unlink(node);
+            --armed_count_;
+        }
+    }
+
+    /*
+    Fires every timer whose expiry tick is lower than or equal to the given
+    tick, in expiry order (then in arming order). Returns the number of fired
+    timers.
+
+    Timers may be armed and disarmed from within the fire callbacks.
+    */
+    std::size_t advance_to(const std::uint64_t tick)
+    {
+        auto fired_count = std::size_t{0};
+
+        while(current_tick_ < tick)
+        {
+            if(armed_count_ == 0)
+            {
+                current_tick_ = tick;
+                break;
+            }
+
+            current_tick_ = next_interesting_tick(tick);
+
+            cascade();
+
+            //Fire the timers of the current slot of the lowest level
+            auto& slot = levels_[0].slots[slot_index(current_tick_, 0)]; //NOLINT(cppcoreguidelines-pro-bounds-constant-array-index)
+            while(slot.phead != nullptr)
+            {
+                auto& node = *slot.phead;
+                unlink(node);
+                --armed_count_;
+                node.pfire(node);
+                ++fired_count;
+            }
+        }
+
+        return fired_count;
+    }
+
+private:
+    static constexpr auto slot_bit_count = std::size_t{6};
+    static constexpr auto slot_count = std::size_t{1} << slot_bit_count;
+    static constexpr auto slot_index_mask = std::uint64_t{slot_count - 1};
+
+    struct slot_type
+    {
+        timing_wheel_node* phead = nullptr;
+        timing_wheel_node* ptail = nullptr;
+    };
+
+    struct level_type
+    {
+        slot_type slots[slot_count]; //NOLINT(cppcoreguidelines-avoid-c-arrays)
+
+        //Bit N is set if slots[N] isn't empty
+        std::uint64_t occupancy = 0;
+    };
+
+    static_assert(LevelCount >= 1 && LevelCount * slot_bit_count < 64);
+
+    //The slot ID of the overflow list
+    static constexpr auto overflow_slot_id = LevelCount * slot_count;
+
+    static std::size_t slot_index(const std::uint64_t tick, const std::size_t level)
+    {
+        return static_cast<std::size_t>((tick >> (level * slot_bit_count)) & slot_index_mask);
+    }
+
+    //The tick of the next slot of the lowest level to visit, or the given tick
+    [[nodiscard]] std::uint64_t next_interesting_tick(const std::uint64_t max_tick) const
+    {
+        const auto next_tick = current_tick_ + 1;
+
+        //Occupied slots of the lowest level at or after next_tick, before the
+        //next wrap around
+        const auto occupancy = levels_[0].occupancy >> slot_index(next_tick, 0);
+        const auto candidate_tick = occupancy != 0 ?
+            next_tick + static_cast<std::uint64_t>(bit_width(occupancy & (~occupancy + 1)) - 1) :
+            (next_tick | slot_index_mask) + 1; //Next wrap around, which may cascade
+
+        //If next_tick is itself a wrap around, it must be visited
+        const auto interesting_tick = (next_tick & slot_index_mask) == 0 ? next_tick : candidate_tick;
+
+        return interesting_tick < max_tick ? interesting_tick : max_tick;
+    }
+
+    //Moves the timers of the higher level slots that start at the current tick
+    //down into the lower levels
+    void cascade()
+    {
+        constexpr auto top_level_tick_count_bit_count = LevelCount * slot_bit_count;
+        if((current_tick_ & ((std::uint64_t{1} << top_level_tick_count_bit_count) - 1)) == 0)
+        {
+            reinsert_all(overflow_);
+        }
+
+        for(auto level = LevelCount - 1; level >= 1; --level)
+        {
+            const auto low_bits_mask = (std::uint64_t{1} << (level * slot_bit_count)) - 1;
+            if((current_tick_ & low_bits_mask) == 0)
+            {
+                reinsert_all(levels_[level].slots[slot_index(current_tick_, level)]); //NOLINT(cppcoreguidelines-pro-bounds-constant-array-index)
+            }
+        }
+    }
+
+    void reinsert_all(slot_type& slot)
+    {
+        if(slot.phead == nullptr)
+        {
+            return;
+        }
+
+        //Detach the whole list first, as nodes of the overflow list may go
+        //back to it
+        auto pnode = slot.phead;
+        slot.phead = nullptr;
+        slot.ptail = nullptr;
+        clear_occupancy_bit(pnode->slot_id);
+
+        while(pnode != nullptr)
+        {
+            const auto pnext = pnode->pnext;
+            pnode->pnext = nullptr;
+            pnode->pprev = nullptr;
+            insert(*pnode);
+            pnode = pnext;
+        }
+    }
+
+    void disarm_all(slot_type& slot)
+    {
+        while(slot.phead != nullptr)
+        {
+            unlink(*slot.phead);
+        }
+    }
+
+    void insert(timing_wheel_node& node)
+    {
+        //The lowest level at which the expiry tick and the current tick are in
+        //the same slot range
+        const auto diff = node.expiry_tick ^ current_tick_;
+        const auto level = diff == 0 ?
+            std::size_t{0} :
+            static_cast<std::size_t>(bit_width(diff) - 1) / slot_bit_count;
+
+        if(level >= LevelCount)
+        {
+            node.slot_id = overflow_slot_id;
+            link(node, overflow_);
+            return;
+        }
+
+        const auto index = slot_index(node.expiry_tick, level);
+        node.slot_id = level * slot_count + index;
+        link(node, levels_[level].slots[index]); //NOLINT(cppcoreguidelines-pro-bounds-constant-array-index)
+        levels_[level].occupancy |= std::uint64_t{1} << index; //NOLINT(cppcoreguidelines-pro-bounds-constant-array-index)
+    }
+
+    //Appends the given node to the given slot
+    static void link(timing_wheel_node& node, slot_type& slot)
+    {
+        node.pnext = nullptr;
+        node.pprev = slot.ptail != nullptr ? &slot.ptail->pnext : &slot.phead;
+        *node.pprev = &node;
+        slot.ptail = &node;
+    }
+
+    void unlink(timing_wheel_node& node)
+    {
+        auto& slot = slot_of(node.slot_id);
+
+        *node.pprev = node.pnext;
+        if(node.pnext != nullptr)
+        {
+            node.pnext->pprev = node.pprev;
+        }
+        else
+        {
+            //The node was the tail. The new tail is the node whose pnext member
+            //pprev points to, if any.
+            MAKI_DETAIL_OFFSET_OF(offset, timing_wheel_node, pnext)
+            slot.ptail = node.pprev == &slot.phead ?
+                nullptr :
+                &container_of<timing_wheel_node>(*node.pprev, offset)
+            ;
+        }
+        node.pnext = nullptr;
+        node.pprev = nullptr;
+
+        //Clear the occupancy bit if we've just emptied a slot
+        if(slot.phead == nullptr)
+        {
+            clear_occupancy_bit(node.slot_id);
+        }
+    }
+
+    slot_type& slot_of(const std::size_t slot_id)
+    {
+        if(slot_id == overflow_slot_id)
+        {
+            return overflow_;
+        }
+        return levels_[slot_id / slot_count].slots[slot_id % slot_count]; //NOLINT(cppcoreguidelines-pro-bounds-constant-array-index)
+    }
+
+    void clear_occupancy_bit(const std::size_t slot_id)
+    {
+        if(slot_id != overflow_slot_id)
+        {
+            const auto level = slot_id / slot_count;
+            const auto index = slot_id % slot_count;
+            levels_[level].occupancy &= ~(std::uint64_t{1} << index); //NOLINT(cppcoreguidelines-pro-bounds-constant-array-index)
+        }
+    }
+
+    level_type levels_[LevelCount]; //NOLINT(cppcoreguidelines-avoid-c-arrays)
+    slot_type overflow_;
+    std::uint64_t current_tick_ = 0;
+    std::size_t armed_count_ = 0;
+};
+
+} //namespace
+
+#endif
@@ -7,49 +7,81 @@
 #ifndef MAKI_DETAIL_TLU_FILTER_HPP
 #define MAKI_DETAIL_TLU_FILTER_HPP
 
+#include <utility>
+#include <array>
+#include <cstddef>
+
 namespace maki::detail::tlu
 {
 
+/*
+The implementation is flat, so that filtering a list of N types doesn't require
+N nested instantiations:
+1. we evaluate the predicate for all the types at once;
+2. we compute the indexes of the selected types in a constexpr array;
+3. we get the type at each selected index through overload resolution against
+   a class that derives from one indexed_type<Index, T> per type.
+*/
+
 namespace filter_detail
 {
-    template
-    <
-        class TList,
-        class UList
-    >
-    struct concat;
-
-    template
-    <
-        template<class...> class TList,
-        class... Ts,
-        class... Us
-    >
-    struct concat<TList<Ts...>, TList<Us...>>
+    template<bool... Selections>
+    struct selected_indexes
     {
-        using type = TList<Ts..., Us...>;
+        static constexpr bool selections[] = {Selections..., false}; //NOLINT
+
+        //Note: We count with a loop rather than with a fold expression, whose
+        //number of operands is limited by some compilers (e.g. 256 for Clang).
+        static constexpr auto count = []
+        {
+            auto selection_count = std::size_t{0};
+            for(auto i = std::size_t{0}; i < sizeof...(Selections); ++i)
+            {
+                if(selections[i]) //NOLINT(cppcoreguidelines-pro-bounds-constant-array-index)
+                {
+                    ++selection_count;
+                }
+            }
+            return selection_count;
+        }();
+
+        static constexpr auto value = []
+        {
+            auto indexes = std::array<std::size_t, count>{};
+            auto selected_index = std::size_t{0};
+            for(auto i = std::size_t{0}; i < sizeof...(Selections); ++i)
+            {
+                if(selections[i]) //NOLINT(cppcoreguidelines-pro-bounds-constant-array-index)
+                {
+                    indexes[selected_index] = i; //NOLINT(cppcoreguidelines-pro-bounds-constant-array-index)
+                    ++selected_index;
+                }
+            }
+            return indexes;
+        }();
     };
 
-    template
-    <
-        template<class...> class TList,
-        class T,
-        bool B
-    >
-    struct make_type_list_from_type_if
+    template<std::size_t Index, class T>
+    struct indexed_type
     {
-        using type = TList<T>;
+        using type = T;
     };
 
-    template
-    <
-        template<class...> class TList,
-        class T
-    >
-    struct make_type_list_from_type_if<TList, T, false>
+    template<class IndexSequence, class... Ts>
+    struct indexed_types;
+
+    template<std::size_t... Indexes, class... Ts>
+    struct indexed_types<std::index_sequence<Indexes...>, Ts...>:
+        indexed_type<Indexes, Ts>...
     {
-        using type = TList<>;
     };
+
+    //Never defined, only used in unevaluated contexts
+    template<std::size_t Index, class T>
+    indexed_type<Index, T> select(const indexed_type<Index, T>&);
+
+    template<class IndexedTypes, std::size_t Index>
+    using type_at_t = typename decltype(select<Index>(std::declval<IndexedTypes>()))::type;
 }
 
 template
@@ -62,27 +94,30 @@ struct filter;
 template
 <
     template<class...> class TList,
-    class T,
     class... Ts,
     template<class> class Predicate
 >
-struct filter<TList<T, Ts...>, Predicate>
+struct filter<TList<Ts...>, Predicate>
 {
-    using type = typename filter_detail::concat
-    <
-        typename filter_detail::make_type_list_from_type_if<TList, T, Predicate<T>::value>::type,
-        typename filter<TList<Ts...>, Predicate>::type
-    >::type;
-};
+private:
+    using selected_indexes = filter_detail::selected_indexes<static_cast<bool>(Predicate<Ts>::value)...>;
 
-template
-<
-    template<class...> class TList,
-    template<class> class Predicate
->
-struct filter<TList<>, Predicate>
-{
-    using type = TList<>;
+    using indexed_types = filter_detail::indexed_types<std::index_sequence_for<Ts...>, Ts...>;
+
+    template<std::size_t... SelectedIndexIndexes>
+    static auto make(std::index_sequence<SelectedIndexIndexes...> /*indexes*/) ->
+        TList
+        <
+            filter_detail::type_at_t
+            <
+                indexed_types,
+                selected_indexes::value[SelectedIndexIndexes]
+            >...
+        >
+    ;
+
+public:
+    using type = decltype(make(std::make_index_sequence<selected_indexes::count>{}));
 };
 
 /*
@@ -0,0 +1,138 @@
+//Copyright Florian Goujeon 2021 - 2023.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+#ifndef MAKI_DETAIL_TRACE_BUFFER_HPP
+#define MAKI_DETAIL_TRACE_BUFFER_HPP
+
+#include "../trace_record.hpp"
+#include <vector>
+#include <algorithm>
+#include <atomic>
+#include <array>
+#include <cstdint>
+#include <cstddef>
+
+namespace maki::detail
+{
+
+/*
+A ring buffer of trace records, written by a single thread and readable from
+any thread, without locking.
+
+Each slot is made of two atomic words, so that readers never read torn values.
+Like in a seqlock, the writer publishes a sequence number before and after each
+write, so that readers can discard the slots the writer may have overwritten
+while they were reading them.
+*/
+template<std::size_t Capacity>
+class trace_buffer
+{
+public:
+    static_assert
+    (
+        Capacity != 0 && (Capacity & (Capacity - 1)) == 0,
+        "trace_capacity must be a power of two"
+    );
+
+    trace_buffer() = default;
+
+    trace_buffer(const trace_buffer&) = delete;
+    trace_buffer(trace_buffer&&) = delete;
+    trace_buffer& operator=(const trace_buffer&) = delete;
+    trace_buffer& operator=(trace_buffer&&) = delete;
+    ~trace_buffer() = default;
+
+    //Must only be called by the writer thread
+    void push(const trace_record& rec)
+    {
+        const auto seq = seq_.load(std::memory_order_relaxed);
+        const auto index = seq / 2;
+        auto& slot = slots_[index & mask]; //NOLINT(cppcoreguidelines-pro-bounds-constant-array-index)
+
+        //Make readers that see any of the slot stores below see the odd value
+        seq_.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+
+        slot.timestamp.store(rec.timestamp, std::memory_order_relaxed);
+        slot.ids.store(pack_ids(rec), std::memory_order_relaxed);
+
+        seq_.store(seq + 2, std::memory_order_release);
+    }
+
+    //Return the records in chronological order
+    [[nodiscard]] std::vector<trace_record> read() const
+    {
+        //Number of fully written records
+        const auto end = seq_.load(std::memory_order_acquire) / 2;
+        const auto begin = end > Capacity ? end - Capacity : std::size_t{0};
+
+        auto records = std::vector<trace_record>{};
+        records.reserve(end - begin);
+        for(auto i = begin; i != end; ++i)
+        {
+            const auto& slot = slots_[i & mask]; //NOLINT(cppcoreguidelines-pro-bounds-constant-array-index)
+            auto rec = unpack_ids(slot.ids.load(std::memory_order_relaxed));
+            rec.timestamp = slot.timestamp.load(std::memory_order_relaxed);
+            records.push_back(rec);
+        }
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+
+        /*
+        Record i is reliable if the writer hadn't started to write record
+        i + Capacity (which lives in the same slot) when we were done reading.
+        */
+        const auto started_end = (seq_.load(std::memory_order_relaxed) + 1) / 2;
+        const auto valid_begin = started_end > Capacity ? started_end - Capacity : std::size_t{0};
+        if(valid_begin > begin)
+        {
+            const auto overwritten_count = std::min(valid_begin - begin, records.size());
+            records.erase(records.begin(), records.begin() + static_cast<std::ptrdiff_t>(overwritten_count));
+        }
+
+        return records;
+    }
+
+private:
+    static constexpr auto mask = Capacity - 1;
+
+    struct slot
+    {
+        std::atomic<std::int64_t> timestamp = 0;
+        std::atomic<std::uint64_t> ids = 0;
+    };
+
+    static std::uint64_t pack_ids(const trace_record& rec)
+    {
+        return
+            static_cast<std::uint64_t>(rec.region_index) |
+            (static_cast<std::uint64_t>(rec.source_state_id) << 16U) |
+            (static_cast<std::uint64_t>(rec.target_state_id) << 32U) |
+            (static_cast<std::uint64_t>(rec.event_id) << 48U)
+        ;
+    }
+
+    static trace_record unpack_ids(const std::uint64_t ids)
+    {
+        auto rec = trace_record{};
+        rec.region_index = static_cast<std::uint16_t>(ids);
+        rec.source_state_id = static_cast<std::uint16_t>(ids >> 16U);
+        rec.target_state_id = static_cast<std::uint16_t>(ids >> 32U);
+        rec.event_id = static_cast<std::uint16_t>(ids >> 48U);
+        return rec;
+    }
+
+    std::array<slot, Capacity> slots_;
+    /*
+    Twice the number of written records, plus one while a record is being
+    written.
+    */
+    std::atomic<std::size_t> seq_ = 0;
+};
+
+} //namespace
+
+#endif
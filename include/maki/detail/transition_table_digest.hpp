@@ -16,6 +16,8 @@
 #include "machine_object_holder.hpp"
 #include "state_traits.hpp"
 #include <type_traits>
+#include <utility>
+#include <cstddef>
 
 namespace maki::detail
 {
@@ -51,51 +53,165 @@ namespace transition_table_digest_detail
         using type = type_list<state_traits::state_def_to_state_t<Ts, Region>...>;
     };
 
-    template<class TList, class U>
-    using push_back_unique_if_not_null = tlu::push_back_if_t
+    template<class T>
+    struct type_tag
+    {
+        using type = T;
+    };
+
+    template<std::size_t Index, class T>
+    struct indexed_type{};
+
+    /*
+    Set of state definitions, made of a chain of nodes.
+    Each node inherits from its predecessor, so that:
+    - adding a state is a single instantiation that doesn't depend on the size
+      of the set;
+    - checking whether a state is in the set is a matter of std::is_base_of;
+    - the Nth state can be retrieved through overload resolution against
+      indexed_type<N, State>.
+    */
+    struct empty_state_set
+    {
+        static constexpr auto size = std::size_t{0};
+    };
+
+    template<class Set, class State>
+    struct state_set_node:
+        Set,
+        type_tag<State>,
+        indexed_type<Set::size, State>
+    {
+        static constexpr auto size = Set::size + 1;
+    };
+
+    template<class Set, class State>
+    using add_state_t = std::conditional_t
     <
-        TList,
-        U,
-        (!tlu::contains_v<TList, U> && !std::is_same_v<U, null>)
+        std::is_same_v<State, null> || std::is_base_of_v<type_tag<State>, Set>,
+        Set,
+        state_set_node<Set, State>
     >;
 
-    template<class TransitionTable>
-    using initial_state_t = typename tlu::get_t<TransitionTable, 0>::source_state_type_pattern;
+    /*
+    Adds the given states to the given set.
+
+    Note: We don't use a fold expression, whose number of operands is limited
+    by some compilers (e.g. 256 for Clang). We add the states by chunks of 8
+    instead, so that the recursion depth is N/8.
+    */
+    template<class Set, class... States>
+    struct add_states
+    {
+        using type = Set;
+    };
 
-    template<class InitialState>
-    struct initial_digest
+    template<class Set, class State, class... States>
+    struct add_states<Set, State, States...>
     {
-        using state_def_type_list = type_list<InitialState>;
-        static constexpr auto has_null_events = false;
+        using type = typename add_states<add_state_t<Set, State>, States...>::type;
     };
 
-    template<class Digest, class Transition>
-    struct add_transition_to_digest
+    template
+    <
+        class Set,
+        class State0,
+        class State1,
+        class State2,
+        class State3,
+        class State4,
+        class State5,
+        class State6,
+        class State7,
+        class... States
+    >
+    struct add_states<Set, State0, State1, State2, State3, State4, State5, State6, State7, States...>
     {
-        using state_def_type_list = push_back_unique_if_not_null
+        using type = typename add_states
         <
-            typename Digest::state_def_type_list,
-            typename Transition::target_state_type
-        >;
-
-        static constexpr auto has_null_events =
-            Digest::has_null_events ||
-            std::is_same_v<typename Transition::event_type_pattern, null>
-        ;
+            add_state_t<add_state_t<add_state_t<add_state_t<
+            add_state_t<add_state_t<add_state_t<add_state_t<
+                Set,
+                State0>, State1>, State2>, State3>,
+                State4>, State5>, State6>, State7>,
+            States...
+        >::type;
     };
 
-    /*
-    First step with tlu::type_list instead of
-    maki::detail::machine_object_holder_tuple, so that we don't instantiate
-    intermediate tuples.
-    */
-    template<class TransitionTable>
-    using digest_with_type_lists = tlu::left_fold_t
+    //Whether at least one of the given values is true, without a fold
+    //expression (see add_states)
+    template<bool... Values>
+    constexpr auto is_any_true_v = !std::is_same_v
     <
-        TransitionTable,
-        add_transition_to_digest,
-        initial_digest<initial_state_t<TransitionTable>>
+        std::integer_sequence<bool, Values...>,
+        std::integer_sequence<bool, (static_cast<void>(Values), false)...>
     >;
+
+    template<std::size_t Index, class T>
+    type_tag<T> type_at(const indexed_type<Index, T>&);
+
+    template<class T, std::size_t Index>
+    std::integral_constant<std::size_t, Index> index_of_type(const indexed_type<Index, T>&);
+
+    template<class Set, std::size_t... Indexes>
+    type_list<typename decltype(type_at<Indexes>(std::declval<Set>()))::type...> set_to_type_list
+    (
+        std::index_sequence<Indexes...> /*indexes*/
+    );
+
+    template<class IndexSequence, class... Ts>
+    struct index_map;
+
+    template<std::size_t... Indexes, class... Ts>
+    struct index_map<std::index_sequence<Indexes...>, Ts...>:
+        indexed_type<Indexes, Ts>...
+    {
+    };
+
+    template<class TList>
+    struct index_map_of;
+
+    template<class... Ts>
+    struct index_map_of<type_list<Ts...>>
+    {
+        using type = index_map<std::index_sequence_for<Ts...>, Ts...>;
+    };
+
+    template<class Map, class T>
+    constexpr int index_in_map_v = static_cast<int>
+    (
+        decltype(index_of_type<T>(std::declval<Map>()))::value
+    );
+
+    template<class TransitionTable>
+    struct digest_with_type_lists;
+
+    template<template<class...> class TransitionTable, class... Transitions>
+    struct digest_with_type_lists<TransitionTable<Transitions...>>
+    {
+        //The source state of the first transition is the initial state
+        using initial_state_set = state_set_node
+        <
+            empty_state_set,
+            typename tlu::front_t<TransitionTable<Transitions...>>::source_state_type_pattern
+        >;
+
+        using state_def_set = typename add_states
+        <
+            initial_state_set,
+            typename Transitions::target_state_type...
+        >::type;
+
+        using state_def_type_list = decltype
+        (
+            set_to_type_list<state_def_set>(std::make_index_sequence<state_def_set::size>{})
+        );
+
+        static constexpr auto has_null_events = is_any_true_v
+        <
+            std::is_same_v<typename Transitions::event_type_pattern, null>...
+        >;
+    };
 }
 
 template<class TransitionTable, class Region>
@@ -116,6 +232,26 @@ public:
     >;
 
     static constexpr auto has_null_events = digest_type::has_null_events;
+
+private:
+    using state_index_map = typename transition_table_digest_detail::index_map_of<state_type_list>::type;
+
+public:
+    //Index of the given state definition in state_def_type_list
+    template<class StateDef>
+    static constexpr auto state_def_index_v = transition_table_digest_detail::index_in_map_v
+    <
+        typename digest_type::state_def_set,
+        StateDef
+    >;
+
+    //Index of the given state in state_type_list
+    template<class State>
+    static constexpr auto state_index_v = transition_table_digest_detail::index_in_map_v
+    <
+        state_index_map,
+        State
+    >;
 };
 
 } //namespace
@@ -34,6 +34,26 @@ using by_event_t = tlu::filter_t
     by_event_detail::for_event<Event>::template matches_event_pattern
 >;
 
+namespace by_source_state_detail
+{
+    template<class StateDef>
+    struct for_state_def
+    {
+        template<class Row>
+        struct matches_source_state_pattern
+        {
+            static constexpr auto value = matches_pattern_v<StateDef, typename Row::source_state_type_pattern>;
+        };
+    };
+}
+
+template<class TransitionTable, class StateDef>
+using by_source_state_t = tlu::filter_t
+<
+    TransitionTable,
+    by_source_state_detail::for_state_def<StateDef>::template matches_source_state_pattern
+>;
+
 } //namespace
 
 #endif
@@ -0,0 +1,39 @@
+//Copyright Florian Goujeon 2021 - 2023.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+#ifndef MAKI_DETAIL_TYPE_HASH_HPP
+#define MAKI_DETAIL_TYPE_HASH_HPP
+
+#include "type_name.hpp"
+#include <string_view>
+#include <cstdint>
+
+namespace maki::detail
+{
+
+//64-bit FNV-1a
+constexpr std::uint64_t fnv1a_hash(const std::string_view str)
+{
+    auto hash = std::uint64_t{14695981039346656037U};
+    for(const auto c: str)
+    {
+        hash ^= static_cast<unsigned char>(c);
+        hash *= std::uint64_t{1099511628211U};
+    }
+    return hash;
+}
+
+/*
+Hash of the compiler-specific signature of a function template instantiated
+with T. Stable across builds made by the same compiler, but not across
+compilers.
+*/
+template<class T>
+inline constexpr auto type_hash_v = fnv1a_hash(type_name_detail::function_name<T>());
+
+} //namespace
+
+#endif
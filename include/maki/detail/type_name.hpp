@@ -17,7 +17,7 @@ namespace type_name_detail
     using sv_size_t = std::string_view::size_type;
 
     template<class T>
-    std::string_view function_name()
+    constexpr std::string_view function_name()
     {
 #ifdef _MSC_VER
         return static_cast<const char*>(__FUNCSIG__);
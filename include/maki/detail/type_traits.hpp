@@ -8,6 +8,7 @@
 #define MAKI_DETAIL_TYPE_TRAITS_HPP
 
 #include "overload_priority.hpp"
+#include <variant>
 #include <utility>
 
 namespace maki::detail
@@ -62,6 +63,25 @@ struct is_nullary
 template<class F>
 constexpr auto is_nullary_v = is_nullary<F>::value;
 
+//
+//is_variant
+//
+
+template<class T>
+struct is_variant
+{
+    static constexpr auto value = false;
+};
+
+template<class... Ts>
+struct is_variant<std::variant<Ts...>>
+{
+    static constexpr auto value = true;
+};
+
+template<class T>
+constexpr auto is_variant_v = is_variant<T>::value;
+
 } //namespace
 
 #endif
@@ -13,6 +13,8 @@
 #define MAKI_EVENTS_HPP
 
 #include <exception>
+#include <limits>
+#include <cstddef>
 
 /**
 @brief Some predefined events emitted by Maki itself
@@ -42,6 +44,32 @@ struct exception
     std::exception_ptr eptr;
 };
 
+/**
+@brief Event processed by @ref machine whenever the given state has been active
+for longer than its timeout (see @ref state_conf::set_timeout()).
+@tparam State the state definition whose timeout has expired
+
+Since the same state definition can be used in several regions, the event is
+only processed by the region of the state whose timeout has expired and by the
+regions that contain it (through submachines).
+*/
+template<class State>
+struct timeout
+{
+    /**
+    @brief A value of @ref region_index for which every region processes the
+    event.
+    */
+    static constexpr auto any_region = std::numeric_limits<std::size_t>::max();
+
+    /**
+    @brief The index of the region of the state whose timeout has expired,
+    among all the regions of the state machine, depth-first (i.e. in the order
+    of @ref machine_snapshot::active_state_indexes).
+    */
+    std::size_t region_index = any_region;
+};
+
 } //namespace
 
 #endif
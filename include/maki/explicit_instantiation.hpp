@@ -0,0 +1,80 @@
+//Copyright Florian Goujeon 2021 - 2023.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+/**
+@file
+@brief Defines the MAKI_DECLARE_MACHINE and MAKI_DEFINE_MACHINE macros
+*/
+
+#ifndef MAKI_EXPLICIT_INSTANTIATION_HPP
+#define MAKI_EXPLICIT_INSTANTIATION_HPP
+
+#include "machine.hpp"
+#include "events.hpp"
+#include "detail/pp_for_each.hpp"
+
+/**
+@brief Declares explicit instantiations of the entry points of a @ref
+maki::machine specialization, so that the translation units that see this
+declaration don't instantiate them.
+
+@param machine_type the @ref maki::machine specialization (use a type alias if
+it contains commas)
+@param ... the event types that are given to `process_event()` and
+`process_event_now()` (at most 32, without commas)
+
+The declared entry points are:
+- `start()` and `stop()`, with their default event types;
+- `process_event<Event>()` (both the `const Event&` and the `Event&&`
+overloads) and `process_event_now<Event>()`, for each given event type.
+
+Every declaration must be matched by a @ref MAKI_DEFINE_MACHINE with the same
+arguments in exactly one translation unit. Both macros must be used at global
+namespace scope.
+
+Typical usage:
+@code
+//my_machine.hpp
+using my_machine = maki::machine<my_machine_def>;
+MAKI_DECLARE_MACHINE(my_machine, button_press, button_release)
+
+//my_machine.cpp
+#include "my_machine.hpp"
+MAKI_DEFINE_MACHINE(my_machine, button_press, button_release)
+@endcode
+*/
+#define MAKI_DECLARE_MACHINE(machine_type, ...) /*NOLINT*/ \
+    MAKI_DETAIL_INSTANTIATE_MACHINE(declare, machine_type, __VA_ARGS__)
+
+/**
+@brief Explicitly instantiates the entry points of a @ref maki::machine
+specialization.
+
+See @ref MAKI_DECLARE_MACHINE.
+*/
+#define MAKI_DEFINE_MACHINE(machine_type, ...) /*NOLINT*/ \
+    MAKI_DETAIL_INSTANTIATE_MACHINE(define, machine_type, __VA_ARGS__)
+
+//`kind` is either `declare` or `define`
+#define MAKI_DETAIL_INSTANTIATE_MACHINE(kind, machine_type, ...) /*NOLINT*/ \
+    MAKI_DETAIL_INSTANTIATION_PREFIX_##kind void machine_type::start<maki::events::start>(const maki::events::start&); \
+    MAKI_DETAIL_INSTANTIATION_PREFIX_##kind void machine_type::stop<maki::events::stop>(const maki::events::stop&); \
+    MAKI_DETAIL_PP_FOR_EACH(MAKI_DETAIL_INSTANTIATE_MACHINE_EVENT_##kind, machine_type, __VA_ARGS__)
+
+#define MAKI_DETAIL_INSTANTIATION_PREFIX_declare extern template
+#define MAKI_DETAIL_INSTANTIATION_PREFIX_define template
+
+#define MAKI_DETAIL_INSTANTIATE_MACHINE_EVENT_declare(machine_type, event_type) /*NOLINT*/ \
+    extern template void machine_type::process_event<event_type>(const event_type&); \
+    extern template void machine_type::process_event<event_type>(event_type&&); \
+    extern template void machine_type::process_event_now<event_type>(const event_type&);
+
+#define MAKI_DETAIL_INSTANTIATE_MACHINE_EVENT_define(machine_type, event_type) /*NOLINT*/ \
+    template void machine_type::process_event<event_type>(const event_type&); \
+    template void machine_type::process_event<event_type>(event_type&&); \
+    template void machine_type::process_event_now<event_type>(const event_type&);
+
+#endif
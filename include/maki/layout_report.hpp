@@ -0,0 +1,71 @@
+//Copyright Florian Goujeon 2021 - 2023.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+/**
+@file
+@brief Defines the maki::layout_report struct template
+*/
+
+#ifndef MAKI_LAYOUT_REPORT_HPP
+#define MAKI_LAYOUT_REPORT_HPP
+
+#include "detail/submachine.hpp"
+#include <cstddef>
+
+namespace maki
+{
+
+/**
+@brief Compile-time figures about the memory footprint of a @ref machine.
+@tparam Machine the @ref machine type
+
+All the members are `static constexpr`, so that they can be checked with
+`static_assert`. For example:
+@code
+using report = maki::layout_report<my_machine>;
+static_assert(report::back_reference_size == 0);
+static_assert(report::machine_size <= 256);
+@endcode
+*/
+template<class Machine>
+struct layout_report
+{
+private:
+    using submachine_type = detail::submachine<typename Machine::def_type, void>;
+
+public:
+    /**
+    @brief The size of `Machine`, i.e. `sizeof(Machine)`.
+    */
+    static constexpr std::size_t machine_size = sizeof(Machine);
+
+    /**
+    @brief The number of regions of `Machine`, including the regions of its
+    submachines (recursively).
+    */
+    static constexpr std::size_t region_count = submachine_type::flat_region_count;
+
+    /**
+    @brief The number of bytes that the regions and submachines of `Machine`
+    spend on references to the root machine and to their context.
+
+    This is always 0 when @ref machine_conf::compact_layout is enabled.
+    */
+    static constexpr std::size_t back_reference_size = submachine_type::flat_back_reference_size;
+
+    /**
+    @brief The number of bits required to store the index of the active state
+    of every region of `Machine` (including the stopped pseudo-state).
+
+    When this is at most 64, @ref machine_pool bit-packs the whole
+    configuration of an instance into a single word.
+    */
+    static constexpr int state_index_bit_count = submachine_type::flat_state_index_bit_count;
+};
+
+} //namespace
+
+#endif
@@ -13,25 +13,70 @@
 #define MAKI_MACHINE_HPP
 
 #include "machine_conf.hpp"
+#include "machine_snapshot.hpp"
+#include "warm_start.hpp"
 #include "region_path.hpp"
 #include "detail/noinline.hpp"
 #include "detail/submachine.hpp"
+#include "detail/container_of.hpp"
 #include "detail/function_queue.hpp"
+#include "detail/static_function_queue.hpp"
+#include "detail/mpsc_function_queue.hpp"
 #include "detail/tlu.hpp"
 #include "detail/overload_priority.hpp"
+#include "detail/type_traits.hpp"
+#include "detail/trace_buffer.hpp"
+#include "detail/type_hash.hpp"
+#include "detail/integer.hpp"
+#include "detail/timeout_scheduler.hpp"
+#include "trace_record.hpp"
 #include <type_traits>
+#include <iterator>
+#include <variant>
+#include <utility>
+#include <stdexcept>
+#include <vector>
+#include <cstdint>
+#include <cstddef>
 
 namespace maki
 {
 
+template<class Def>
+class machine_pool;
+
 namespace detail
 {
     enum class machine_operation
     {
         start,
+        warm_start,
         stop,
         process_event
     };
+
+    //Whether the first of the given types is a warm_start_t
+    template<class... Ts>
+    struct starts_with_warm_start_tag: std::false_type{};
+
+    template<bool CallOnEntry, class... Ts>
+    struct starts_with_warm_start_tag<warm_start_t<CallOnEntry>, Ts...>: std::true_type{};
+
+    //See machine::handles_event_v
+    template<class Def, class Event>
+    struct machine_handles_event
+    {
+        static constexpr auto value =
+            Def::conf.has_on_unprocessed ||
+            submachine<Def, void>::template handles_event_v<Event>
+        ;
+    };
+
+    template<class Def, class... Events>
+    struct machine_handles_event<Def, std::variant<Events...>>
+    {
+        static constexpr auto value = (machine_handles_event<Def, Events>::value || ...);
+    };
 }
 
 /**
@@ -51,7 +96,13 @@ The state machine type itself can then be defined like so:
 @snippet lamp/src/main.cpp machine
 */
 template<class Def>
-class machine
+class machine:
+    private detail::timeout_scheduler_holder
+    <
+        typename std::decay_t<decltype(Def::conf.clock)>::type,
+        typename std::decay_t<decltype(Def::conf.timeout_resolution)>::type,
+        detail::def_has_timed_state_v<Def>
+    >
 {
 public:
     /**
@@ -74,12 +125,86 @@ public:
     */
     using context_type = typename conf_type::context_type;
 
+    /**
+    @brief The list of the event types the state machine explicitly handles.
+
+    This list contains, without duplicates, all the event types that are named
+    (either directly or through an @ref any_of pattern) in the transition tables
+    of the state machine and of its submachines, as well as in the
+    `has_on_event_for` options of the state machine definition, of the states
+    and of the submachines.
+
+    The position of an event type in this list is its ID (see @ref
+    event_id() and @ref process_event_by_id()).
+    */
+    using event_type_list = typename detail::submachine<Def, void>::event_type_list;
+
+    /**
+    @brief The number of event types of @ref event_type_list.
+    */
+    static constexpr auto event_type_count = static_cast<std::size_t>(detail::tlu::size_v<event_type_list>);
+
+    /**
+    @brief Returns the ID of the given event type, i.e. its index in @ref
+    event_type_list.
+    */
+    template<class Event>
+    static constexpr std::size_t event_id()
+    {
+        static_assert
+        (
+            detail::tlu::contains_v<event_type_list, Event>,
+            "Event isn't in the event type list of the state machine"
+        );
+        return static_cast<std::size_t>(detail::tlu::index_of_v<event_type_list, Event>);
+    }
+
+    /**
+    @brief Whether processing an event of type `Event` can have any effect on
+    the state machine.
+
+    This is `true` if and only if at least one of these conditions is met:
+    - a transition of the state machine or of one of its submachines can be
+    triggered by `Event`;
+    - the `on_event()` function of the state machine definition, of a state or
+    of a submachine is called for `Event`;
+    - machine_conf::has_on_unprocessed is set.
+
+    If `Event` is a `std::variant`, this is `true` if it's `true` for any of
+    its alternatives.
+
+    When this is `false`, @ref process_event(), @ref process_event_now() and
+    @ref enqueue_event() do nothing (not even processing the events that could
+    have been left enqueued because of an exception) and compile to nothing.
+    Routers can also use it to drop unhandled events at compile time.
+    */
+    template<class Event>
+    static constexpr bool handles_event_v = detail::machine_handles_event<Def, Event>::value;
+
+    /**
+    @brief The type returned by @ref snapshot() and given to @ref restore().
+    */
+    using snapshot_type = machine_snapshot
+    <
+        detail::submachine<Def, void>::flat_region_count,
+        detail::smallest_unsigned_t
+        <
+            static_cast<std::uint64_t>(detail::submachine<Def, void>::flat_max_state_count)
+        >
+    >;
+
     static_assert
     (
         detail::is_root_sm_conf_v<std::decay_t<decltype(conf)>>,
         "The root state machine definition must include a 'static constexpr auto conf' of type machine_conf"
     );
 
+    static_assert
+    (
+        conf.run_to_completion_queue_size == 0 || conf.has_on_queue_overflow,
+        "A statically allocated run-to-completion queue requires machine_conf::has_on_queue_overflow to be set"
+    );
+
     /**
     @brief The constructor.
     @param ctx_args the arguments to be passed to the context constructor
@@ -97,7 +222,11 @@ public:
     Finally, unless the @ref machine_conf::auto_start is `false`, `start()` is
     called.
     */
-    template<class... ContextArgs>
+    template
+    <
+        class... ContextArgs,
+        std::enable_if_t<!detail::starts_with_warm_start_tag<std::decay_t<ContextArgs>...>::value, bool> = true
+    >
     explicit machine(ContextArgs&&... ctx_args):
         submachine_(*this, std::forward<ContextArgs>(ctx_args)...)
     {
@@ -108,6 +237,52 @@ public:
         }
     }
 
+    /**
+    @brief The warm-start constructor.
+    @param tag either @ref warm_start or @ref warm_start_with_on_entry
+    @param snap the configuration to start in, as returned by @ref snapshot()
+    @param ctx_args the arguments to be passed to the context constructor
+
+    Instantiates the state machine objects just like the other constructor,
+    then directly makes the states of the given snapshot active (see @ref
+    restore()). No transition is executed, meaning that @ref events::start
+    isn't processed and that no anonymous transition is followed.
+
+    If `tag` is @ref warm_start_with_on_entry and the snapshot isn't the one of
+    a stopped state machine, the `on_entry()` functions of the state machine
+    definition and of the active states are then called.
+
+    @throw std::invalid_argument if @ref restore() rejects the snapshot (i.e.
+    if the snapshot doesn't match the structure of the state machine or isn't a
+    consistent configuration), so that a corrupted or outdated snapshot can't
+    go unnoticed. To fall back to a regular start instead, use the other
+    constructor and call @ref restore().
+    */
+    template<bool CallOnEntry, class... ContextArgs>
+    machine(const warm_start_t<CallOnEntry> /*tag*/, const snapshot_type& snap, ContextArgs&&... ctx_args):
+        submachine_(*this, std::forward<ContextArgs>(ctx_args)...)
+    {
+        if(!restore(snap))
+        {
+            throw std::invalid_argument{"Invalid snapshot given to warm-start constructor of maki::machine"};
+        }
+
+        if constexpr(CallOnEntry)
+        {
+            auto running = false;
+            auto check = [&running](const auto& region)
+            {
+                running = running || region.active_state_index() != region.stopped_state_index;
+            };
+            std::as_const(submachine_).for_each_region(check);
+
+            if(running)
+            {
+                execute_operation_now<detail::machine_operation::warm_start>(events::start{});
+            }
+        }
+    }
+
     machine(const machine&) = delete;
     machine(machine&&) = delete;
     machine& operator=(const machine&) = delete;
@@ -146,12 +321,28 @@ public:
         return submachine_.context();
     }
 
+    /**
+    @brief Returns a copy of the transition trace, from the oldest record to
+    the newest one.
+
+    This function requires @ref machine_conf::trace_capacity to be set. It can
+    be called from any thread, while the machine is processing events.
+    */
+    [[nodiscard]] std::vector<trace_record> trace_records() const
+    {
+        static_assert(conf.trace_capacity != 0, "trace_records() requires a non-zero trace_capacity");
+        return trace_buffer_.read();
+    }
+
     /**
     @brief Returns the state of type `State` instantiated by the region
     indicated by `RegionPath`.
     @tparam RegionPath an instance of @ref region_path pointing to the
     region of interest (see @ref RegionPath)
     @tparam State the state type
+
+    If the state is lazily constructed (see
+    state_conf::enable_lazy_construction()), it must be active.
     */
     template<const auto& RegionPath, class State>
     State& state()
@@ -165,6 +356,9 @@ public:
     @tparam RegionPath an instance of @ref region_path pointing to the
     region of interest (see @ref RegionPath)
     @tparam State the state type
+
+    If the state is lazily constructed (see
+    state_conf::enable_lazy_construction()), it must be active.
     */
     template<const auto& RegionPath, class State>
     const State& state() const
@@ -218,6 +412,78 @@ public:
         return submachine_.template is_active_state_def<State>();
     }
 
+    /**
+    @brief Returns the active configuration of the state machine, i.e. the
+    index of the active state of every region (including the regions of
+    submachines).
+
+    The returned object can be given to @ref restore(), possibly after having
+    been saved to and loaded from a file.
+    */
+    [[nodiscard]] snapshot_type snapshot() const
+    {
+        auto snap = snapshot_type{};
+        snap.layout_hash = layout_hash;
+
+        auto region_index = std::size_t{0};
+        auto save = [&snap, &region_index](const auto& region)
+        {
+            snap.active_state_indexes[region_index] = static_cast<state_index_type>(region.active_state_index());
+            ++region_index;
+        };
+        submachine_.for_each_region(save);
+
+        return snap;
+    }
+
+    /**
+    @brief Sets the active configuration of the state machine to the given
+    one, as returned by @ref snapshot().
+    @return `false` (leaving the state machine unchanged) if the snapshot
+    doesn't match the structure of the state machine or isn't a consistent
+    configuration, `true` otherwise
+
+    A configuration is consistent if every active state index is valid, and if
+    the regions of a submachine are running if and only if the submachine is
+    active.
+
+    No `on_exit()` or `on_entry()` function is called. The objects of lazily
+    constructed states (see @ref state_conf::lazy_construction) are destroyed
+    and constructed as needed.
+
+    This function must not be called while the state machine is processing an
+    event.
+    */
+    bool restore(const snapshot_type& snap)
+    {
+        if(snap.layout_hash != layout_hash)
+        {
+            return false;
+        }
+
+        //Check the whole configuration before modifying anything. Either all
+        //the regions of the machine are running, or none of them is.
+        using submachine_type = detail::submachine<Def, void>;
+        if
+        (
+            !submachine_type::is_valid_configuration(snap.active_state_indexes, true) &&
+            !submachine_type::is_valid_configuration(snap.active_state_indexes, false)
+        )
+        {
+            return false;
+        }
+
+        auto region_index = std::size_t{0};
+        auto load = [&snap, &region_index](auto& region)
+        {
+            region.restore_active_state_index(snap.active_state_indexes[region_index]);
+            ++region_index;
+        };
+        submachine_.for_each_region(load);
+
+        return true;
+    }
+
     /**
     @brief Starts the state machine
     @param event the event to be passed to the event hooks, mainly the
@@ -230,10 +496,7 @@ public:
     unless machine_conf::auto_start is set to `false`.
     */
     template<class Event = events::start>
-    void start(const Event& event = {})
-    {
-        execute_operation<detail::machine_operation::start>(event);
-    }
+    void start(const Event& event = {});
 
     /**
     @brief Stops the state machine
@@ -244,10 +507,7 @@ public:
     active state and enters @ref states::stopped.
     */
     template<class Event = events::stop>
-    void stop(const Event& event = {})
-    {
-        execute_operation<detail::machine_operation::stop>(event);
-    }
+    void stop(const Event& event = {});
 
     /**
     @brief Processes the given event
@@ -301,10 +561,18 @@ public:
     @endcode
     */
     template<class Event>
-    void process_event(const Event& event)
-    {
-        execute_operation<detail::machine_operation::process_event>(event);
-    }
+    void process_event(const Event& event);
+
+    /**
+    @brief Processes the given rvalue event
+    @param event the event to be processed
+
+    Same as the other overload, except that if the event has to be enqueued
+    (because of a recursive call), it is moved into the queue instead of being
+    copied.
+    */
+    template<class Event, std::enable_if_t<!std::is_reference_v<Event>, bool> = true>
+    void process_event(Event&& event);
 
     /**
     @brief Like process_event(), but doesn't check if an event is being
@@ -323,9 +591,144 @@ public:
     - faster to run, because an `if` statement is skipped.
     */
     template<class Event>
-    void process_event_now(const Event& event)
+    void process_event_now(const Event& event);
+
+    /**
+    @brief Processes the event of the given ID, as if it was given to @ref
+    process_event()
+    @param id the ID of the type of the event (see @ref event_id())
+    @param payload a pointer to the event, whose type must be
+    `tlu::get_t<event_type_list, id>`
+    @return `false` if `id` isn't a valid event type ID, in which case nothing
+    is done
+
+    This function is typically used to process events that are decoded at
+    runtime (e.g. messages received in a buffer), through a table of function
+    pointers instead of a hand-written `switch`. If the event type is trivially
+    copyable, `payload` can point directly into the buffer, provided it is
+    suitably aligned.
+    */
+    bool process_event_by_id(const std::size_t id, const void* const payload)
     {
-        execute_operation_now<detail::machine_operation::process_event>(event);
+        if constexpr(event_type_count == 0)
+        {
+            return false;
+        }
+        else
+        {
+            if(id >= event_type_count)
+            {
+                return false;
+            }
+
+            event_id_jump_table<event_type_list>::value[id](*this, payload); //NOLINT
+            return true;
+        }
+    }
+
+    /**
+    @brief Processes the active alternative of the given variant, as if it was
+    given to @ref process_event()
+    @param event the variant holding the event to be processed
+
+    Unlike `std::visit()`, this function jumps directly (through a table of
+    function pointers indexed by `event.index()`) to the processing of the
+    active alternative. Alternatives that can't have any effect on the state
+    machine (i.e. that can't trigger any transition, `on_event()` or
+    `on_unprocessed()` call) are ignored without even being instantiated.
+    */
+    template<class... Events>
+    void process_variant_event(const std::variant<Events...>& event)
+    {
+        with_event<process_event_visitor>(event);
+    }
+
+    /**
+    @brief Processes the events of the given range, in order
+    @param first the iterator to the first event to be processed
+    @param last the iterator past the last event to be processed
+
+    The result is the same as calling @ref process_event() for each event of
+    the range, but the run-to-completion bookkeeping is done once for the whole
+    range instead of once per event. Events that are enqueued during the
+    processing of an event of the range are processed before the next event of
+    the range.
+
+    The range can either contain events of a single type, or `std::variant`s of
+    event types, in which case the active alternative of each variant is
+    processed. Just like with @ref process_event(), events that can't have any
+    effect on the state machine are skipped without being dispatched.
+    */
+    template<class InputIt>
+    void process_events(InputIt first, const InputIt last)
+    {
+        using event_type = std::decay_t<decltype(*first)>;
+        if constexpr(!detail::is_variant_v<event_type> && !handles_event_v<event_type>)
+        {
+            //None of the events can have any effect
+            return;
+        }
+
+        if constexpr(conf.run_to_completion)
+        {
+            if(executing_operation_) //If call is recursive
+            {
+                try
+                {
+                    for(; first != last; ++first)
+                    {
+                        with_event<enqueue_event_visitor>(*first);
+                    }
+                }
+                catch(...)
+                {
+                    process_exception(std::current_exception());
+                }
+                return;
+            }
+        }
+
+        while(first != last)
+        {
+            try
+            {
+                if constexpr(conf.run_to_completion)
+                {
+                    auto grd = executing_operation_guard{*this};
+                    for(; first != last; ++first)
+                    {
+                        with_event<execute_one_operation_visitor>(*first);
+                        operation_queue_.invoke_and_pop_all(*this);
+                    }
+                }
+                else
+                {
+                    for(; first != last; ++first)
+                    {
+                        with_event<execute_one_operation_visitor>(*first);
+                    }
+                }
+            }
+            catch(...)
+            {
+                //Skip the event whose processing failed, then resume
+                ++first;
+                process_exception(std::current_exception());
+            }
+        }
+    }
+
+    /**
+    @brief Processes the events of the given range (e.g. an array, a
+    `std::vector` or a span), in order
+    @param events the range of events to be processed
+
+    Equivalent to `process_events(std::begin(events), std::end(events))`.
+    */
+    template<class EventRange>
+    void process_events(const EventRange& events)
+    {
+        process_events(std::begin(events), std::end(events));
     }
 
     /**
@@ -342,22 +745,93 @@ public:
     MAKI_NOINLINE void enqueue_event(const Event& event)
     {
         static_assert(conf.run_to_completion);
-        try
+        if constexpr(handles_event_v<Event>)
         {
-            enqueue_event_impl<detail::machine_operation::process_event>(event);
+            try
+            {
+                enqueue_event_impl<detail::machine_operation::process_event>(event);
+            }
+            catch(...)
+            {
+                process_exception(std::current_exception());
+            }
         }
-        catch(...)
+    }
+
+    /**
+    @brief Same as the other overload, except that the event is moved into the
+    queue instead of being copied.
+    @param event the event to be processed
+    */
+    template<class Event, std::enable_if_t<!std::is_reference_v<Event>, bool> = true>
+    MAKI_NOINLINE void enqueue_event(Event&& event)
+    {
+        static_assert(conf.run_to_completion);
+        if constexpr(handles_event_v<Event>)
         {
-            process_exception(std::current_exception());
+            try
+            {
+                enqueue_event_impl<detail::machine_operation::process_event>(std::move(event));
+            }
+            catch(...)
+            {
+                process_exception(std::current_exception());
+            }
         }
     }
 
+    /**
+    @brief Enqueues event for later processing by @ref
+    process_enqueued_events(). Unlike every other member function, this one can
+    be called from any thread.
+    @param event the event to be processed
+    @return `false` if the queue is full, in which case the event is dropped
+
+    This function requires machine_conf::post_event_queue_capacity to be set.
+
+    The event is copied into a bounded, lock-free queue. It's the
+    responsibility of the thread that owns the state machine to regularly call
+    @ref process_enqueued_events() to process the posted events.
+    */
+    template<class Event>
+    bool post_event(const Event& event)
+    {
+        static_assert
+        (
+            conf.post_event_queue_capacity != 0,
+            "post_event() requires machine_conf::post_event_queue_capacity to be set"
+        );
+        return posted_event_queue_.template push<posted_event_visitor>(event);
+    }
+
+    /**
+    @brief Same as the other overload, except that the event is moved into the
+    queue instead of being copied.
+    @param event the event to be processed
+    @return `false` if the queue is full, in which case the event is dropped
+    (and not moved from)
+    */
+    template<class Event, std::enable_if_t<!std::is_reference_v<Event>, bool> = true>
+    bool post_event(Event&& event)
+    {
+        static_assert
+        (
+            conf.post_event_queue_capacity != 0,
+            "post_event() requires machine_conf::post_event_queue_capacity to be set"
+        );
+        return posted_event_queue_.template push<posted_event_visitor>(std::move(event));
+    }
+
     /**
     @brief Processes events that have been enqueued by the run-to-completion
-    mechanism.
+    mechanism, then events that have been posted with @ref post_event().
+
+    Calling this function is relevant when managing an exception thrown by user
+    code and caught by the state machine, or when using @ref post_event().
 
-    Calling this function is only relevant when managing an exception thrown by
-    user code and caught by the state machine.
+    Only the events that have been posted before the call are processed. The
+    events that other threads (or the processing itself) post in the meantime
+    are left for the next call.
     */
     void process_enqueued_events()
     {
@@ -366,7 +840,15 @@ public:
             auto grd = executing_operation_guard{*this};
             try
             {
-                operation_queue_.invoke_and_pop_all(*this);
+                if constexpr(conf.run_to_completion)
+                {
+                    operation_queue_.invoke_and_pop_all(*this);
+                }
+
+                if constexpr(conf.post_event_queue_capacity != 0)
+                {
+                    posted_event_queue_.invoke_and_pop_all(*this);
+                }
             }
             catch(...)
             {
@@ -375,7 +857,44 @@ public:
         }
     }
 
+    /**
+    @brief Processes a `maki::events::timeout<State>` event for each active
+    state whose timeout (see @ref state_conf::set_timeout()) has expired,
+    according to machine_conf::clock.
+    @return the number of timeouts that have expired
+
+    It's the responsibility of the thread that owns the state machine to call
+    this function regularly. Does nothing if no state has a timeout.
+    */
+    std::size_t process_timeouts()
+    {
+        if constexpr(has_timed_state)
+        {
+            return this->timeout_scheduler.process();
+        }
+        else
+        {
+            return 0;
+        }
+    }
+
 private:
+    template<class>
+    friend class machine_pool;
+
+    using state_index_type = typename decltype(snapshot_type::active_state_indexes)::value_type;
+
+    static constexpr auto layout_hash = detail::type_hash_v
+    <
+        typename detail::submachine<Def, void>::layout_type
+    >;
+
+    template<class, int>
+    friend class detail::region;
+
+    template<class, class>
+    friend class detail::submachine;
+
     class executing_operation_guard
     {
     public:
@@ -402,11 +921,15 @@ private:
     struct real_operation_queue_holder
     {
         template<bool = true> //Dummy template for lazy evaluation
-        using type = detail::function_queue
+        using type = detail::function_queue<machine&>;
+    };
+    struct static_operation_queue_holder
+    {
+        template<bool = true> //Dummy template for lazy evaluation
+        using type = detail::static_function_queue
         <
             machine&,
-            conf.small_event_max_size,
-            conf.small_event_max_align
+            conf.run_to_completion_queue_size
         >;
     };
     struct empty_holder
@@ -417,12 +940,49 @@ private:
     using operation_queue_type = typename std::conditional_t
     <
         conf.run_to_completion,
-        real_operation_queue_holder,
+        std::conditional_t
+        <
+            conf.run_to_completion_queue_size == 0,
+            real_operation_queue_holder,
+            static_operation_queue_holder
+        >,
         empty_holder
     >::template type<>;
 
+    struct real_posted_event_queue_holder
+    {
+        template<bool = true> //Dummy template for lazy evaluation
+        using type = detail::mpsc_function_queue
+        <
+            machine&,
+            conf.post_event_queue_capacity,
+            conf.small_event_max_size,
+            conf.small_event_max_align
+        >;
+    };
+    using posted_event_queue_type = typename std::conditional_t
+    <
+        conf.post_event_queue_capacity != 0,
+        real_posted_event_queue_holder,
+        empty_holder
+    >::template type<>;
+
+    struct real_trace_buffer_holder
+    {
+        template<bool = true> //Dummy template for lazy evaluation
+        using type = detail::trace_buffer<conf.trace_capacity>;
+    };
+    using trace_buffer_type = typename std::conditional_t
+    <
+        conf.trace_capacity != 0,
+        real_trace_buffer_holder,
+        empty_holder
+    >::template type<>;
+
+    static constexpr auto has_timed_state = detail::def_has_timed_state_v<Def>;
+
     template<detail::machine_operation Operation, class Event>
-    void execute_operation(const Event& event)
+    void execute_operation(Event&& event)
     {
         try
         {
@@ -435,7 +995,7 @@ private:
                 else
                 {
                     //Enqueue event in case of recursive call
-                    enqueue_event_impl<Operation>(event);
+                    enqueue_event_impl<Operation>(std::forward<Event>(event));
                 }
             }
             else
@@ -467,10 +1027,22 @@ private:
         }
     }
 
+    //Note: event is moved into the queue if it's an rvalue
     template<detail::machine_operation Operation, class Event>
-    void enqueue_event_impl(const Event& event)
+    void enqueue_event_impl(Event&& event)
     {
-        operation_queue_.template push<any_event_visitor<Operation>>(event);
+        if constexpr(conf.run_to_completion_queue_size == 0)
+        {
+            operation_queue_.template push<any_event_visitor<Operation>>(std::forward<Event>(event));
+        }
+        else
+        {
+            //A failed push doesn't move from event
+            if(!operation_queue_.template push<any_event_visitor<Operation>>(std::forward<Event>(event)))
+            {
+                def().on_queue_overflow(event);
+            }
+        }
     }
 
     template<detail::machine_operation Operation>
@@ -483,6 +1055,138 @@ private:
         }
     };
 
+    //Call F::call(event, self), where event is either the given event or, if
+    //the given event is a std::variant, its active alternative. Events that
+    //can't have any effect are ignored.
+    template<class F, class Event>
+    void with_event(const Event& event)
+    {
+        if constexpr(detail::is_variant_v<Event>)
+        {
+            using jump_table_t = variant_jump_table
+            <
+                F,
+                Event,
+                std::make_index_sequence<std::variant_size_v<Event>>
+            >;
+
+            const auto index = event.index();
+            if(index != std::variant_npos)
+            {
+                jump_table_t::value[index](*this, event);
+            }
+        }
+        else if constexpr(handles_event_v<Event>)
+        {
+            F::call(event, *this);
+        }
+    }
+
+    /*
+    An array of pointers to functions that call F::call(alternative, self),
+    indexed by the index of the alternative of Variant.
+    Alternatives that can't have any effect are mapped to a function that does
+    nothing.
+    */
+    template<class F, class Variant, class IndexSequence>
+    struct variant_jump_table;
+
+    template<class F, class Variant, std::size_t... Indexes>
+    struct variant_jump_table<F, Variant, std::index_sequence<Indexes...>>
+    {
+        using fn_ptr_t = void(*)(machine&, const Variant&);
+
+        template<std::size_t Index>
+        static void call_alternative(machine& self, const Variant& event)
+        {
+            F::call(*std::get_if<Index>(&event), self);
+        }
+
+        static void ignore_alternative(machine& /*self*/, const Variant& /*event*/)
+        {
+        }
+
+        //Note: Unlike the conditional operator, this doesn't odr-use (and
+        //therefore instantiate) call_alternative<Index> for alternatives that
+        //are ignored.
+        template<std::size_t Index>
+        static constexpr fn_ptr_t alternative_fn_ptr()
+        {
+            if constexpr(handles_event_v<std::variant_alternative_t<Index, Variant>>)
+            {
+                return &call_alternative<Index>;
+            }
+            else
+            {
+                return &ignore_alternative;
+            }
+        }
+
+        static constexpr fn_ptr_t value[] = //NOLINT
+        {
+            alternative_fn_ptr<Indexes>()...
+        };
+    };
+
+    template<class EventTypeList>
+    struct event_id_jump_table;
+
+    template<class... Events>
+    struct event_id_jump_table<type_list<Events...>>
+    {
+        using fn_ptr_t = void(*)(machine&, const void*);
+
+        template<class Event>
+        static void process_event(machine& self, const void* const payload)
+        {
+            self.process_event(*static_cast<const Event*>(payload));
+        }
+
+        static constexpr fn_ptr_t value[] = {&process_event<Events>...}; //NOLINT
+    };
+
+    struct process_event_visitor
+    {
+        template<class Event>
+        static void call(const Event& event, machine& self)
+        {
+            self.process_event(event);
+        }
+    };
+
+    struct execute_one_operation_visitor
+    {
+        template<class Event>
+        static void call(const Event& event, machine& self)
+        {
+            self.execute_one_operation<detail::machine_operation::process_event>(event);
+        }
+    };
+
+    struct enqueue_event_visitor
+    {
+        template<class Event>
+        static void call(const Event& event, machine& self)
+        {
+            self.enqueue_event_impl<detail::machine_operation::process_event>(event);
+        }
+    };
+
+    //Process posted event as if it was given to process_event()
+    struct posted_event_visitor
+    {
+        template<class Event>
+        static void call(const Event& event, machine& self)
+        {
+            self.execute_one_operation<detail::machine_operation::process_event>(event);
+
+            if constexpr(conf.run_to_completion)
+            {
+                self.operation_queue_.invoke_and_pop_all(self);
+            }
+        }
+    };
+
     void process_exception(const std::exception_ptr& eptr)
     {
         if constexpr(conf.has_on_exception)
@@ -502,6 +1206,10 @@ private:
         {
             submachine_.on_entry(event);
         }
+        else if constexpr(Operation == detail::machine_operation::warm_start)
+        {
+            submachine_.call_on_entry_of_active_states(event);
+        }
         else if constexpr(Operation == detail::machine_operation::stop)
         {
             submachine_.on_exit(event);
@@ -524,11 +1232,70 @@ private:
         }
     }
 
+    //Used by the root submachine in compact layout mode
+    static machine& from_submachine(detail::submachine<Def, void>& sm)
+    {
+        MAKI_DETAIL_OFFSET_OF(offset, machine, submachine_)
+        return detail::container_of<machine>(sm, offset);
+    }
+
     detail::submachine<Def, void> submachine_;
     bool executing_operation_ = false;
     operation_queue_type operation_queue_;
+    posted_event_queue_type posted_event_queue_;
+    trace_buffer_type trace_buffer_;
 };
 
+/*
+The entry points below are defined outside of the class so that they aren't
+implicitly inline. This is what makes explicit instantiation declarations (see
+MAKI_DECLARE_MACHINE) actually suppress their implicit instantiation.
+*/
+
+template<class Def>
+template<class Event>
+void machine<Def>::start(const Event& event)
+{
+    execute_operation<detail::machine_operation::start>(event);
+}
+
+template<class Def>
+template<class Event>
+void machine<Def>::stop(const Event& event)
+{
+    execute_operation<detail::machine_operation::stop>(event);
+}
+
+template<class Def>
+template<class Event>
+void machine<Def>::process_event(const Event& event)
+{
+    if constexpr(handles_event_v<Event>)
+    {
+        execute_operation<detail::machine_operation::process_event>(event);
+    }
+}
+
+template<class Def>
+template<class Event, std::enable_if_t<!std::is_reference_v<Event>, bool>>
+void machine<Def>::process_event(Event&& event)
+{
+    if constexpr(handles_event_v<Event>)
+    {
+        execute_operation<detail::machine_operation::process_event>(std::move(event));
+    }
+}
+
+template<class Def>
+template<class Event>
+void machine<Def>::process_event_now(const Event& event)
+{
+    if constexpr(handles_event_v<Event>)
+    {
+        execute_operation_now<detail::machine_operation::process_event>(event);
+    }
+}
+
 } //namespace
 
 #endif
@@ -17,10 +17,23 @@
 #include "type_list.hpp"
 #include "type.hpp"
 #include "detail/tlu.hpp"
+#include <chrono>
+#include <cstdint>
 
 namespace maki
 {
 
+namespace detail
+{
+    inline std::int64_t steady_clock_ns()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>
+        (
+            std::chrono::steady_clock::now().time_since_epoch()
+        ).count();
+    }
+}
+
 /**
 @brief @ref machine configuration
 */
@@ -28,7 +41,9 @@ template
 <
     class ContextTypeHolder = type<void>,
     class OnEventTypeList = type_list<>,
-    class TransitionTableTypeList = type_list<>
+    class TransitionTableTypeList = type_list<>,
+    class ClockTypeHolder = type<std::chrono::steady_clock>,
+    class TimeoutResolutionTypeHolder = type<std::chrono::milliseconds>
 >
 struct machine_conf
 {
@@ -39,6 +54,39 @@ struct machine_conf
     */
     bool auto_start = true; //NOLINT(misc-non-private-member-variables-in-classes)
 
+    /**
+    @brief Specifies the clock used by the state timeouts (see @ref
+    state_conf::set_timeout()).
+
+    The type must provide, like the clocks of `std::chrono`:
+    - a `time_point` member type;
+    - a `now()` static member function, returning a `time_point`.
+
+    A clock that returns a virtual time makes timeouts testable
+    deterministically.
+    */
+    ClockTypeHolder clock; //NOLINT(misc-non-private-member-variables-in-classes)
+
+    /**
+    @brief Specifies whether the regions and submachines of @ref machine must
+    find the root machine and the context from their own address.
+
+    By default, every region stores a reference to the root machine and to its
+    context, and every submachine stores a reference to the root machine (and
+    to the context of its parent if it doesn't have its own context), for
+    faster access.
+
+    When this option is enabled, these references aren't stored. Since the
+    layout of a machine is known at compile-time, each region and submachine
+    finds the objects it needs by subtracting constant offsets from its own
+    address. This saves two pointers per region and up to two pointers per
+    submachine, at the cost of a few address computations (which compilers
+    usually fold into a single one).
+
+    Use @ref layout_report to check the effect of this option.
+    */
+    bool compact_layout = false; //NOLINT(misc-non-private-member-variables-in-classes)
+
     /**
     @brief Specifies the context type.
     */
@@ -324,6 +372,42 @@ struct machine_conf
     */
     bool has_on_exit = false; //NOLINT(misc-non-private-member-variables-in-classes)
 
+    /**
+    @brief Specifies whether @ref machine must call a user-provided
+    `on_queue_overflow()` member function whenever an event can't be pushed
+    into the run-to-completion queue because the queue is full.
+
+    This option is required whenever @ref run_to_completion_queue_size is set.
+
+    The following expression must be valid, for every possible event type:
+    @code
+    machine_def.on_queue_overflow(event);
+    @endcode
+
+    The event that is given to `on_queue_overflow()` is dropped.
+
+    Example:
+    @code
+    struct machine_def
+    {
+        static constexpr auto conf = default_machine_conf
+            .set_run_to_completion_queue_size(256)
+            .enable_on_queue_overflow()
+            //...
+        ;
+
+        template<class Event>
+        void on_queue_overflow(const Event& event)
+        {
+            //...
+        }
+
+        //...
+    };
+    @endcode
+    */
+    bool has_on_queue_overflow = false; //NOLINT(misc-non-private-member-variables-in-classes)
+
     /**
     @brief Specifies whether @ref machine must call a user-provided
     `on_unprocessed()` member function whenever a call to @ref
@@ -397,6 +481,38 @@ struct machine_conf
     */
     bool has_pretty_name = false; //NOLINT(misc-non-private-member-variables-in-classes)
 
+    /**
+    @brief Specifies whether the regions of @ref machine must dispatch events
+    through jump tables.
+
+    By default, whenever a region processes an event, it iterates over all the
+    transitions whose event type pattern matches the event type, checking for
+    each of them whether its source state is the active state.
+
+    When this option is enabled, the region instead builds, for each event type,
+    a `constexpr` table of function pointers indexed by the active state. Each
+    function of the table only checks the guards and executes the transitions
+    whose source state pattern matches the corresponding state. Finding the
+    candidate transitions then costs a single indirect call, whatever the size
+    of the transition table.
+
+    This is typically beneficial for regions that contain many states, at the
+    cost of a slightly bigger binary.
+    */
+    bool jump_table_dispatch = false; //NOLINT(misc-non-private-member-variables-in-classes)
+
+    /**
+    @brief Capacity of the lock-free queue used by @ref machine::post_event().
+
+    A value of 0 (the default) disables @ref machine::post_event(). Any other
+    value must be a power of two.
+
+    This queue stores the events whose size and alignment requirement are less
+    than or equal to @ref small_event_max_size and @ref small_event_max_align
+    without any extra memory allocation.
+    */
+    std::size_t post_event_queue_capacity = 0; //NOLINT(misc-non-private-member-variables-in-classes)
+
     /**
     @brief Specifies whether run-to-completion is enabled.
 
@@ -409,18 +525,75 @@ struct machine_conf
     bool run_to_completion = true; //NOLINT(misc-non-private-member-variables-in-classes)
 
     /**
-    @brief Maximum object alignment requirement for the run-to-completion event
-    queue to enable small object optimization (and thus avoid an extra memory
+    @brief Size, in bytes, of the statically allocated run-to-completion queue.
+
+    By default (value 0), the run-to-completion queue grows on demand, which
+    requires heap allocations whenever it's not big enough to store the events
+    that are being enqueued.
+
+    Any other value makes @ref machine store its run-to-completion queue inside
+    itself, in a buffer of the given size, so that the event path never
+    allocates. Each enqueued event takes a header of a few pointers, plus its
+    own size and alignment padding. Whenever an event doesn't fit into the
+    remaining room, it's given to `on_queue_overflow()` (see @ref
+    has_on_queue_overflow) instead.
+    */
+    std::size_t run_to_completion_queue_size = 0; //NOLINT(misc-non-private-member-variables-in-classes)
+
+    /**
+    @brief Maximum object alignment requirement for the posted event queue to
+    enable small object optimization (and thus avoid an extra memory
     allocation).
+
+    The run-to-completion event queue doesn't need this, as it stores every
+    event at its exact size and alignment.
     */
     std::size_t small_event_max_align = 8; //NOLINT(misc-non-private-member-variables-in-classes, cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers)
 
     /**
-    @brief Maximum object size for the run-to-completion event queue to enable
-    small object optimization (and thus avoid an extra memory allocation).
+    @brief Maximum object size for the posted event queue to enable small
+    object optimization (and thus avoid an extra memory allocation).
+
+    The run-to-completion event queue doesn't need this, as it stores every
+    event at its exact size and alignment.
     */
     std::size_t small_event_max_size = 16; //NOLINT(misc-non-private-member-variables-in-classes, cppcoreguidelines-avoid-magic-numbers,readability-magic-numbers)
 
+    /**
+    @brief Specifies the resolution of the state timeouts (see @ref
+    state_conf::set_timeout()), as a `std::chrono::duration` type.
+
+    Expiry times are rounded up to a multiple of this duration (counted from
+    the construction of the machine), so that timeouts never expire early.
+    */
+    TimeoutResolutionTypeHolder timeout_resolution; //NOLINT(misc-non-private-member-variables-in-classes)
+
+    /**
+    @brief Capacity, in records, of the transition trace buffer.
+
+    By default (value 0), no trace is recorded.
+
+    Any other value, which must be a power of two, makes @ref machine record a
+    compact @ref trace_record for each state transition of each region (see
+    @ref machine::trace_records()). Once the buffer is full, the oldest records
+    are overwritten.
+
+    Use @ref trace_decoder to get the names of the states and events of a
+    record.
+    */
+    std::size_t trace_capacity = 0; //NOLINT(misc-non-private-member-variables-in-classes)
+
+    /**
+    @brief The function that gives the timestamps of the @ref trace_record
+    objects.
+
+    By default, timestamps are given by `std::chrono::steady_clock`, in
+    nanoseconds. Reading a clock can be the most expensive part of recording a
+    transition. A cheaper time source (e.g. a CPU cycle counter) or a sequence
+    counter can be given instead.
+    */
+    std::int64_t(*trace_clock)() = &detail::steady_clock_ns; //NOLINT(misc-non-private-member-variables-in-classes)
+
     /**
     @brief The list of transition table types. One region per transmission table
     is created.
@@ -429,6 +602,8 @@ struct machine_conf
 
 #define MAKI_DETAIL_MAKE_MACHINE_CONF_COPY_BEGIN /*NOLINT(cppcoreguidelines-macro-usage)*/ \
     [[maybe_unused]] const auto MAKI_DETAIL_ARG_auto_start = auto_start; \
+    [[maybe_unused]] const auto MAKI_DETAIL_ARG_clock = clock; \
+    [[maybe_unused]] const auto MAKI_DETAIL_ARG_compact_layout = compact_layout; \
     [[maybe_unused]] const auto MAKI_DETAIL_ARG_context = context; \
     [[maybe_unused]] const auto MAKI_DETAIL_ARG_has_after_state_transition = has_after_state_transition; \
     [[maybe_unused]] const auto MAKI_DETAIL_ARG_has_before_state_transition = has_before_state_transition; \
@@ -437,11 +612,18 @@ struct machine_conf
     [[maybe_unused]] const auto MAKI_DETAIL_ARG_has_on_event_for = has_on_event_for; \
     [[maybe_unused]] const auto MAKI_DETAIL_ARG_has_on_exception = has_on_exception; \
     [[maybe_unused]] const auto MAKI_DETAIL_ARG_has_on_exit = has_on_exit; \
+    [[maybe_unused]] const auto MAKI_DETAIL_ARG_has_on_queue_overflow = has_on_queue_overflow; \
     [[maybe_unused]] const auto MAKI_DETAIL_ARG_has_on_unprocessed = has_on_unprocessed; \
     [[maybe_unused]] const auto MAKI_DETAIL_ARG_has_pretty_name = has_pretty_name; \
+    [[maybe_unused]] const auto MAKI_DETAIL_ARG_jump_table_dispatch = jump_table_dispatch; \
+    [[maybe_unused]] const auto MAKI_DETAIL_ARG_post_event_queue_capacity = post_event_queue_capacity; \
     [[maybe_unused]] const auto MAKI_DETAIL_ARG_run_to_completion = run_to_completion; \
+    [[maybe_unused]] const auto MAKI_DETAIL_ARG_run_to_completion_queue_size = run_to_completion_queue_size; \
     [[maybe_unused]] const auto MAKI_DETAIL_ARG_small_event_max_align = small_event_max_align; \
     [[maybe_unused]] const auto MAKI_DETAIL_ARG_small_event_max_size = small_event_max_size; \
+    [[maybe_unused]] const auto MAKI_DETAIL_ARG_timeout_resolution = timeout_resolution; \
+    [[maybe_unused]] const auto MAKI_DETAIL_ARG_trace_capacity = trace_capacity; \
+    [[maybe_unused]] const auto MAKI_DETAIL_ARG_trace_clock = trace_clock; \
     [[maybe_unused]] const auto MAKI_DETAIL_ARG_transition_tables = transition_tables;
 
 #define MAKI_DETAIL_MAKE_MACHINE_CONF_COPY_END /*NOLINT(cppcoreguidelines-macro-usage)*/ \
@@ -449,10 +631,14 @@ struct machine_conf
     < \
         std::decay_t<decltype(MAKI_DETAIL_ARG_context)>, \
         std::decay_t<decltype(MAKI_DETAIL_ARG_has_on_event_for)>, \
-        std::decay_t<decltype(MAKI_DETAIL_ARG_transition_tables)> \
+        std::decay_t<decltype(MAKI_DETAIL_ARG_transition_tables)>, \
+        std::decay_t<decltype(MAKI_DETAIL_ARG_clock)>, \
+        std::decay_t<decltype(MAKI_DETAIL_ARG_timeout_resolution)> \
     > \
     { \
         MAKI_DETAIL_ARG_auto_start, \
+        MAKI_DETAIL_ARG_clock, \
+        MAKI_DETAIL_ARG_compact_layout, \
         MAKI_DETAIL_ARG_context, \
         MAKI_DETAIL_ARG_has_after_state_transition, \
         MAKI_DETAIL_ARG_has_before_state_transition, \
@@ -461,11 +647,18 @@ struct machine_conf
         MAKI_DETAIL_ARG_has_on_event_for, \
         MAKI_DETAIL_ARG_has_on_exception, \
         MAKI_DETAIL_ARG_has_on_exit, \
+        MAKI_DETAIL_ARG_has_on_queue_overflow, \
         MAKI_DETAIL_ARG_has_on_unprocessed, \
         MAKI_DETAIL_ARG_has_pretty_name, \
+        MAKI_DETAIL_ARG_jump_table_dispatch, \
+        MAKI_DETAIL_ARG_post_event_queue_capacity, \
         MAKI_DETAIL_ARG_run_to_completion, \
+        MAKI_DETAIL_ARG_run_to_completion_queue_size, \
         MAKI_DETAIL_ARG_small_event_max_align, \
         MAKI_DETAIL_ARG_small_event_max_size, \
+        MAKI_DETAIL_ARG_timeout_resolution, \
+        MAKI_DETAIL_ARG_trace_capacity, \
+        MAKI_DETAIL_ARG_trace_clock, \
         MAKI_DETAIL_ARG_transition_tables \
     };
 
@@ -485,6 +678,23 @@ struct machine_conf
 #undef MAKI_DETAIL_ARG_auto_start
     }
 
+    template<class Clock>
+    [[nodiscard]] constexpr auto set_clock() const
+    {
+        MAKI_DETAIL_MAKE_MACHINE_CONF_COPY_BEGIN
+#define MAKI_DETAIL_ARG_clock type_c<Clock>
+        MAKI_DETAIL_MAKE_MACHINE_CONF_COPY_END
+#undef MAKI_DETAIL_ARG_clock
+    }
+
+    [[nodiscard]] constexpr auto enable_compact_layout() const
+    {
+        MAKI_DETAIL_MAKE_MACHINE_CONF_COPY_BEGIN
+#define MAKI_DETAIL_ARG_compact_layout true
+        MAKI_DETAIL_MAKE_MACHINE_CONF_COPY_END
+#undef MAKI_DETAIL_ARG_compact_layout
+    }
+
     [[nodiscard]] constexpr auto enable_before_state_transition() const
     {
         MAKI_DETAIL_MAKE_MACHINE_CONF_COPY_BEGIN
@@ -502,6 +712,14 @@ struct machine_conf
 #undef MAKI_DETAIL_ARG_context
     }
 
+    [[nodiscard]] constexpr auto enable_jump_table_dispatch() const
+    {
+        MAKI_DETAIL_MAKE_MACHINE_CONF_COPY_BEGIN
+#define MAKI_DETAIL_ARG_jump_table_dispatch true
+        MAKI_DETAIL_MAKE_MACHINE_CONF_COPY_END
+#undef MAKI_DETAIL_ARG_jump_table_dispatch
+    }
+
     [[nodiscard]] constexpr auto disable_run_to_completion() const
     {
         MAKI_DETAIL_MAKE_MACHINE_CONF_COPY_BEGIN
@@ -534,6 +752,30 @@ struct machine_conf
 #undef MAKI_DETAIL_ARG_has_on_unprocessed
     }
 
+    [[nodiscard]] constexpr auto enable_on_queue_overflow() const
+    {
+        MAKI_DETAIL_MAKE_MACHINE_CONF_COPY_BEGIN
+#define MAKI_DETAIL_ARG_has_on_queue_overflow true
+        MAKI_DETAIL_MAKE_MACHINE_CONF_COPY_END
+#undef MAKI_DETAIL_ARG_has_on_queue_overflow
+    }
+
+    [[nodiscard]] constexpr auto set_post_event_queue_capacity(const std::size_t value) const
+    {
+        MAKI_DETAIL_MAKE_MACHINE_CONF_COPY_BEGIN
+#define MAKI_DETAIL_ARG_post_event_queue_capacity value
+        MAKI_DETAIL_MAKE_MACHINE_CONF_COPY_END
+#undef MAKI_DETAIL_ARG_post_event_queue_capacity
+    }
+
+    [[nodiscard]] constexpr auto set_run_to_completion_queue_size(const std::size_t value) const
+    {
+        MAKI_DETAIL_MAKE_MACHINE_CONF_COPY_BEGIN
+#define MAKI_DETAIL_ARG_run_to_completion_queue_size value
+        MAKI_DETAIL_MAKE_MACHINE_CONF_COPY_END
+#undef MAKI_DETAIL_ARG_run_to_completion_queue_size
+    }
+
     [[nodiscard]] constexpr auto set_small_event_max_align(const std::size_t value) const
     {
         MAKI_DETAIL_MAKE_MACHINE_CONF_COPY_BEGIN
@@ -550,6 +792,31 @@ struct machine_conf
 #undef MAKI_DETAIL_ARG_small_event_max_size
     }
 
+    template<class Duration>
+    [[nodiscard]] constexpr auto set_timeout_resolution() const
+    {
+        MAKI_DETAIL_MAKE_MACHINE_CONF_COPY_BEGIN
+#define MAKI_DETAIL_ARG_timeout_resolution type_c<Duration>
+        MAKI_DETAIL_MAKE_MACHINE_CONF_COPY_END
+#undef MAKI_DETAIL_ARG_timeout_resolution
+    }
+
+    [[nodiscard]] constexpr auto set_trace_capacity(const std::size_t value) const
+    {
+        MAKI_DETAIL_MAKE_MACHINE_CONF_COPY_BEGIN
+#define MAKI_DETAIL_ARG_trace_capacity value
+        MAKI_DETAIL_MAKE_MACHINE_CONF_COPY_END
+#undef MAKI_DETAIL_ARG_trace_capacity
+    }
+
+    [[nodiscard]] constexpr auto set_trace_clock(std::int64_t(* const value)()) const
+    {
+        MAKI_DETAIL_MAKE_MACHINE_CONF_COPY_BEGIN
+#define MAKI_DETAIL_ARG_trace_clock value
+        MAKI_DETAIL_MAKE_MACHINE_CONF_COPY_END
+#undef MAKI_DETAIL_ARG_trace_clock
+    }
+
     template<class... Ts>
     [[nodiscard]] constexpr auto enable_on_event_for() const
     {
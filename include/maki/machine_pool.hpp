@@ -0,0 +1,486 @@
+//Copyright Florian Goujeon 2021 - 2023.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+/**
+@file
+@brief Defines the maki::machine_pool class template
+*/
+
+#ifndef MAKI_MACHINE_POOL_HPP
+#define MAKI_MACHINE_POOL_HPP
+
+#include "machine.hpp"
+#include "events.hpp"
+#include "detail/integer.hpp"
+#include <array>
+#include <vector>
+#include <optional>
+#include <limits>
+#include <utility>
+#include <type_traits>
+#include <cstdint>
+#include <cstddef>
+
+namespace maki
+{
+
+/**
+@brief A compact storage for a large number of state machine instances of the
+same definition.
+@tparam Def the state machine definition, just like the one given to @ref
+machine
+
+A `machine_pool<Def>` behaves like a `std::vector<machine<Def>>`, except that it
+only stores, for each instance:
+- the context;
+- the index of the active state of each region (including the regions of
+submachines), as a small unsigned integer.
+
+These data are stored as a structure of arrays: one array of contexts, and
+either:
+- if they fit in 64 bits, one array of words into which the active state indexes
+of all the regions of an instance are bit-packed;
+- otherwise, one array of active state indexes per region.
+
+Events are processed by a single @ref machine object (called the cursor), into
+which the active state indexes of the target instance are loaded beforehand and
+from which they are stored back afterwards. The context of the target instance
+is swapped into the cursor and stays there until another instance is targeted,
+so that consecutive operations on the same instance don't move it. As a
+consequence:
+- the context type must be movable and swappable;
+- the definition object and the states are shared by all the instances, so they
+must not hold any per-instance data: they must be either empty or made of a
+single reference (typically to the context or to the machine), which is checked
+at compile time;
+- submachines can't have their own context;
+- states can't be lazily constructed (see @ref state_conf::lazy_construction),
+as the lazy state objects would be shared as well;
+- the member functions of the pool must not be called from within the
+processing of an event (use the `machine` object given to actions instead).
+*/
+template<class Def>
+class machine_pool
+{
+public:
+    /**
+    @brief The type of the state machine that processes the events.
+    */
+    using machine_type = machine<Def>;
+
+    /**
+    @brief The state machine context type.
+    */
+    using context_type = typename machine_type::context_type;
+
+    machine_pool() = default;
+    machine_pool(const machine_pool&) = delete;
+    machine_pool(machine_pool&&) = delete;
+    machine_pool& operator=(const machine_pool&) = delete;
+    machine_pool& operator=(machine_pool&&) = delete;
+    ~machine_pool() = default;
+
+    /**
+    @brief Creates a new instance and returns its index.
+    @param ctx_args the arguments to be passed to the context constructor
+
+    Unless the @ref machine_conf::auto_start is `false`, the new instance is
+    started.
+    */
+    template<class... ContextArgs>
+    std::size_t emplace(ContextArgs&&... ctx_args)
+    {
+        const auto index = size();
+
+        if(!cursor_)
+        {
+            //The cursor is constructed (and started) as the first instance
+            cursor_.emplace(std::forward<ContextArgs>(ctx_args)...);
+            contexts_.push_back(std::move(cursor_->context()));
+            push_back_state_indexes();
+            store_active_state_indexes(index);
+        }
+        else
+        {
+            contexts_.push_back(context_type{std::forward<ContextArgs>(ctx_args)...});
+            push_back_state_indexes();
+            store_stopped_state_indexes(index);
+
+            if constexpr(machine_type::conf.auto_start)
+            {
+                start(index);
+            }
+        }
+
+        return index;
+    }
+
+    /**
+    @brief Returns the number of instances.
+    */
+    [[nodiscard]] std::size_t size() const
+    {
+        return contexts_.size();
+    }
+
+    /**
+    @brief Reserves storage for the given number of instances.
+    */
+    void reserve(const std::size_t capacity)
+    {
+        contexts_.reserve(capacity);
+        if constexpr(packs_state_indexes)
+        {
+            state_indexes_.reserve(capacity);
+        }
+        else
+        {
+            for(auto& indexes: state_indexes_)
+            {
+                indexes.reserve(capacity);
+            }
+        }
+    }
+
+    /**
+    @brief Returns the context of the given instance.
+    */
+    context_type& context(const std::size_t index)
+    {
+        return index == loaded_index_ ? cursor_->context() : contexts_[index];
+    }
+
+    /**
+    @brief Returns the context of the given instance.
+    */
+    const context_type& context(const std::size_t index) const
+    {
+        return index == loaded_index_ ? cursor_->context() : contexts_[index];
+    }
+
+    /**
+    @brief Starts the given instance (see @ref machine::start()).
+    */
+    template<class Event = events::start>
+    void start(const std::size_t index, const Event& event = {})
+    {
+        with_instance
+        (
+            index,
+            [&event](machine_type& mach)
+            {
+                mach.start(event);
+            }
+        );
+    }
+
+    /**
+    @brief Stops the given instance (see @ref machine::stop()).
+    */
+    template<class Event = events::stop>
+    void stop(const std::size_t index, const Event& event = {})
+    {
+        with_instance
+        (
+            index,
+            [&event](machine_type& mach)
+            {
+                mach.stop(event);
+            }
+        );
+    }
+
+    /**
+    @brief Processes the given event in the given instance (see @ref
+    machine::process_event()).
+    */
+    template<class Event>
+    void process_event(const std::size_t index, const Event& event)
+    {
+        with_instance
+        (
+            index,
+            [&event](machine_type& mach)
+            {
+                mach.process_event(event);
+            }
+        );
+    }
+
+    /**
+    @brief Returns whether `State` is active in the region indicated by
+    `RegionPath`, in the given instance.
+    */
+    template<const auto& RegionPath, class State>
+    [[nodiscard]] bool is_active_state(const std::size_t index) const
+    {
+        load_active_state_indexes(index);
+        return cursor_->template is_active_state<RegionPath, State>();
+    }
+
+    /**
+    @brief Returns whether `State` is active in the single region of the state
+    machine, in the given instance.
+    */
+    template<class State>
+    [[nodiscard]] bool is_active_state(const std::size_t index) const
+    {
+        load_active_state_indexes(index);
+        return cursor_->template is_active_state<State>();
+    }
+
+    /**
+    @brief Returns whether the single region of the given instance is running.
+    */
+    [[nodiscard]] bool is_running(const std::size_t index) const
+    {
+        load_active_state_indexes(index);
+        return cursor_->is_running();
+    }
+
+private:
+    using submachine_type = detail::submachine<Def, void>;
+
+    static_assert
+    (
+        !submachine_type::flat_has_submachine_context,
+        "machine_pool doesn't support submachines that have their own context"
+    );
+
+    static_assert
+    (
+        !submachine_type::flat_has_timed_state,
+        "machine_pool doesn't support state timeouts"
+    );
+
+    static_assert
+    (
+        !submachine_type::flat_has_lazy_state,
+        "machine_pool doesn't support lazily constructed states"
+    );
+
+    static_assert
+    (
+        !submachine_type::flat_has_stateful_state && !detail::state_traits::is_stateful_v<Def>,
+        "machine_pool requires states and definitions that are either empty or made of a single reference (to the context or to the machine), as they are shared by all the instances"
+    );
+
+    static_assert
+    (
+        std::is_move_constructible_v<context_type> &&
+        std::is_move_assignable_v<context_type>,
+        "machine_pool requires a movable context type"
+    );
+
+    static constexpr auto region_count = submachine_type::flat_region_count;
+
+    static constexpr auto state_index_bit_count = submachine_type::flat_state_index_bit_count;
+
+    //Whether the active state indexes of an instance fit in a single word
+    static constexpr auto packs_state_indexes = state_index_bit_count <= 64;
+
+    using packed_state_indexes_type = detail::smallest_unsigned_of_width_t<state_index_bit_count>;
+
+    //Smallest type that can store the index of any state (including stopped)
+    using active_state_index_type = detail::smallest_unsigned_t
+    <
+        static_cast<std::uint64_t>(submachine_type::flat_max_state_count)
+    >;
+
+    using state_index_storage_type = std::conditional_t
+    <
+        packs_state_indexes,
+        std::vector<packed_state_indexes_type>,
+        std::array<std::vector<active_state_index_type>, region_count>
+    >;
+
+    //Value of loaded_index_ when the cursor doesn't hold the context of any
+    //instance
+    static constexpr auto no_instance = std::numeric_limits<std::size_t>::max();
+
+    //Loads the given instance into the cursor and stores its active state
+    //indexes back, even if an exception is thrown
+    class instance_guard
+    {
+    public:
+        instance_guard(machine_pool& self, const std::size_t index):
+            self_(self),
+            index_(index)
+        {
+            self_.load_context(index_);
+            self_.load_active_state_indexes(index_);
+        }
+
+        instance_guard(const instance_guard&) = delete;
+        instance_guard(instance_guard&&) = delete;
+        instance_guard& operator=(const instance_guard&) = delete;
+        instance_guard& operator=(instance_guard&&) = delete;
+
+        ~instance_guard()
+        {
+            self_.store_active_state_indexes(index_);
+        }
+
+    private:
+        machine_pool& self_; //NOLINT(cppcoreguidelines-avoid-const-or-ref-data-members)
+        std::size_t index_;
+    };
+
+    template<class F>
+    void with_instance(const std::size_t index, const F& fun)
+    {
+        auto grd = instance_guard{*this, index};
+        fun(*cursor_);
+    }
+
+    /*
+    Swaps the context of the given instance into the cursor, after having
+    swapped the context of the previously loaded instance (if any) back into
+    the pool. Does nothing if the instance is already loaded.
+
+    The element of contexts_ at loaded_index_ holds the spare context object
+    that the cursor holds when no instance is loaded.
+    */
+    void load_context(const std::size_t index)
+    {
+        if(index == loaded_index_)
+        {
+            return;
+        }
+
+        using std::swap;
+        if(loaded_index_ != no_instance)
+        {
+            swap(cursor_->context(), contexts_[loaded_index_]);
+        }
+        swap(cursor_->context(), contexts_[index]);
+        loaded_index_ = index;
+    }
+
+    /*
+    Calls fun(active_state_index, stopped_state_index, region_index, bit_offset)
+    for each region of the cursor, where bit_offset is the position of the
+    active state index in the packed word.
+    */
+    template<class F>
+    void for_each_cursor_region(const F& fun) const
+    {
+        auto region_index = std::size_t{0};
+        auto bit_offset = 0;
+        auto fun_2 = [&](auto& active_state_index, const auto stopped_state_index)
+        {
+            fun(active_state_index, stopped_state_index, region_index, bit_offset);
+            ++region_index;
+            bit_offset += detail::bit_width(stopped_state_index);
+        };
+        cursor_->submachine_.for_each_active_state_index(fun_2);
+    }
+
+    void push_back_state_indexes()
+    {
+        if constexpr(packs_state_indexes)
+        {
+            state_indexes_.emplace_back();
+        }
+        else
+        {
+            for(auto& indexes: state_indexes_)
+            {
+                indexes.emplace_back();
+            }
+        }
+    }
+
+    void load_active_state_indexes(const std::size_t index) const
+    {
+        for_each_cursor_region
+        (
+            [this, index](auto& active_state_index, const auto stopped_state_index, const std::size_t region_index, const int bit_offset)
+            {
+                using index_t = std::decay_t<decltype(active_state_index)>;
+
+                if constexpr(packs_state_indexes)
+                {
+                    const auto mask = (std::uint64_t{1} << detail::bit_width(stopped_state_index)) - 1;
+                    const auto word = std::uint64_t{state_indexes_[index]};
+                    active_state_index = static_cast<index_t>((word >> bit_offset) & mask);
+                }
+                else
+                {
+                    active_state_index = static_cast<index_t>(state_indexes_[region_index][index]); //NOLINT(cppcoreguidelines-pro-bounds-constant-array-index)
+                }
+            }
+        );
+    }
+
+    void store_active_state_indexes(const std::size_t index)
+    {
+        store_state_indexes
+        (
+            index,
+            [](const auto active_state_index, const auto /*stopped_state_index*/)
+            {
+                return active_state_index;
+            }
+        );
+    }
+
+    void store_stopped_state_indexes(const std::size_t index)
+    {
+        store_state_indexes
+        (
+            index,
+            [](const auto /*active_state_index*/, const auto stopped_state_index)
+            {
+                return stopped_state_index;
+            }
+        );
+    }
+
+    template<class F>
+    void store_state_indexes(const std::size_t index, const F& get_state_index)
+    {
+        if constexpr(packs_state_indexes)
+        {
+            auto word = std::uint64_t{0};
+            for_each_cursor_region
+            (
+                [&word, &get_state_index](const auto& active_state_index, const auto stopped_state_index, const std::size_t /*region_index*/, const int bit_offset)
+                {
+                    word |= std::uint64_t{get_state_index(active_state_index, stopped_state_index)} << bit_offset;
+                }
+            );
+            state_indexes_[index] = static_cast<packed_state_indexes_type>(word);
+        }
+        else
+        {
+            for_each_cursor_region
+            (
+                [this, index, &get_state_index](const auto& active_state_index, const auto stopped_state_index, const std::size_t region_index, const int /*bit_offset*/)
+                {
+                    state_indexes_[region_index][index] = static_cast<active_state_index_type> //NOLINT(cppcoreguidelines-pro-bounds-constant-array-index)
+                    (
+                        get_state_index(active_state_index, stopped_state_index)
+                    );
+                }
+            );
+        }
+    }
+
+    //Mutable because loading the data of an instance into the cursor doesn't
+    //change the observable state of the pool
+    mutable std::optional<machine_type> cursor_;
+
+    std::vector<context_type> contexts_;
+    state_index_storage_type state_indexes_;
+
+    //Index of the instance whose context is in the cursor
+    std::size_t loaded_index_ = no_instance;
+};
+
+} //namespace
+
+#endif
@@ -0,0 +1,59 @@
+//Copyright Florian Goujeon 2021 - 2023.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+/**
+@file
+@brief Defines the maki::machine_snapshot struct template
+*/
+
+#ifndef MAKI_MACHINE_SNAPSHOT_HPP
+#define MAKI_MACHINE_SNAPSHOT_HPP
+
+#include <array>
+#include <cstdint>
+#include <cstddef>
+
+namespace maki
+{
+
+/**
+@brief The active configuration of a @ref machine, as returned by @ref
+machine::snapshot() and given to @ref machine::restore().
+@tparam RegionCount the number of regions of the machine, including the regions
+of its submachines (recursively)
+@tparam StateIndex the unsigned integer type of the active state indexes
+
+Don't instantiate this template directly. Use @ref machine::snapshot_type
+instead.
+
+This is a trivially copyable, standard-layout type of fixed size, so that it
+can be written to and read from a file (or a memory-mapped region) as is.
+*/
+template<std::size_t RegionCount, class StateIndex>
+struct machine_snapshot
+{
+    /**
+    @brief A hash of the structure of the machine (its regions and their
+    states).
+
+    It depends on the names of the state types, as given by the compiler. A
+    snapshot can therefore only be restored by a program built with the same
+    compiler.
+    */
+    std::uint64_t layout_hash;
+
+    /**
+    @brief The index of the active state of each region (including the regions
+    of submachines, depth-first).
+
+    The index of a stopped region is equal to its number of states.
+    */
+    std::array<StateIndex, RegionCount> active_state_indexes;
+};
+
+} //namespace
+
+#endif
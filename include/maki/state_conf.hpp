@@ -15,6 +15,7 @@
 #include "type_list.hpp"
 #include "type.hpp"
 #include "detail/tlu.hpp"
+#include <chrono>
 
 namespace maki
 {
@@ -36,13 +37,17 @@ struct state_conf
     OnEventTypeList has_on_event_for; //NOLINT(misc-non-private-member-variables-in-classes)
     bool has_on_exit = false; //NOLINT(misc-non-private-member-variables-in-classes)
     bool has_pretty_name = false; //NOLINT(misc-non-private-member-variables-in-classes)
+    bool lazy_construction = false; //NOLINT(misc-non-private-member-variables-in-classes)
+    std::chrono::nanoseconds timeout = std::chrono::nanoseconds::zero(); //NOLINT(misc-non-private-member-variables-in-classes)
 
 #define MAKI_DETAIL_MAKE_STATE_CONF_COPY_BEGIN /*NOLINT(cppcoreguidelines-macro-usage)*/ \
     [[maybe_unused]] const auto MAKI_DETAIL_ARG_has_on_entry = has_on_entry; \
     [[maybe_unused]] const auto MAKI_DETAIL_ARG_has_on_event_auto = has_on_event_auto; \
     [[maybe_unused]] const auto MAKI_DETAIL_ARG_has_on_event_for = has_on_event_for; \
     [[maybe_unused]] const auto MAKI_DETAIL_ARG_has_on_exit = has_on_exit; \
-    [[maybe_unused]] const auto MAKI_DETAIL_ARG_has_pretty_name = has_pretty_name;
+    [[maybe_unused]] const auto MAKI_DETAIL_ARG_has_pretty_name = has_pretty_name; \
+    [[maybe_unused]] const auto MAKI_DETAIL_ARG_lazy_construction = lazy_construction; \
+    [[maybe_unused]] const auto MAKI_DETAIL_ARG_timeout = timeout;
 
 #define MAKI_DETAIL_MAKE_STATE_CONF_COPY_END /*NOLINT(cppcoreguidelines-macro-usage)*/ \
     return state_conf \
@@ -54,7 +59,9 @@ struct state_conf
         MAKI_DETAIL_ARG_has_on_event_auto, \
         MAKI_DETAIL_ARG_has_on_event_for, \
         MAKI_DETAIL_ARG_has_on_exit, \
-        MAKI_DETAIL_ARG_has_pretty_name \
+        MAKI_DETAIL_ARG_has_pretty_name, \
+        MAKI_DETAIL_ARG_lazy_construction, \
+        MAKI_DETAIL_ARG_timeout \
     };
 
     [[nodiscard]] constexpr auto enable_on_entry() const
@@ -107,6 +114,41 @@ struct state_conf
 #undef MAKI_DETAIL_ARG_has_pretty_name
     }
 
+    /*
+    Instead of living as long as the region, the state object is constructed
+    whenever the state is entered and destroyed whenever it is exited. It
+    shares its storage with the other lazily constructed states of its region.
+    Accessing it (e.g. through machine::state()) is only valid while the state
+    is active.
+    */
+    [[nodiscard]] constexpr auto enable_lazy_construction() const
+    {
+        MAKI_DETAIL_MAKE_STATE_CONF_COPY_BEGIN
+#define MAKI_DETAIL_ARG_lazy_construction true
+        MAKI_DETAIL_MAKE_STATE_CONF_COPY_END
+#undef MAKI_DETAIL_ARG_lazy_construction
+    }
+
+    /*
+    Makes the machine process a maki::events::timeout<State> event whenever
+    the state has been active for the given duration (rounded up to
+    machine_conf::timeout_resolution) without being exited.
+
+    The timer is armed right before on_entry() and disarmed right before
+    on_exit(). It is driven by machine::process_timeouts(), according to
+    machine_conf::clock.
+    */
+    template<class Duration, typename Duration::rep Count>
+    [[nodiscard]] constexpr auto set_timeout() const
+    {
+        static_assert(Count > 0);
+
+        MAKI_DETAIL_MAKE_STATE_CONF_COPY_BEGIN
+#define MAKI_DETAIL_ARG_timeout std::chrono::nanoseconds{Duration{Count}}
+        MAKI_DETAIL_MAKE_STATE_CONF_COPY_END
+#undef MAKI_DETAIL_ARG_timeout
+    }
+
 #undef MAKI_DETAIL_MAKE_STATE_CONF_COPY_END
 #undef MAKI_DETAIL_MAKE_STATE_CONF_COPY_BEGIN
 };
@@ -0,0 +1,402 @@
+//Copyright Florian Goujeon 2021 - 2023.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+/**
+@file
+@brief Defines the maki::timer_service class template
+*/
+
+#ifndef MAKI_TIMER_SERVICE_HPP
+#define MAKI_TIMER_SERVICE_HPP
+
+#include "timer_service_conf.hpp"
+#include "detail/timing_wheel.hpp"
+#include "detail/container_of.hpp"
+#include <chrono>
+#include <new>
+#include <utility>
+#include <type_traits>
+#include <cstdint>
+#include <cstddef>
+
+namespace maki
+{
+
+/**
+@brief A handle to an event scheduled by a @ref timer_service.
+
+A default-constructed handle (or the handle returned by a failed call to @ref
+timer_service::schedule_event()) is null. A handle is never reused: once its
+timer has expired or has been cancelled, the handle just refers to nothing.
+*/
+class timer_handle
+{
+public:
+    timer_handle() = default;
+
+    /**
+    @brief Returns whether the handle is null.
+    */
+    [[nodiscard]] bool is_null() const
+    {
+        return index_ == null_index;
+    }
+
+private:
+    template<class Def>
+    friend class timer_service;
+
+    static constexpr auto null_index = UINT32_MAX;
+
+    timer_handle(const std::uint32_t index, const std::uint32_t generation):
+        index_(index),
+        generation_(generation)
+    {
+    }
+
+    std::uint32_t index_ = null_index;
+    std::uint32_t generation_ = 0;
+};
+
+/**
+@brief A service that processes events into state machines after a given
+delay.
+@tparam Def the timer service definition, which must have a `conf` static
+variable of type @ref timer_service_conf
+
+The timers are stored into a hierarchical timing wheel, so that scheduling and
+cancelling an event are O(1) operations, whatever the number of pending timers.
+
+The timer service doesn't create any thread. The user is responsible for
+calling @ref poll() regularly, from the thread that processes the events of the
+state machines.
+
+Example:
+@code
+struct timer_service_def
+{
+    static constexpr auto conf = maki::default_timer_service_conf;
+};
+
+struct context
+{
+    maki::timer_service<timer_service_def>& timers;
+    maki::timer_handle watchdog;
+};
+
+constexpr auto start_watchdog = [](auto& mach, context& ctx)
+{
+    ctx.watchdog = ctx.timers.schedule_event(mach, std::chrono::seconds{5}, watchdog_timeout{});
+};
+
+constexpr auto stop_watchdog = [](context& ctx)
+{
+    ctx.timers.cancel(ctx.watchdog);
+};
+@endcode
+*/
+template<class Def>
+class timer_service
+{
+public:
+    static constexpr const auto& conf = Def::conf;
+
+    /**
+    @brief The clock type, as given by @ref timer_service_conf::clock.
+    */
+    using clock_type = typename std::decay_t<decltype(conf.clock)>::type;
+
+    /**
+    @brief The timer resolution, as given by @ref timer_service_conf::tick.
+    */
+    using tick_type = typename std::decay_t<decltype(conf.tick)>::type;
+
+    /**
+    @brief Constructor.
+    @param clock the clock object that gives the current time
+    */
+    explicit timer_service(const clock_type& clock = clock_type{}):
+        clock_(clock),
+        epoch_(clock_.now())
+    {
+        for(auto i = std::size_t{0}; i < capacity; ++i)
+        {
+            timers_[i].pservice = this; //NOLINT(cppcoreguidelines-pro-bounds-constant-array-index)
+            timers_[i].pnext_free = i + 1 < capacity ? &timers_[i + 1] : nullptr; //NOLINT(cppcoreguidelines-pro-bounds-constant-array-index)
+        }
+        pfirst_free_timer_ = &timers_[0];
+    }
+
+    timer_service(const timer_service&) = delete;
+    timer_service(timer_service&&) = delete;
+    timer_service& operator=(const timer_service&) = delete;
+    timer_service& operator=(timer_service&&) = delete;
+
+    ~timer_service()
+    {
+        for(auto& tmr: timers_)
+        {
+            if(tmr.node.is_armed())
+            {
+                wheel_.disarm(tmr.node);
+                tmr.pdestroy_event(tmr);
+            }
+        }
+    }
+
+    /**
+    @brief Schedules the processing of the given event by the given state
+    machine, once the given delay has elapsed.
+    @param mach the state machine (typically, a @ref machine, whose
+    `process_event()` member function is called)
+    @param delay the delay; the event is processed by the first call to @ref
+    poll() made once the delay has elapsed, rounded up to the next tick (see
+    @ref timer_service_conf::tick), and therefore never before the delay has
+    elapsed
+    @param event the event, which is copied or moved into the timer
+    @return a handle to the timer, or a null handle if all the timers are
+    already pending
+
+    The state machine must outlive the timer.
+    */
+    template<class Machine, class Rep, class Period, class Event>
+    timer_handle schedule_event
+    (
+        Machine& mach,
+        const std::chrono::duration<Rep, Period>& delay,
+        Event&& event
+    )
+    {
+        using event_type = std::decay_t<Event>;
+
+        if(pfirst_free_timer_ == nullptr)
+        {
+            return timer_handle{};
+        }
+
+        auto& tmr = *pfirst_free_timer_;
+
+        //Store the event before changing anything, in case its constructor
+        //throws
+        if constexpr(is_small_event<event_type>())
+        {
+            tmr.pevent = new(tmr.event_storage) event_type{std::forward<Event>(event)};
+            tmr.pdestroy_event = &destroy_small_event<event_type>;
+        }
+        else
+        {
+            tmr.pevent = new event_type{std::forward<Event>(event)}; //NOLINT(cppcoreguidelines-owning-memory)
+            tmr.pdestroy_event = &destroy_large_event<event_type>;
+        }
+
+        pfirst_free_timer_ = tmr.pnext_free;
+        tmr.pnext_free = nullptr;
+        tmr.pmachine = &mach;
+        tmr.node.pfire = &fire<Machine, event_type>;
+
+        //Compute the expiry from the exact current time (rather than from the
+        //current tick, which is rounded down), so that the event is never
+        //processed before the delay has elapsed
+        const auto expiry_tick = std::chrono::ceil<tick_type>(clock_.now() - epoch_ + delay).count();
+        wheel_.arm
+        (
+            tmr.node,
+            expiry_tick > 0 ? static_cast<std::uint64_t>(expiry_tick) : 0
+        );
+
+        return timer_handle{index_of(tmr), tmr.generation};
+    }
+
+    /**
+    @brief Cancels the given timer, in O(1).
+    @return true if the timer was pending, false otherwise (null handle,
+    expired or already cancelled timer)
+    */
+    bool cancel(const timer_handle& handle)
+    {
+        const auto ptmr = pending_timer_of(handle);
+        if(ptmr == nullptr)
+        {
+            return false;
+        }
+
+        wheel_.disarm(ptmr->node);
+        ptmr->pdestroy_event(*ptmr);
+        release(*ptmr);
+        return true;
+    }
+
+    /**
+    @brief Returns whether the timer of the given handle is pending.
+    */
+    [[nodiscard]] bool is_pending(const timer_handle& handle) const
+    {
+        return pending_timer_of(handle) != nullptr;
+    }
+
+    /**
+    @brief Returns the number of pending timers.
+    */
+    [[nodiscard]] std::size_t pending_count() const
+    {
+        return wheel_.armed_count();
+    }
+
+    /**
+    @brief Makes the state machines process the events whose delay has
+    elapsed, in expiry order.
+    @return the number of processed events
+
+    Events can be scheduled and cancelled from within the processing of an
+    event.
+    */
+    std::size_t poll()
+    {
+        return wheel_.advance_to(now_tick());
+    }
+
+    /**
+    @brief Returns the clock object given to the constructor.
+    */
+    clock_type& clock()
+    {
+        return clock_;
+    }
+
+    /**
+    @brief Returns the clock object given to the constructor.
+    */
+    const clock_type& clock() const
+    {
+        return clock_;
+    }
+
+private:
+    static constexpr auto capacity = conf.capacity;
+    static constexpr auto small_event_max_size = conf.small_event_max_size;
+
+    static_assert(capacity > 0 && capacity < timer_handle::null_index);
+
+    struct timer
+    {
+        detail::timing_wheel_node node;
+        timer_service* pservice = nullptr;
+        std::uint32_t generation = 0;
+        timer* pnext_free = nullptr;
+        void* pmachine = nullptr;
+        void* pevent = nullptr;
+        void(*pdestroy_event)(timer&) = nullptr;
+        alignas(std::max_align_t) unsigned char event_storage[small_event_max_size]; //NOLINT(cppcoreguidelines-avoid-c-arrays)
+    };
+
+    template<class Event>
+    static constexpr bool is_small_event()
+    {
+        return
+            sizeof(Event) <= small_event_max_size &&
+            alignof(Event) <= alignof(std::max_align_t) &&
+            std::is_nothrow_move_constructible_v<Event>
+        ;
+    }
+
+    template<class Event>
+    static void destroy_small_event(timer& tmr)
+    {
+        static_cast<Event*>(tmr.pevent)->~Event();
+    }
+
+    template<class Event>
+    static void destroy_large_event(timer& tmr)
+    {
+        delete static_cast<Event*>(tmr.pevent); //NOLINT(cppcoreguidelines-owning-memory)
+    }
+
+    //Called by the timing wheel, with the node already disarmed
+    template<class Machine, class Event>
+    static void fire(detail::timing_wheel_node& node)
+    {
+        MAKI_DETAIL_OFFSET_OF(node_offset, timer, node);
+        auto& tmr = detail::container_of<timer>(node, node_offset);
+
+        //Release the timer even if process_event() throws
+        struct releaser
+        {
+            explicit releaser(timer& t):
+                tmr(t)
+            {
+            }
+
+            releaser(const releaser&) = delete;
+            releaser(releaser&&) = delete;
+            releaser& operator=(const releaser&) = delete;
+            releaser& operator=(releaser&&) = delete;
+
+            ~releaser()
+            {
+                tmr.pdestroy_event(tmr);
+                tmr.pservice->release(tmr);
+            }
+
+            timer& tmr;
+        };
+        const auto rel = releaser{tmr};
+
+        static_cast<Machine*>(tmr.pmachine)->process_event(std::move(*static_cast<Event*>(tmr.pevent)));
+    }
+
+    void release(timer& tmr)
+    {
+        //Invalidate the handles of the timer
+        ++tmr.generation;
+
+        tmr.pevent = nullptr;
+        tmr.pmachine = nullptr;
+        tmr.pnext_free = pfirst_free_timer_;
+        pfirst_free_timer_ = &tmr;
+    }
+
+    std::uint32_t index_of(const timer& tmr) const
+    {
+        return static_cast<std::uint32_t>(&tmr - &timers_[0]);
+    }
+
+    timer* pending_timer_of(const timer_handle& handle)
+    {
+        return const_cast<timer*>(std::as_const(*this).pending_timer_of(handle)); //NOLINT(cppcoreguidelines-pro-type-const-cast)
+    }
+
+    const timer* pending_timer_of(const timer_handle& handle) const
+    {
+        if(handle.index_ >= capacity)
+        {
+            return nullptr;
+        }
+
+        const auto& tmr = timers_[handle.index_]; //NOLINT(cppcoreguidelines-pro-bounds-constant-array-index)
+        if(tmr.generation != handle.generation_ || !tmr.node.is_armed())
+        {
+            return nullptr;
+        }
+
+        return &tmr;
+    }
+
+    std::uint64_t now_tick() const
+    {
+        const auto elapsed = std::chrono::duration_cast<tick_type>(clock_.now() - epoch_).count();
+        return elapsed > 0 ? static_cast<std::uint64_t>(elapsed) : 0;
+    }
+
+    clock_type clock_;
+    typename clock_type::time_point epoch_;
+    detail::timing_wheel<> wheel_;
+    timer timers_[capacity]; //NOLINT(cppcoreguidelines-avoid-c-arrays)
+    timer* pfirst_free_timer_ = nullptr;
+};
+
+} //namespace
+
+#endif
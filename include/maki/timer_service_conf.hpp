@@ -0,0 +1,121 @@
+//Copyright Florian Goujeon 2021 - 2023.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+/**
+@file
+@brief Defines the maki::timer_service_conf struct template
+*/
+
+#ifndef MAKI_TIMER_SERVICE_CONF_HPP
+#define MAKI_TIMER_SERVICE_CONF_HPP
+
+#include "type.hpp"
+#include <chrono>
+#include <cstddef>
+
+namespace maki
+{
+
+/**
+@brief The configuration for @ref timer_service
+*/
+template
+<
+    class ClockTypeHolder = type<std::chrono::steady_clock>,
+    class TickTypeHolder = type<std::chrono::milliseconds>
+>
+struct timer_service_conf
+{
+    /**
+    @brief Specifies the maximum number of pending timers.
+
+    The timers are preallocated, so that scheduling an event never allocates
+    memory (as long as the event fits into the small event storage).
+    */
+    std::size_t capacity = 64; //NOLINT(misc-non-private-member-variables-in-classes)
+
+    /**
+    @brief Specifies the type of the clock that gives the current time.
+
+    The type must provide:
+    - a `duration` member type;
+    - a `time_point` member type;
+    - a `now()` member function (which can be static), returning a
+    `time_point`.
+
+    The @ref timer_service object holds an instance of this type, so that
+    tests can use a clock that returns a virtual time.
+    */
+    ClockTypeHolder clock; //NOLINT(misc-non-private-member-variables-in-classes)
+
+    /**
+    @brief Specifies the maximum size, in bytes, of an event that can be stored
+    without dynamic memory allocation.
+    */
+    std::size_t small_event_max_size = 32; //NOLINT(misc-non-private-member-variables-in-classes)
+
+    /**
+    @brief Specifies the resolution of the timers, as a `std::chrono::duration`
+    type.
+
+    Expiry times are rounded up to a multiple of this duration (counted from
+    the construction of the timer service), so that events are never processed
+    before their delay has elapsed.
+    */
+    TickTypeHolder tick; //NOLINT(misc-non-private-member-variables-in-classes)
+
+    [[nodiscard]] constexpr auto set_capacity(const std::size_t value) const
+    {
+        return timer_service_conf<ClockTypeHolder, TickTypeHolder>
+        {
+            value,
+            clock,
+            small_event_max_size,
+            tick
+        };
+    }
+
+    template<class Clock>
+    [[nodiscard]] constexpr auto set_clock() const
+    {
+        return timer_service_conf<type<Clock>, TickTypeHolder>
+        {
+            capacity,
+            type_c<Clock>,
+            small_event_max_size,
+            tick
+        };
+    }
+
+    [[nodiscard]] constexpr auto set_small_event_max_size(const std::size_t value) const
+    {
+        return timer_service_conf<ClockTypeHolder, TickTypeHolder>
+        {
+            capacity,
+            clock,
+            value,
+            tick
+        };
+    }
+
+    template<class Duration>
+    [[nodiscard]] constexpr auto set_tick() const
+    {
+        return timer_service_conf<ClockTypeHolder, type<Duration>>
+        {
+            capacity,
+            clock,
+            small_event_max_size,
+            type_c<Duration>
+        };
+    }
+};
+
+inline constexpr auto default_timer_service_conf = timer_service_conf<>{};
+
+} //namespace
+
+#endif
@@ -0,0 +1,135 @@
+//Copyright Florian Goujeon 2021 - 2023.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+/**
+@file
+@brief Defines the maki::trace_decoder class template
+*/
+
+#ifndef MAKI_TRACE_DECODER_HPP
+#define MAKI_TRACE_DECODER_HPP
+
+#include "trace_record.hpp"
+#include "pretty_name.hpp"
+#include "states.hpp"
+#include "detail/submachine.hpp"
+#include "detail/type_name.hpp"
+#include "detail/tlu.hpp"
+#include <string>
+#include <cstddef>
+
+namespace maki
+{
+
+/**
+@brief Maps the IDs of the @ref trace_record objects recorded by a @ref machine
+back to names.
+@tparam Machine the @ref machine type that recorded the trace
+
+States are named by @ref pretty_name(). Events are named by their type name.
+*/
+template<class Machine>
+class trace_decoder
+{
+public:
+    /**
+    @brief Returns the name of the state of the given ID, in the region of the
+    given index, or an empty string if there's no such state.
+    */
+    static std::string state_name(const std::size_t region_index, const std::size_t state_id)
+    {
+        if(state_id == trace_record::stopped_state_id)
+        {
+            return std::string{pretty_name<states::stopped>()};
+        }
+        return submachine_type::flat_state_pretty_name(region_index, state_id);
+    }
+
+    /**
+    @brief Returns the name of the event type of the given ID, or an empty
+    string if there's no such event type.
+    */
+    static std::string event_name(std::size_t event_id)
+    {
+        auto name = std::string{};
+        detail::tlu::for_each_or<typename Machine::event_type_list, event_name_at>(event_id, name);
+        return name;
+    }
+
+    /**
+    @brief Returns the name of the source state of the given record.
+    */
+    static std::string source_state_name(const trace_record& rec)
+    {
+        return state_name(rec.region_index, rec.source_state_id);
+    }
+
+    /**
+    @brief Returns the name of the target state of the given record.
+    */
+    static std::string target_state_name(const trace_record& rec)
+    {
+        return state_name(rec.region_index, rec.target_state_id);
+    }
+
+    /**
+    @brief Returns the name of the event type of the given record.
+    */
+    static std::string event_name(const trace_record& rec)
+    {
+        return event_name(rec.event_id);
+    }
+
+    /**
+    @brief Returns a human-readable description of the given record, such as
+    `"[123456789] region 0: off -> on (button_press)"`.
+    */
+    static std::string to_string(const trace_record& rec)
+    {
+        auto str = std::string{};
+        str += '[';
+        str += std::to_string(rec.timestamp);
+        str += "] region ";
+        str += std::to_string(rec.region_index);
+        str += ": ";
+        str += source_state_name(rec);
+        str += " -> ";
+        str += target_state_name(rec);
+        str += " (";
+        if(rec.event_id == trace_record::unlisted_event_id)
+        {
+            str += "unlisted event";
+        }
+        else
+        {
+            str += event_name(rec);
+        }
+        str += ')';
+        return str;
+    }
+
+private:
+    using submachine_type = detail::submachine<typename Machine::def_type, void>;
+
+    struct event_name_at
+    {
+        template<class Event>
+        static bool call(std::size_t& event_id, std::string& name)
+        {
+            if(event_id == 0)
+            {
+                name = std::string{detail::decayed_type_name<Event>()};
+                return true;
+            }
+            --event_id;
+            return false;
+        }
+    };
+};
+
+} //namespace
+
+#endif
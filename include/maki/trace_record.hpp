@@ -0,0 +1,72 @@
+//Copyright Florian Goujeon 2021 - 2023.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+/**
+@file
+@brief Defines the maki::trace_record struct
+*/
+
+#ifndef MAKI_TRACE_RECORD_HPP
+#define MAKI_TRACE_RECORD_HPP
+
+#include <cstdint>
+
+namespace maki
+{
+
+/**
+@brief A compact record of a state transition, as recorded by @ref machine when
+@ref machine_conf::trace_capacity is set.
+
+IDs are indexes that only make sense for the machine that recorded them. Use
+@ref trace_decoder to get the names they stand for.
+*/
+struct trace_record
+{
+    /**
+    @brief The ID given to @ref states::stopped.
+    */
+    static constexpr auto stopped_state_id = std::uint16_t{0xFFFF};
+
+    /**
+    @brief The ID given to the events that aren't listed in @ref
+    machine::event_type_list.
+    */
+    static constexpr auto unlisted_event_id = std::uint16_t{0xFFFF};
+
+    /**
+    @brief The time of the transition, as given by @ref
+    machine_conf::trace_clock (by default, in nanoseconds since the epoch of
+    `std::chrono::steady_clock`).
+    */
+    std::int64_t timestamp = 0;
+
+    /**
+    @brief The index of the region, in the depth-first list of all the regions
+    of the machine and of its submachines.
+    */
+    std::uint16_t region_index = 0;
+
+    /**
+    @brief The index of the source state in the state list of the region.
+    */
+    std::uint16_t source_state_id = 0;
+
+    /**
+    @brief The index of the target state in the state list of the region.
+    */
+    std::uint16_t target_state_id = 0;
+
+    /**
+    @brief The ID of the type of the event that caused the transition (see @ref
+    machine::event_id()).
+    */
+    std::uint16_t event_id = 0;
+};
+
+} //namespace
+
+#endif
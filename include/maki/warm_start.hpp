@@ -0,0 +1,48 @@
+//Copyright Florian Goujeon 2021 - 2023.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+/**
+@file
+@brief Defines the maki::warm_start and maki::warm_start_with_on_entry tags
+*/
+
+#ifndef MAKI_WARM_START_HPP
+#define MAKI_WARM_START_HPP
+
+namespace maki
+{
+
+/**
+@brief The type of @ref warm_start and @ref warm_start_with_on_entry.
+@tparam CallOnEntry whether the `on_entry()` functions of the active states are
+called
+*/
+template<bool CallOnEntry>
+struct warm_start_t
+{
+    /**
+    @brief Whether the `on_entry()` functions of the active states are called.
+    */
+    static constexpr auto call_on_entry = CallOnEntry;
+};
+
+/**
+@brief A tag to be given to the warm-start constructor of @ref machine, so that
+the machine is directly constructed in the configuration of a given snapshot,
+without calling any `on_entry()` function.
+*/
+inline constexpr auto warm_start = warm_start_t<false>{};
+
+/**
+@brief Like @ref warm_start, except that the `on_entry()` functions of the
+state machine definition and of the active states are called (with a @ref
+events::start event), from the outermost to the innermost.
+*/
+inline constexpr auto warm_start_with_on_entry = warm_start_t<true>{};
+
+} //namespace
+
+#endif
@@ -0,0 +1,148 @@
+//Copyright Florian Goujeon 2021 - 2023.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+#include <maki.hpp>
+#include "common.hpp"
+#include <array>
+#include <new>
+#include <cstdlib>
+
+namespace
+{
+    //Note: This executable is single-threaded.
+    auto allocation_count = 0; //NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
+}
+
+//Count every allocation of the whole program, which is why this test has its
+//own executable
+void* operator new(std::size_t size)
+{
+    ++allocation_count;
+    if(auto ptr = std::malloc(size == 0 ? 1 : size)) //NOLINT
+    {
+        return ptr;
+    }
+    throw std::bad_alloc{};
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr); //NOLINT
+}
+
+void operator delete(void* ptr, std::size_t /*size*/) noexcept
+{
+    std::free(ptr); //NOLINT
+}
+
+namespace
+{
+    struct context
+    {
+        int tick_count = 0;
+        long long tick_sum = 0;
+        int overflow_count = 0;
+    };
+
+    namespace events
+    {
+        struct burst
+        {
+            int tick_count = 0;
+        };
+
+        struct tick
+        {
+            int value = 0;
+            std::array<char, 40> payload = {};
+        };
+    }
+
+    namespace states
+    {
+        EMPTY_STATE(on);
+    }
+
+    namespace actions
+    {
+        constexpr auto burst = [](auto& machine, context& /*ctx*/, const events::burst& event)
+        {
+            for(auto i = 0; i < event.tick_count; ++i)
+            {
+                machine.process_event(events::tick{i});
+            }
+        };
+
+        void tick(context& ctx, const events::tick& event)
+        {
+            ++ctx.tick_count;
+            ctx.tick_sum += event.value;
+        }
+    }
+
+    constexpr auto transition_table = maki::empty_transition_table
+        .add_c<states::on, events::burst, maki::null, actions::burst>
+        .add_c<states::on, events::tick,  maki::null, actions::tick>
+    ;
+
+    struct machine_def
+    {
+        static constexpr auto conf = maki::default_machine_conf
+            .set_transition_tables(transition_table)
+            .set_context<context>()
+            .set_run_to_completion_queue_size(512)
+            .enable_on_queue_overflow()
+        ;
+
+        template<class Event>
+        void on_queue_overflow(const Event& /*event*/)
+        {
+            ++ctx.overflow_count;
+        }
+
+        context& ctx;
+    };
+
+    using machine_t = maki::machine<machine_def>;
+}
+
+TEST_CASE("static_run_to_completion_queue")
+{
+    auto machine = machine_t{};
+    auto& ctx = machine.context();
+
+    SECTION("no allocation")
+    {
+        allocation_count = 0;
+        for(auto i = 0; i < 100; ++i)
+        {
+            machine.process_event(events::burst{5});
+        }
+        const auto burst_allocation_count = allocation_count;
+
+        REQUIRE(burst_allocation_count == 0);
+        REQUIRE(ctx.tick_count == 500);
+        REQUIRE(ctx.tick_sum == 1000);
+        REQUIRE(ctx.overflow_count == 0);
+    }
+
+    SECTION("overflow")
+    {
+        allocation_count = 0;
+        machine.process_event(events::burst{100});
+        const auto burst_allocation_count = allocation_count;
+
+        REQUIRE(burst_allocation_count == 0);
+        REQUIRE(ctx.overflow_count != 0);
+        REQUIRE(ctx.tick_count + ctx.overflow_count == 100);
+
+        //Queue is usable again once drained
+        ctx = context{};
+        machine.process_event(events::burst{5});
+        REQUIRE(ctx.tick_count == 5);
+        REQUIRE(ctx.overflow_count == 0);
+    }
+}
@@ -0,0 +1,214 @@
+//Copyright Florian Goujeon 2021 - 2023.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+#include <maki.hpp>
+#include "common.hpp"
+#include <string>
+
+namespace
+{
+    struct context
+    {
+        std::string out;
+    };
+
+    namespace events
+    {
+        struct power_button_press{};
+        struct color_button_press{};
+        struct beep_button_press{};
+    }
+
+    namespace states
+    {
+        EMPTY_STATE(off);
+        EMPTY_STATE(silent);
+        EMPTY_STATE(beeping);
+
+        namespace on_ns
+        {
+            //Own context of the on submachine
+            struct context
+            {
+                context(::context& parent):
+                    parent(parent)
+                {
+                }
+
+                ::context& parent;
+                int color_count = 0;
+            };
+
+            struct emitting_red
+            {
+                static constexpr auto conf = maki::default_state_conf
+                    .enable_on_entry()
+                ;
+
+                void on_entry()
+                {
+                    ctx.parent.out += "red;";
+                }
+
+                context& ctx;
+            };
+
+            EMPTY_STATE(emitting_green);
+
+            //Submachine without its own context
+            namespace emitting_blue_ns
+            {
+                struct dark
+                {
+                    static constexpr auto conf = maki::default_state_conf
+                        .enable_on_entry()
+                    ;
+
+                    template<class Machine>
+                    void on_entry(Machine& mach, const events::color_button_press& /*event*/)
+                    {
+                        mach.context().out += "dark;";
+                        ++ctx.color_count;
+                    }
+
+                    context& ctx;
+                };
+
+                EMPTY_STATE(bright);
+
+                constexpr auto transition_table = maki::empty_transition_table
+                    .add_c<dark, events::beep_button_press, bright>
+                ;
+            }
+
+            struct emitting_blue
+            {
+                static constexpr auto conf = maki::default_submachine_conf
+                    .set_transition_tables(emitting_blue_ns::transition_table)
+                ;
+            };
+
+            inline void count_color(context& ctx)
+            {
+                ++ctx.color_count;
+            }
+
+            constexpr auto transition_table = maki::empty_transition_table
+                .add_c<emitting_red,   events::color_button_press, emitting_green, count_color>
+                .add_c<emitting_green, events::color_button_press, emitting_blue,  count_color>
+                .add_c<emitting_blue,  events::color_button_press, emitting_red,   count_color>
+            ;
+        }
+
+        struct on
+        {
+            static constexpr auto conf = maki::default_submachine_conf
+                .set_transition_tables(on_ns::transition_table)
+                .set_context<on_ns::context>()
+            ;
+        };
+    }
+
+    constexpr auto log_power = [](auto& mach, context& ctx, const auto& /*event*/)
+    {
+        //Make sure we get the right machine
+        if(&mach.context() == &ctx)
+        {
+            ctx.out += "power;";
+        }
+    };
+
+    constexpr auto power_transition_table = maki::empty_transition_table
+        .add_c<states::off, events::power_button_press, states::on,  log_power>
+        .add_c<states::on,  events::power_button_press, states::off, log_power>
+    ;
+
+    constexpr auto beep_transition_table = maki::empty_transition_table
+        .add_c<states::silent,  events::beep_button_press, states::beeping>
+        .add_c<states::beeping, events::beep_button_press, states::silent>
+    ;
+
+    constexpr auto regular_conf = maki::default_machine_conf
+        .set_transition_tables(power_transition_table, beep_transition_table)
+        .set_context<context>()
+    ;
+
+    struct regular_machine_def
+    {
+        static constexpr auto conf = regular_conf;
+    };
+
+    struct compact_machine_def
+    {
+        static constexpr auto conf = regular_conf
+            .enable_compact_layout()
+        ;
+    };
+
+    using compact_report = maki::layout_report<maki::machine<compact_machine_def>>;
+    using regular_report = maki::layout_report<maki::machine<regular_machine_def>>;
+
+    static_assert(compact_report::region_count == 4);
+    static_assert(compact_report::back_reference_size == 0);
+    static_assert(regular_report::region_count == 4);
+
+    //4 regions * 2 references + 3 submachines (including the root one) * 1
+    //reference + 1 context reference (from emitting_blue)
+    static_assert(regular_report::back_reference_size == 12 * sizeof(void*));
+
+    //The compact layout saves at least the back references (and possibly some
+    //padding)
+    static_assert(compact_report::machine_size + regular_report::back_reference_size <= regular_report::machine_size);
+
+    template<class MachineDef>
+    void run_scenario()
+    {
+        using namespace states;
+        using namespace states::on_ns;
+        using machine_t = maki::machine<MachineDef>;
+
+        static constexpr auto root_region_path = maki::region_path_c<MachineDef, 0>;
+        static constexpr auto on_region_path = root_region_path.template add<on>();
+
+        auto machine = machine_t{};
+        auto& ctx = machine.context();
+
+        machine.process_event(events::power_button_press{});
+        REQUIRE(machine.template is_active_state<root_region_path, on>());
+        REQUIRE(machine.template is_active_state<on_region_path, emitting_red>());
+        REQUIRE(ctx.out == "power;red;");
+
+        machine.process_event(events::color_button_press{});
+        machine.process_event(events::color_button_press{});
+        REQUIRE(machine.template is_active_state<on_region_path, emitting_blue>());
+        REQUIRE(ctx.out == "power;red;dark;");
+
+        const auto& on_ctx = machine.template state<on_region_path, emitting_red>().ctx;
+        REQUIRE(&on_ctx.parent == &ctx);
+        REQUIRE(on_ctx.color_count == 3);
+
+        machine.process_event(events::beep_button_press{});
+        REQUIRE(machine.template is_active_state<on_region_path, emitting_blue>());
+        REQUIRE(machine.template is_active_state<maki::region_path_c<MachineDef, 1>, beeping>());
+
+        machine.process_event(events::power_button_press{});
+        REQUIRE(machine.template is_active_state<root_region_path, off>());
+        REQUIRE(ctx.out == "power;red;dark;power;");
+    }
+}
+
+TEST_CASE("compact_layout")
+{
+    SECTION("regular layout")
+    {
+        run_scenario<regular_machine_def>();
+    }
+
+    SECTION("compact layout")
+    {
+        run_scenario<compact_machine_def>();
+    }
+}
@@ -7,6 +7,7 @@
 #include <maki/detail/function_queue.hpp>
 #include "../common.hpp"
 #include <array>
+#include <string>
 
 namespace
 {
@@ -95,21 +96,13 @@ TEST_CASE("detail::function_queue")
         auto pbig = new big_struct{big_array};
         REQUIRE(plain_new_call_count == 2);
 
-        auto small_function_queue = maki::detail::function_queue
-        <
-            int&,
-            sizeof(small_struct)
-        >{};
+        auto small_function_queue = maki::detail::function_queue<int&>{};
         small_function_queue.push<copy_small_struct_content>(*psmall);
         REQUIRE(plain_new_call_count == 2); //no call to plain new
 
-        auto big_function_queue = maki::detail::function_queue
-        <
-            big_array_t&,
-            sizeof(big_struct) / 2
-        >{};
+        auto big_function_queue = maki::detail::function_queue<big_array_t&>{};
         big_function_queue.push<copy_big_struct_content>(*pbig);
-        REQUIRE(plain_new_call_count == 3);
+        REQUIRE(plain_new_call_count == 2); //no call to plain new either
 
         delete psmall;
         REQUIRE(destructor_call_count == 1);
@@ -134,3 +127,98 @@ TEST_CASE("detail::function_queue")
 
     REQUIRE(destructor_call_count == 4);
 }
+
+namespace
+{
+    template<std::size_t Size>
+    struct sized_number
+    {
+        int value = 0;
+        std::array<char, Size> padding = {};
+    };
+
+    struct append_number
+    {
+        template<std::size_t Size>
+        static void call(const sized_number<Size>& in, std::string& out)
+        {
+            out += std::to_string(in.value) + ";";
+        }
+    };
+
+    struct recursive_context
+    {
+        maki::detail::function_queue<recursive_context&>& queue;
+        std::string out;
+    };
+
+    struct push_big_back
+    {
+        static void call(const sized_number<100>& in, recursive_context& ctx)
+        {
+            ctx.out += "big" + std::to_string(in.value) + ";";
+        }
+    };
+
+    struct push_back_if_positive
+    {
+        static void call(const int& in, recursive_context& ctx)
+        {
+            ctx.out += std::to_string(in) + ";";
+            if(in > 0)
+            {
+                //Push bigger and bigger records to force wrapping and growth
+                ctx.queue.push<push_back_if_positive>(in - 1);
+                ctx.queue.push<push_big_back>(sized_number<100>{in});
+            }
+        }
+    };
+}
+
+TEST_CASE("detail::function_queue (ordering)")
+{
+    SECTION("growth")
+    {
+        auto queue = maki::detail::function_queue<std::string&>{};
+        auto expected_out = std::string{};
+
+        for(auto i = 0; i < 100; ++i)
+        {
+            if(i % 3 == 0)
+            {
+                queue.push<append_number>(sized_number<1>{i});
+            }
+            else
+            {
+                queue.push<append_number>(sized_number<64>{i});
+            }
+            expected_out += std::to_string(i) + ";";
+        }
+
+        auto out = std::string{};
+        queue.invoke_and_pop_all(out);
+        REQUIRE(out == expected_out);
+
+        //Queue is reusable once drained
+        out.clear();
+        queue.push<append_number>(sized_number<1>{1000});
+        queue.invoke_and_pop_all(out);
+        REQUIRE(out == "1000;");
+    }
+
+    SECTION("wrap")
+    {
+        auto queue = maki::detail::function_queue<recursive_context&>{};
+        auto ctx = recursive_context{queue, {}};
+
+        auto expected_out = std::string{"20;"};
+        for(auto i = 19; i >= 0; --i)
+        {
+            expected_out += std::to_string(i) + ";big" + std::to_string(i + 1) + ";";
+        }
+
+        queue.push<push_back_if_positive>(20);
+        queue.invoke_and_pop_all(ctx);
+        REQUIRE(ctx.out == expected_out);
+    }
+}
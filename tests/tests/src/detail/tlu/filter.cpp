@@ -15,6 +15,28 @@ namespace
     {
         static constexpr auto value = std::is_same_v<T, int> || std::is_same_v<T, char>;
     };
+
+    //Big enough to exceed the default template instantiation depth of
+    //compilers with a recursive implementation
+    constexpr auto large_list_size = std::size_t{2000};
+
+    template<std::size_t Index>
+    struct indexed{};
+
+    template<class T>
+    struct is_even_index;
+
+    template<std::size_t Index>
+    struct is_even_index<indexed<Index>>
+    {
+        static constexpr auto value = Index % 2 == 0;
+    };
+
+    template<std::size_t... Indexes>
+    std::tuple<indexed<Indexes>...> make_large_list(std::index_sequence<Indexes...>);
+
+    template<std::size_t... Indexes>
+    std::tuple<indexed<Indexes * 2>...> make_large_even_list(std::index_sequence<Indexes...>);
 }
 
 TEST_CASE("detail::tlu::filter")
@@ -25,4 +47,25 @@ TEST_CASE("detail::tlu::filter")
     using expected_filtered_type_list = std::tuple<char, int>;
 
     REQUIRE(std::is_same_v<filtered_type_list, expected_filtered_type_list>);
+
+    REQUIRE(std::is_same_v<maki::detail::tlu::filter_t<std::tuple<>, is_char_or_int>, std::tuple<>>);
+    REQUIRE(std::is_same_v<maki::detail::tlu::filter_t<std::tuple<short, long>, is_char_or_int>, std::tuple<>>);
+    REQUIRE
+    (
+        std::is_same_v
+        <
+            maki::detail::tlu::filter_t<std::tuple<int, short, int, char, char>, is_char_or_int>,
+            std::tuple<int, int, char, char>
+        >
+    );
+}
+
+TEST_CASE("detail::tlu::filter (large list)")
+{
+    using type_list = decltype(make_large_list(std::make_index_sequence<large_list_size>{}));
+
+    using filtered_type_list = maki::detail::tlu::filter_t<type_list, is_even_index>;
+    using expected_filtered_type_list = decltype(make_large_even_list(std::make_index_sequence<large_list_size / 2>{}));
+
+    REQUIRE(std::is_same_v<filtered_type_list, expected_filtered_type_list>);
 }
@@ -60,4 +60,75 @@ TEST_CASE("detail::transition_table_digest")
 {
     REQUIRE(std::is_same_v<digest_t::state_type_list, state_tuple_t>);
     REQUIRE(!digest_t::has_null_events);
+
+    REQUIRE(digest_t::state_def_index_v<state0> == 0);
+    REQUIRE(digest_t::state_def_index_v<state3> == 3);
+    REQUIRE(digest_t::state_index_v<state2> == 2);
+}
+
+TEST_CASE("detail::transition_table_digest (duplicates and null)")
+{
+    constexpr auto table = maki::empty_transition_table
+        .add_c<state2,    event0,     state2>
+        .add_c<state2,    event1,     state0>
+        .add_c<state0,    event2,     maki::null>
+        .add_c<state0,    maki::null, state2>
+        .add_c<maki::any, event3,     state1>
+    ;
+
+    using digest = maki::detail::transition_table_digest
+    <
+        std::decay_t<decltype(table)>,
+        machine_t
+    >;
+
+    REQUIRE(std::is_same_v<digest::state_def_type_list, maki::type_list<state2, state0, state1>>);
+    REQUIRE(digest::has_null_events);
+    REQUIRE(digest::state_def_index_v<state1> == 2);
+}
+
+namespace
+{
+    namespace operator_states
+    {
+        EMPTY_STATE(op_state0);
+        EMPTY_STATE(op_state1);
+        EMPTY_STATE(op_state2);
+        EMPTY_STATE(op_state3);
+        EMPTY_STATE(op_state4);
+
+        //Catch-all operator that must not interfere with the digest
+        template<class T, class U>
+        void operator+(const T&, const U&) = delete;
+    }
+}
+
+TEST_CASE("detail::transition_table_digest (many transitions)")
+{
+    using namespace operator_states;
+
+    //More transitions than a chunk of add_states
+    constexpr auto table = maki::empty_transition_table
+        .add_c<op_state0, event0,     op_state1>
+        .add_c<op_state1, event0,     op_state2>
+        .add_c<op_state2, event0,     op_state1>
+        .add_c<op_state1, event1,     op_state0>
+        .add_c<op_state0, event1,     op_state2>
+        .add_c<op_state2, event1,     op_state0>
+        .add_c<op_state0, event2,     op_state0>
+        .add_c<op_state1, event2,     op_state1>
+        .add_c<op_state2, event2,     op_state3>
+        .add_c<op_state3, event3,     op_state2>
+        .add_c<op_state3, maki::null, op_state4>
+    ;
+
+    using digest = maki::detail::transition_table_digest
+    <
+        std::decay_t<decltype(table)>,
+        machine_t
+    >;
+
+    REQUIRE(std::is_same_v<digest::state_def_type_list, maki::type_list<op_state0, op_state1, op_state2, op_state3, op_state4>>);
+    REQUIRE(digest::has_null_events);
+    REQUIRE(digest::state_def_index_v<op_state4> == 4);
 }
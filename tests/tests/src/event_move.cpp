@@ -0,0 +1,162 @@
+//Copyright Florian Goujeon 2021 - 2023.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+#include <maki.hpp>
+#include "common.hpp"
+#include <vector>
+#include <utility>
+
+namespace
+{
+    int copy_count = 0;
+
+    struct context
+    {
+        int payload_size_sum = 0;
+    };
+
+    namespace events
+    {
+        //An event that owns a heap buffer and counts its copies
+        struct payload
+        {
+            payload(std::vector<char> d):
+                data(std::move(d))
+            {
+            }
+
+            payload(const payload& other):
+                data(other.data)
+            {
+                ++copy_count;
+            }
+
+            payload(payload&& other) noexcept = default;
+
+            payload& operator=(const payload&) = delete;
+            payload& operator=(payload&&) = delete;
+            ~payload() = default;
+
+            std::vector<char> data;
+        };
+
+        struct process_payload{};
+        struct enqueue_payload{};
+    }
+
+    namespace states
+    {
+        EMPTY_STATE(on);
+    }
+
+    namespace actions
+    {
+        constexpr auto process_payload = [](auto& machine, context& /*ctx*/, const events::process_payload& /*event*/)
+        {
+            //Recursive call, so the event is enqueued
+            machine.process_event(events::payload{std::vector<char>(64)});
+        };
+
+        constexpr auto enqueue_payload = [](auto& machine, context& /*ctx*/, const events::enqueue_payload& /*event*/)
+        {
+            auto evt = events::payload{std::vector<char>(32)};
+            machine.enqueue_event(std::move(evt));
+        };
+
+        void consume_payload(context& ctx, const events::payload& event)
+        {
+            ctx.payload_size_sum += static_cast<int>(event.data.size());
+        }
+    }
+
+    constexpr auto transition_table = maki::empty_transition_table
+        .add_c<states::on, events::process_payload, maki::null, actions::process_payload>
+        .add_c<states::on, events::enqueue_payload, maki::null, actions::enqueue_payload>
+        .add_c<states::on, events::payload,         maki::null, actions::consume_payload>
+    ;
+
+    struct machine_def
+    {
+        static constexpr auto conf = maki::default_machine_conf
+            .set_transition_tables(transition_table)
+            .set_context<context>()
+            .set_post_event_queue_capacity(16)
+        ;
+    };
+
+    struct static_queue_machine_def
+    {
+        static constexpr auto conf = maki::default_machine_conf
+            .set_transition_tables(transition_table)
+            .set_context<context>()
+            .set_run_to_completion_queue_size(256)
+            .enable_on_queue_overflow()
+        ;
+
+        template<class Event>
+        void on_queue_overflow(const Event& /*event*/)
+        {
+        }
+    };
+
+    template<class MachineDef>
+    void check_recursive_calls()
+    {
+        auto machine = maki::machine<MachineDef>{};
+        auto& ctx = machine.context();
+
+        copy_count = 0;
+
+        machine.process_event(events::process_payload{});
+        REQUIRE(ctx.payload_size_sum == 64);
+
+        machine.process_event(events::enqueue_payload{});
+        REQUIRE(ctx.payload_size_sum == 96);
+
+        REQUIRE(copy_count == 0);
+
+        //Lvalues are still copied
+        machine.process_event(events::process_payload{});
+        {
+            const auto evt = events::payload{std::vector<char>(1)};
+            machine.process_event(evt);
+        }
+        REQUIRE(ctx.payload_size_sum == 161);
+        REQUIRE(copy_count == 0); //Not enqueued, so not copied
+    }
+}
+
+TEST_CASE("event_move")
+{
+    SECTION("dynamic run-to-completion queue")
+    {
+        check_recursive_calls<machine_def>();
+    }
+
+    SECTION("static run-to-completion queue")
+    {
+        check_recursive_calls<static_queue_machine_def>();
+    }
+
+    SECTION("post_event")
+    {
+        auto machine = maki::machine<machine_def>{};
+        auto& ctx = machine.context();
+
+        copy_count = 0;
+
+        REQUIRE(machine.post_event(events::payload{std::vector<char>(8)}));
+        REQUIRE(copy_count == 0);
+
+        const auto evt = events::payload{std::vector<char>(4)};
+        REQUIRE(machine.post_event(evt));
+        REQUIRE(copy_count == 1);
+
+        machine.process_enqueued_events();
+        REQUIRE(ctx.payload_size_sum == 12);
+        REQUIRE(copy_count == 1);
+    }
+}
@@ -0,0 +1,14 @@
+//Copyright Florian Goujeon 2021 - 2023.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+#include "machine.hpp"
+
+MAKI_DEFINE_MACHINE
+(
+    explicit_instantiation::machine_t,
+    explicit_instantiation::events::button_press,
+    explicit_instantiation::events::increment
+)
@@ -0,0 +1,65 @@
+//Copyright Florian Goujeon 2021 - 2023.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+#ifndef EXPLICIT_INSTANTIATION_MACHINE_HPP
+#define EXPLICIT_INSTANTIATION_MACHINE_HPP
+
+#include <maki.hpp>
+#include "../common.hpp"
+
+//Not in an anonymous namespace, as the machine is shared by several TUs
+namespace explicit_instantiation
+{
+    struct context
+    {
+        int counter = 0;
+    };
+
+    namespace events
+    {
+        struct button_press{};
+        struct increment{};
+    }
+
+    namespace states
+    {
+        EMPTY_STATE(off);
+        EMPTY_STATE(on);
+    }
+
+    namespace actions
+    {
+        inline void increment(context& ctx)
+        {
+            ++ctx.counter;
+        }
+    }
+
+    constexpr auto transition_table = maki::empty_transition_table
+        .add_c<states::off, events::button_press, states::on>
+        .add_c<states::on,  events::button_press, states::off>
+        .add_c<states::on,  events::increment,    maki::null, actions::increment>
+    ;
+
+    struct machine_def
+    {
+        static constexpr auto conf = maki::default_machine_conf
+            .set_transition_tables(transition_table)
+            .set_context<context>()
+        ;
+    };
+
+    using machine_t = maki::machine<machine_def>;
+}
+
+MAKI_DECLARE_MACHINE
+(
+    explicit_instantiation::machine_t,
+    explicit_instantiation::events::button_press,
+    explicit_instantiation::events::increment
+)
+
+#endif
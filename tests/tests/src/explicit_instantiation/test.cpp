@@ -0,0 +1,31 @@
+//Copyright Florian Goujeon 2021 - 2023.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+#include "machine.hpp"
+
+TEST_CASE("explicit_instantiation")
+{
+    using namespace explicit_instantiation;
+
+    //The entry points used below are instantiated in machine.cpp only.
+    auto machine = machine_t{};
+    auto& ctx = machine.context();
+
+    REQUIRE(machine.is_active_state<states::off>());
+
+    machine.process_event(events::button_press{});
+    REQUIRE(machine.is_active_state<states::on>());
+
+    machine.process_event(events::increment{});
+    machine.process_event_now(events::increment{});
+    REQUIRE(ctx.counter == 2);
+
+    machine.stop();
+    REQUIRE(!machine.is_running());
+
+    machine.start();
+    REQUIRE(machine.is_active_state<states::off>());
+}
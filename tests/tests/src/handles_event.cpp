@@ -0,0 +1,160 @@
+//Copyright Florian Goujeon 2021 - 2023.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+#include <maki.hpp>
+#include "common.hpp"
+#include <variant>
+#include <string>
+
+namespace
+{
+    struct context
+    {
+        std::string out;
+    };
+
+    namespace events
+    {
+        struct power_button_press{};
+        struct color_button_press{};
+        struct state_event{};
+        struct machine_event{};
+        struct unhandled{};
+        struct also_unhandled{};
+    }
+
+    namespace states
+    {
+        EMPTY_STATE(off);
+        EMPTY_STATE(emitting_red);
+        EMPTY_STATE(emitting_green);
+
+        struct idle
+        {
+            static constexpr auto conf = maki::default_state_conf
+                .enable_on_event_for<events::state_event>()
+            ;
+
+            void on_event(const events::state_event& /*event*/)
+            {
+                ctx.out += "state_event;";
+            }
+
+            context& ctx;
+        };
+
+        constexpr auto on_transition_table = maki::empty_transition_table
+            .add_c<emitting_red,   events::color_button_press, emitting_green>
+            .add_c<emitting_green, events::color_button_press, emitting_red>
+        ;
+
+        struct on
+        {
+            static constexpr auto conf = maki::default_submachine_conf
+                .set_transition_tables(on_transition_table)
+            ;
+        };
+    }
+
+    constexpr auto power_transition_table = maki::empty_transition_table
+        .add_c<states::off, events::power_button_press, states::on>
+        .add_c<states::on,  events::power_button_press, states::off>
+    ;
+
+    constexpr auto idle_transition_table = maki::empty_transition_table
+        .add_c<states::idle, maki::any_of<events::also_unhandled, events::unhandled>, maki::null>
+    ;
+
+    struct machine_def
+    {
+        static constexpr auto conf = maki::default_machine_conf
+            .set_transition_tables(power_transition_table)
+            .set_context<context>()
+            .enable_on_event_for<events::machine_event>()
+        ;
+
+        void on_event(const events::machine_event& /*event*/)
+        {
+            ctx.out += "machine_event;";
+        }
+
+        context& ctx;
+    };
+
+    struct unprocessed_machine_def
+    {
+        static constexpr auto conf = maki::default_machine_conf
+            .set_transition_tables(power_transition_table)
+            .set_context<context>()
+            .enable_on_unprocessed()
+        ;
+
+        template<class Event>
+        void on_unprocessed(const Event& /*event*/)
+        {
+            ctx.out += "unprocessed;";
+        }
+
+        context& ctx;
+    };
+
+    struct idle_machine_def
+    {
+        static constexpr auto conf = maki::default_machine_conf
+            .set_transition_tables(idle_transition_table)
+            .set_context<context>()
+        ;
+    };
+
+    using machine_t = maki::machine<machine_def>;
+    using unprocessed_machine_t = maki::machine<unprocessed_machine_def>;
+    using idle_machine_t = maki::machine<idle_machine_def>;
+
+    //Transitions, including in submachines
+    static_assert(machine_t::handles_event_v<events::power_button_press>);
+    static_assert(machine_t::handles_event_v<events::color_button_press>);
+
+    //on_event() of the machine definition
+    static_assert(machine_t::handles_event_v<events::machine_event>);
+
+    static_assert(!machine_t::handles_event_v<events::unhandled>);
+    static_assert(!machine_t::handles_event_v<events::state_event>);
+
+    //Variants
+    static_assert(machine_t::handles_event_v<std::variant<events::unhandled, events::power_button_press>>);
+    static_assert(!machine_t::handles_event_v<std::variant<events::unhandled, events::state_event>>);
+
+    //on_unprocessed() handles everything
+    static_assert(unprocessed_machine_t::handles_event_v<events::unhandled>);
+
+    //on_event() of states and type patterns
+    static_assert(idle_machine_t::handles_event_v<events::state_event>);
+    static_assert(idle_machine_t::handles_event_v<events::unhandled>);
+    static_assert(!idle_machine_t::handles_event_v<events::machine_event>);
+}
+
+TEST_CASE("handles_event")
+{
+    auto machine = machine_t{};
+    auto& ctx = machine.context();
+
+    machine.process_event(events::unhandled{});
+    machine.process_event_now(events::unhandled{});
+    machine.enqueue_event(events::unhandled{});
+    machine.process_variant_event(std::variant<events::unhandled, events::state_event>{});
+    REQUIRE(ctx.out.empty());
+    REQUIRE(machine.is_active_state<states::off>());
+
+    machine.process_event(events::machine_event{});
+    REQUIRE(ctx.out == "machine_event;");
+
+    machine.process_variant_event(std::variant<events::unhandled, events::power_button_press>{events::power_button_press{}});
+    REQUIRE(machine.is_active_state<states::on>());
+
+    auto unprocessed_machine = unprocessed_machine_t{};
+    unprocessed_machine.process_event(events::unhandled{});
+    REQUIRE(unprocessed_machine.context().out == "unprocessed;");
+}
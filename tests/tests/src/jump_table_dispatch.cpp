@@ -0,0 +1,160 @@
+//Copyright Florian Goujeon 2021 - 2023.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+#include <maki.hpp>
+#include "common.hpp"
+
+namespace
+{
+    struct context
+    {
+        int value = 0;
+        std::string out;
+    };
+
+    namespace events
+    {
+        struct next{};
+        struct reset{};
+        struct set_value
+        {
+            int value = 0;
+        };
+        struct log{};
+    }
+
+    namespace states
+    {
+        EMPTY_STATE(idle);
+        EMPTY_STATE(s0);
+        EMPTY_STATE(s1);
+        EMPTY_STATE(s2);
+        EMPTY_STATE(transient);
+
+        struct logging
+        {
+            static constexpr auto conf = maki::default_state_conf
+                .enable_on_event_for<events::log>()
+            ;
+
+            void on_event(const events::log& /*event*/)
+            {
+                ctx.out += "logging::on_event;";
+            }
+
+            context& ctx;
+        };
+    }
+
+    namespace actions
+    {
+        void set_value(context& ctx, const events::set_value& event)
+        {
+            ctx.value = event.value;
+        }
+
+        void log_any(context& ctx)
+        {
+            ctx.out += "any::log;";
+        }
+    }
+
+    namespace guards
+    {
+        bool is_value_odd(context& ctx)
+        {
+            return ctx.value % 2 == 1;
+        }
+
+        constexpr auto is_value_even = !maki::guard_c<is_value_odd>;
+    }
+
+    using maki::any_but;
+    using maki::any_of;
+
+    constexpr auto transition_table = maki::empty_transition_table
+        .add_c<states::idle,                  events::next,      states::s0>
+        .add_c<states::s0,                    events::next,      states::s1,        maki::noop, guards::is_value_odd>
+        .add_c<states::s0,                    events::next,      states::s2,        maki::noop, guards::is_value_even>
+        .add_c<any_of<states::s1, states::s2>, events::next,     states::transient>
+        .add_c<states::transient,             maki::null,        states::logging>
+        .add_c<states::logging,               events::log,       maki::null,        actions::log_any>
+        .add_c<any_but<states::idle>,         events::reset,     states::idle>
+        .add_c<maki::any,                     events::set_value, maki::null,        actions::set_value>
+    ;
+
+    template<bool JumpTableDispatch>
+    struct machine_def
+    {
+        static constexpr auto base_conf = maki::default_machine_conf
+            .set_transition_tables(transition_table)
+            .set_context<context>()
+        ;
+
+        static constexpr auto conf = []
+        {
+            if constexpr(JumpTableDispatch)
+            {
+                return base_conf.enable_jump_table_dispatch();
+            }
+            else
+            {
+                return base_conf;
+            }
+        }();
+    };
+
+    template<bool JumpTableDispatch>
+    void test()
+    {
+        using machine_t = maki::machine<machine_def<JumpTableDispatch>>;
+
+        auto machine = machine_t{};
+        auto& ctx = machine.context();
+
+        REQUIRE(machine.template is_active_state<states::idle>());
+
+        machine.process_event(events::reset{});
+        REQUIRE(machine.template is_active_state<states::idle>());
+
+        machine.process_event(events::next{});
+        REQUIRE(machine.template is_active_state<states::s0>());
+
+        machine.process_event(events::set_value{1});
+        REQUIRE(machine.template is_active_state<states::s0>());
+        REQUIRE(ctx.value == 1);
+
+        machine.process_event(events::next{});
+        REQUIRE(machine.template is_active_state<states::s1>());
+
+        machine.process_event(events::next{});
+        REQUIRE(machine.template is_active_state<states::logging>());
+
+        //Transitions are tried before on_event()
+        ctx.out.clear();
+        machine.process_event(events::log{});
+        REQUIRE(ctx.out == "any::log;");
+
+        machine.process_event(events::reset{});
+        REQUIRE(machine.template is_active_state<states::idle>());
+
+        machine.process_event(events::next{});
+        machine.process_event(events::set_value{2});
+        machine.process_event(events::next{});
+        REQUIRE(machine.template is_active_state<states::s2>());
+
+        //No transition when stopped
+        machine.stop();
+        machine.process_event(events::next{});
+        REQUIRE(!machine.is_running());
+    }
+}
+
+TEST_CASE("jump_table_dispatch")
+{
+    test<false>();
+    test<true>();
+}
@@ -0,0 +1,174 @@
+//Copyright Florian Goujeon 2021 - 2023.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+#include <maki.hpp>
+#include "common.hpp"
+#include <array>
+#include <string>
+
+namespace
+{
+    struct context
+    {
+        std::string out;
+    };
+
+    int live_state_count = 0;
+
+    namespace events
+    {
+        struct next{};
+        struct fill{};
+    }
+
+    namespace states
+    {
+        EMPTY_STATE(idle);
+
+        template<std::size_t Index>
+        struct big
+        {
+            static constexpr auto conf = maki::default_state_conf
+                .enable_on_entry()
+                .enable_on_event_for<events::fill>()
+                .enable_on_exit()
+                .enable_lazy_construction()
+            ;
+
+            big(context& c):
+                ctx(c)
+            {
+                ctx.out += "construct" + std::to_string(Index) + ";";
+                ++live_state_count;
+            }
+
+            big(const big&) = delete;
+            big(big&&) = delete;
+            big& operator=(const big&) = delete;
+            big& operator=(big&&) = delete;
+
+            ~big()
+            {
+                ctx.out += "destroy" + std::to_string(Index) + ";";
+                --live_state_count;
+            }
+
+            void on_entry()
+            {
+                ctx.out += "entry" + std::to_string(Index) + ";";
+            }
+
+            void on_event(const events::fill& /*event*/)
+            {
+                buffer.fill(static_cast<char>(Index));
+            }
+
+            void on_exit()
+            {
+                ctx.out += "exit" + std::to_string(Index) + ";";
+            }
+
+            context& ctx;
+            std::array<char, 1024 * Index> buffer{};
+        };
+
+        using big1 = big<1>;
+        using big2 = big<2>;
+
+        //Same size as big2, but constructed with the region
+        struct eager
+        {
+            static constexpr auto conf = maki::default_state_conf;
+
+            std::array<char, 1024 * 2> buffer{};
+        };
+    }
+
+    constexpr auto transition_table = maki::empty_transition_table
+        .add_c<states::idle, events::next, states::big1>
+        .add_c<states::big1, events::next, states::big2>
+        .add_c<states::big2, events::next, states::big2>
+    ;
+
+    struct machine_def
+    {
+        static constexpr auto conf = maki::default_machine_conf
+            .set_transition_tables(transition_table)
+            .set_context<context>()
+        ;
+    };
+
+    using machine_t = maki::machine<machine_def>;
+
+    constexpr auto region_path = maki::region_path_c<machine_def>;
+
+    constexpr auto eager_transition_table = maki::empty_transition_table
+        .add_c<states::idle, events::next, states::eager>
+    ;
+
+    struct eager_machine_def
+    {
+        static constexpr auto conf = maki::default_machine_conf
+            .set_transition_tables(eager_transition_table)
+            .set_context<context>()
+        ;
+    };
+}
+
+TEST_CASE("lazy_construction")
+{
+    SECTION("construction and destruction")
+    {
+        auto machine = machine_t{};
+        auto& ctx = machine.context();
+
+        REQUIRE(live_state_count == 0);
+
+        machine.process_event(events::next{});
+        REQUIRE(machine.is_active_state<states::big1>());
+        REQUIRE(ctx.out == "construct1;entry1;");
+        REQUIRE(live_state_count == 1);
+
+        machine.process_event(events::fill{});
+        REQUIRE(machine.state<region_path, states::big1>().buffer[0] == 1);
+
+        ctx.out.clear();
+        machine.process_event(events::next{});
+        REQUIRE(machine.is_active_state<states::big2>());
+        REQUIRE(ctx.out == "exit1;destroy1;construct2;entry2;");
+        REQUIRE(live_state_count == 1);
+
+        //A self-transition gives a new state object
+        machine.process_event(events::fill{});
+        ctx.out.clear();
+        machine.process_event(events::next{});
+        REQUIRE(ctx.out == "exit2;destroy2;construct2;entry2;");
+        REQUIRE(machine.state<region_path, states::big2>().buffer[0] == 0);
+
+        ctx.out.clear();
+        machine.stop();
+        REQUIRE(ctx.out == "exit2;destroy2;");
+        REQUIRE(live_state_count == 0);
+    }
+
+    SECTION("destruction of the machine")
+    {
+        {
+            auto machine = machine_t{};
+            machine.process_event(events::next{});
+            REQUIRE(live_state_count == 1);
+        }
+        REQUIRE(live_state_count == 0);
+    }
+
+    SECTION("storage")
+    {
+        //The lazy states share a single storage, sized for the largest one
+        REQUIRE(sizeof(machine_t) < sizeof(states::big1) + sizeof(states::big2));
+        REQUIRE(sizeof(machine_t) >= sizeof(states::big2));
+        REQUIRE(sizeof(maki::machine<eager_machine_def>) >= sizeof(states::eager));
+    }
+}
@@ -0,0 +1,364 @@
+//Copyright Florian Goujeon 2021 - 2023.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+#include <maki.hpp>
+#include "common.hpp"
+
+namespace
+{
+    enum class led_color
+    {
+        off,
+        red,
+        green,
+        blue
+    };
+
+    struct context
+    {
+        int id = 0;
+        led_color current_led_color = led_color::off;
+        int power_press_count = 0;
+    };
+
+    namespace events
+    {
+        struct power_button_press{};
+        struct color_button_press{};
+    }
+
+    namespace states
+    {
+        EMPTY_STATE(off);
+        EMPTY_STATE(idle);
+
+        struct emitting_red
+        {
+            static constexpr auto conf = maki::default_state_conf
+                .enable_on_entry()
+            ;
+
+            void on_entry()
+            {
+                ctx.current_led_color = led_color::red;
+            }
+
+            context& ctx;
+        };
+
+        struct emitting_green
+        {
+            static constexpr auto conf = maki::default_state_conf
+                .enable_on_entry()
+            ;
+
+            void on_entry()
+            {
+                ctx.current_led_color = led_color::green;
+            }
+
+            context& ctx;
+        };
+
+        EMPTY_STATE(emitting_blue);
+
+        constexpr auto on_transition_table = maki::empty_transition_table
+            .add_c<states::emitting_red,   events::color_button_press, states::emitting_green>
+            .add_c<states::emitting_green, events::color_button_press, states::emitting_blue>
+            .add_c<states::emitting_blue,  events::color_button_press, states::emitting_red>
+        ;
+
+        struct on
+        {
+            static constexpr auto conf = maki::default_submachine_conf
+                .set_transition_tables(on_transition_table)
+                .enable_on_exit()
+            ;
+
+            void on_exit()
+            {
+                ctx.current_led_color = led_color::off;
+            }
+
+            context& ctx;
+        };
+    }
+
+    namespace actions
+    {
+        void count_power_press(context& ctx)
+        {
+            ++ctx.power_press_count;
+        }
+    }
+
+    constexpr auto power_transition_table = maki::empty_transition_table
+        .add_c<states::off, events::power_button_press, states::on>
+        .add_c<states::on,  events::power_button_press, states::off>
+    ;
+
+    constexpr auto counter_transition_table = maki::empty_transition_table
+        .add_c<states::idle, events::power_button_press, maki::null, actions::count_power_press>
+    ;
+
+    struct machine_def
+    {
+        static constexpr auto conf = maki::default_machine_conf
+            .set_transition_tables(power_transition_table, counter_transition_table)
+            .set_context<context>()
+        ;
+    };
+
+    using machine_pool_t = maki::machine_pool<machine_def>;
+
+    //2 bits for the power region (off, on, stopped), 1 bit for the counter
+    //region (idle, stopped) and 2 bits for the region of on (3 states +
+    //stopped), bit-packed into a single byte per instance
+    static_assert(maki::layout_report<maki::machine<machine_def>>::state_index_bit_count == 5);
+
+    namespace lazy_states
+    {
+        struct big
+        {
+            static constexpr auto conf = maki::default_state_conf
+                .enable_lazy_construction()
+            ;
+
+            int data[64] = {}; //NOLINT(cppcoreguidelines-avoid-c-arrays)
+        };
+
+        constexpr auto on_transition_table = maki::empty_transition_table
+            .add_c<states::idle, events::color_button_press, big>
+        ;
+
+        struct on
+        {
+            static constexpr auto conf = maki::default_submachine_conf
+                .set_transition_tables(on_transition_table)
+            ;
+        };
+    }
+
+    struct lazy_machine_def
+    {
+        static constexpr auto conf = maki::default_machine_conf
+            .set_transition_tables
+            (
+                maki::empty_transition_table
+                    .add_c<states::off, events::power_button_press, lazy_states::on>
+            )
+            .set_context<context>()
+        ;
+    };
+
+    template<class Def>
+    constexpr bool has_lazy_state()
+    {
+        //The machine type must be complete before its root submachine type
+        static_assert(sizeof(maki::machine<Def>) != 0);
+        return maki::detail::submachine<Def, void>::flat_has_lazy_state;
+    }
+
+    //maki::machine_pool<lazy_machine_def> doesn't compile, because machine_pool
+    //doesn't support lazily constructed states (even in submachines).
+    static_assert(has_lazy_state<lazy_machine_def>());
+    static_assert(!has_lazy_state<machine_def>());
+
+    namespace stateful_states
+    {
+        //Would leak the press count of an instance into the other ones
+        struct counting
+        {
+            static constexpr auto conf = maki::default_state_conf
+                .enable_on_event_for<events::color_button_press>()
+            ;
+
+            void on_event(const events::color_button_press& /*event*/)
+            {
+                ++press_count;
+            }
+
+            int press_count = 0;
+        };
+
+        constexpr auto on_transition_table = maki::empty_transition_table
+            .add_c<counting, events::power_button_press, states::idle>
+        ;
+
+        struct on
+        {
+            static constexpr auto conf = maki::default_submachine_conf
+                .set_transition_tables(on_transition_table)
+            ;
+        };
+    }
+
+    struct stateful_machine_def
+    {
+        static constexpr auto conf = maki::default_machine_conf
+            .set_transition_tables
+            (
+                maki::empty_transition_table
+                    .add_c<states::off, events::power_button_press, stateful_states::on>
+            )
+            .set_context<context>()
+        ;
+    };
+
+    template<class Def>
+    constexpr bool has_stateful_state()
+    {
+        //The machine type must be complete before its root submachine type
+        static_assert(sizeof(maki::machine<Def>) != 0);
+        return maki::detail::submachine<Def, void>::flat_has_stateful_state;
+    }
+
+    //maki::machine_pool<stateful_machine_def> doesn't compile either, because
+    //the states of the pool are shared by all the instances. States made of a
+    //single reference (such as states::emitting_red) are fine, though.
+    static_assert(has_stateful_state<stateful_machine_def>());
+    static_assert(!has_stateful_state<machine_def>());
+
+    //Counts the moves of the contexts
+    struct move_counting_context
+    {
+        explicit move_counting_context(int& count):
+            move_count(&count)
+        {
+        }
+
+        move_counting_context(const move_counting_context&) = delete;
+
+        move_counting_context(move_counting_context&& other) noexcept:
+            move_count(other.move_count)
+        {
+            ++*move_count;
+        }
+
+        move_counting_context& operator=(const move_counting_context&) = delete;
+
+        move_counting_context& operator=(move_counting_context&& other) noexcept
+        {
+            move_count = other.move_count;
+            ++*move_count;
+            return *this;
+        }
+
+        ~move_counting_context() = default;
+
+        int* move_count;
+    };
+
+    struct move_counting_machine_def
+    {
+        static constexpr auto conf = maki::default_machine_conf
+            .set_transition_tables
+            (
+                maki::empty_transition_table
+                    .add_c<states::idle, events::power_button_press, maki::null>
+            )
+            .set_context<move_counting_context>()
+        ;
+    };
+
+    constexpr auto power_region_path = maki::region_path_c<machine_def, 0>;
+    constexpr auto counter_region_path = maki::region_path_c<machine_def, 1>;
+    constexpr auto on_region_path = power_region_path.add<states::on, 0>();
+}
+
+TEST_CASE("machine_pool")
+{
+    constexpr auto instance_count = 1000;
+
+    auto pool = machine_pool_t{};
+    pool.reserve(instance_count);
+
+    for(auto i = 0; i < instance_count; ++i)
+    {
+        REQUIRE(pool.emplace(context{i}) == static_cast<std::size_t>(i));
+    }
+    REQUIRE(pool.size() == instance_count);
+
+    //Every instance has been started
+    for(auto i = std::size_t{0}; i < instance_count; ++i)
+    {
+        REQUIRE(pool.is_active_state<power_region_path, states::off>(i));
+        REQUIRE(pool.is_active_state<counter_region_path, states::idle>(i));
+        REQUIRE(pool.context(i).id == static_cast<int>(i));
+    }
+
+    //Turn on every other instance
+    for(auto i = std::size_t{0}; i < instance_count; i += 2)
+    {
+        pool.process_event(i, events::power_button_press{});
+    }
+
+    //Change color of every third instance
+    for(auto i = std::size_t{0}; i < instance_count; i += 3)
+    {
+        pool.process_event(i, events::color_button_press{});
+    }
+
+    for(auto i = std::size_t{0}; i < instance_count; ++i)
+    {
+        const auto& ctx = pool.context(i);
+        REQUIRE(ctx.id == static_cast<int>(i));
+
+        if(i % 2 == 0)
+        {
+            REQUIRE(pool.is_active_state<power_region_path, states::on>(i));
+            REQUIRE(ctx.power_press_count == 1);
+
+            if(i % 3 == 0)
+            {
+                REQUIRE(pool.is_active_state<on_region_path, states::emitting_green>(i));
+                REQUIRE(ctx.current_led_color == led_color::green);
+            }
+            else
+            {
+                REQUIRE(pool.is_active_state<on_region_path, states::emitting_red>(i));
+                REQUIRE(ctx.current_led_color == led_color::red);
+            }
+        }
+        else
+        {
+            REQUIRE(pool.is_active_state<power_region_path, states::off>(i));
+            REQUIRE(ctx.power_press_count == 0);
+            REQUIRE(ctx.current_led_color == led_color::off);
+        }
+    }
+
+    //Turn off
+    pool.process_event(0, events::power_button_press{});
+    REQUIRE(pool.is_active_state<power_region_path, states::off>(0));
+    REQUIRE(pool.context(0).current_led_color == led_color::off);
+    REQUIRE(pool.context(0).power_press_count == 2);
+
+    //Stop
+    pool.stop(1);
+    REQUIRE(!pool.is_active_state<power_region_path, states::off>(1));
+    REQUIRE(pool.is_active_state<power_region_path, states::off>(3));
+}
+
+TEST_CASE("machine_pool context moves")
+{
+    auto move_count = 0;
+
+    auto pool = maki::machine_pool<move_counting_machine_def>{};
+    pool.emplace(move_count);
+    pool.emplace(move_count);
+
+    //Consecutive operations on the same instance don't move its context
+    pool.process_event(0, events::power_button_press{});
+    move_count = 0;
+    pool.process_event(0, events::power_button_press{});
+    pool.process_event(0, events::power_button_press{});
+    REQUIRE(move_count == 0);
+
+    //Switching to another instance does
+    pool.process_event(1, events::power_button_press{});
+    REQUIRE(move_count != 0);
+}
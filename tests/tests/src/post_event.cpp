@@ -0,0 +1,164 @@
+//Copyright Florian Goujeon 2021 - 2023.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+#include <maki.hpp>
+#include "common.hpp"
+#include <array>
+#include <thread>
+#include <vector>
+
+namespace
+{
+    constexpr auto producer_count = 4;
+    constexpr auto event_count_per_producer = 10000;
+
+    struct context
+    {
+        int count = 0;
+        long long sum = 0;
+    };
+
+    namespace events
+    {
+        struct increment
+        {
+            int value = 0;
+        };
+
+        struct big_increment
+        {
+            std::array<int, 32> values = {};
+        };
+
+        struct repost{};
+    }
+
+    namespace states
+    {
+        EMPTY_STATE(on);
+    }
+
+    namespace actions
+    {
+        void increment(context& ctx, const events::increment& event)
+        {
+            ++ctx.count;
+            ctx.sum += event.value;
+        }
+
+        void big_increment(context& ctx, const events::big_increment& event)
+        {
+            ++ctx.count;
+            ctx.sum += event.values.back();
+        }
+
+        //Posts the same event again, as a constantly busy producer would
+        constexpr auto repost = [](auto& mach, context& ctx, const events::repost& event)
+        {
+            ++ctx.count;
+            mach.post_event(event);
+        };
+    }
+
+    constexpr auto transition_table = maki::empty_transition_table
+        .add_c<states::on, events::increment,     maki::null, actions::increment>
+        .add_c<states::on, events::big_increment, maki::null, actions::big_increment>
+        .add_c<states::on, events::repost,        maki::null, actions::repost>
+    ;
+
+    struct machine_def
+    {
+        static constexpr auto conf = maki::default_machine_conf
+            .set_transition_tables(transition_table)
+            .set_context<context>()
+            .set_post_event_queue_capacity(256)
+        ;
+    };
+
+    using machine_t = maki::machine<machine_def>;
+}
+
+TEST_CASE("post_event")
+{
+    auto machine = machine_t{};
+    auto& ctx = machine.context();
+
+    SECTION("single thread")
+    {
+        REQUIRE(machine.post_event(events::increment{1}));
+        REQUIRE(machine.post_event(events::big_increment{{2}}));
+        REQUIRE(ctx.count == 0);
+
+        machine.process_enqueued_events();
+        REQUIRE(ctx.count == 2);
+        REQUIRE(ctx.sum == 1);
+    }
+
+    SECTION("full queue")
+    {
+        for(auto i = 0; i < 256; ++i)
+        {
+            REQUIRE(machine.post_event(events::increment{1}));
+        }
+        REQUIRE(!machine.post_event(events::increment{1}));
+
+        machine.process_enqueued_events();
+        REQUIRE(ctx.count == 256);
+
+        REQUIRE(machine.post_event(events::increment{1}));
+    }
+
+    SECTION("events posted while processing")
+    {
+        //The events posted while processing are left for the next call, so
+        //that this one returns
+        REQUIRE(machine.post_event(events::repost{}));
+        REQUIRE(machine.post_event(events::repost{}));
+
+        machine.process_enqueued_events();
+        REQUIRE(ctx.count == 2);
+
+        machine.process_enqueued_events();
+        REQUIRE(ctx.count == 4);
+    }
+
+    SECTION("multiple producers")
+    {
+        auto producers = std::vector<std::thread>{};
+        for(auto i = 0; i < producer_count; ++i)
+        {
+            producers.emplace_back
+            (
+                [&machine]
+                {
+                    for(auto j = 0; j < event_count_per_producer; ++j)
+                    {
+                        while(!machine.post_event(events::increment{j}))
+                        {
+                            std::this_thread::yield();
+                        }
+                    }
+                }
+            );
+        }
+
+        while(ctx.count != producer_count * event_count_per_producer)
+        {
+            machine.process_enqueued_events();
+        }
+
+        for(auto& producer: producers)
+        {
+            producer.join();
+        }
+
+        const auto expected_sum_per_producer =
+            static_cast<long long>(event_count_per_producer) *
+            (event_count_per_producer - 1) / 2
+        ;
+        REQUIRE(ctx.sum == producer_count * expected_sum_per_producer);
+    }
+}
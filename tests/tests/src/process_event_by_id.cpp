@@ -0,0 +1,153 @@
+//Copyright Florian Goujeon 2021 - 2023.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+#include <maki.hpp>
+#include "common.hpp"
+#include <cstring>
+
+namespace
+{
+    struct context
+    {
+        std::string out;
+    };
+
+    namespace events
+    {
+        struct power_button_press{};
+        struct color_button_press{};
+        struct alert_button_press{};
+        struct emergency_stop{};
+
+        struct ping
+        {
+            int value = 0;
+        };
+    }
+
+    namespace states
+    {
+        EMPTY_STATE(off);
+
+        struct emitting_red
+        {
+            static constexpr auto conf = maki::default_state_conf
+                .enable_on_event_for<events::ping>()
+            ;
+
+            void on_event(const events::ping& event)
+            {
+                ctx.out += "emitting_red::on_event(ping " + std::to_string(event.value) + ");";
+            }
+
+            context& ctx;
+        };
+
+        EMPTY_STATE(emitting_green);
+
+        constexpr auto on_transition_table = maki::empty_transition_table
+            .add_c<states::emitting_red,   events::color_button_press, states::emitting_green>
+            .add_c<states::emitting_green, events::color_button_press, states::emitting_red>
+        ;
+
+        struct on
+        {
+            static constexpr auto conf = maki::default_submachine_conf
+                .set_transition_tables(on_transition_table)
+            ;
+        };
+    }
+
+    constexpr auto transition_table = maki::empty_transition_table
+        .add_c<states::off, events::power_button_press,                                        states::on>
+        .add_c<states::on,  maki::any_of<events::power_button_press, events::emergency_stop>, states::off>
+        .add_c<states::off, maki::any_but<events::power_button_press>,                         maki::null>
+    ;
+
+    struct machine_def
+    {
+        static constexpr auto conf = maki::default_machine_conf
+            .set_transition_tables(transition_table)
+            .set_context<context>()
+            .enable_on_event_for<events::alert_button_press>()
+        ;
+
+        void on_event(const events::alert_button_press& /*event*/)
+        {
+            ctx.out += "on_event(alert_button_press);";
+        }
+
+        context& ctx;
+    };
+
+    using machine_t = maki::machine<machine_def>;
+
+    constexpr auto on_region_path = maki::region_path_c<machine_def, 0>.add<states::on, 0>();
+}
+
+TEST_CASE("process_event_by_id")
+{
+    SECTION("event type list")
+    {
+        REQUIRE
+        (
+            std::is_same_v
+            <
+                machine_t::event_type_list,
+                maki::type_list
+                <
+                    events::alert_button_press,
+                    events::power_button_press,
+                    events::emergency_stop,
+                    events::color_button_press,
+                    events::ping
+                >
+            >
+        );
+        REQUIRE(machine_t::event_type_count == 5);
+        REQUIRE(machine_t::event_id<events::alert_button_press>() == 0);
+        REQUIRE(machine_t::event_id<events::ping>() == 4);
+    }
+
+    SECTION("process_event_by_id")
+    {
+        auto machine = machine_t{};
+        auto& ctx = machine.context();
+
+        const auto power_button_press = events::power_button_press{};
+        const auto color_button_press = events::color_button_press{};
+        const auto alert_button_press = events::alert_button_press{};
+        const auto emergency_stop = events::emergency_stop{};
+
+        REQUIRE(machine.is_active_state<states::off>());
+
+        REQUIRE(machine.process_event_by_id(machine_t::event_id<events::power_button_press>(), &power_button_press));
+        REQUIRE(machine.is_active_state<states::on>());
+        REQUIRE(machine.is_active_state<on_region_path, states::emitting_red>());
+
+        //Event read from a raw buffer
+        {
+            alignas(events::ping) unsigned char buffer[sizeof(events::ping)]; //NOLINT
+            const auto ping = events::ping{42};
+            std::memcpy(buffer, &ping, sizeof(ping));
+            REQUIRE(machine.process_event_by_id(machine_t::event_id<events::ping>(), buffer));
+            REQUIRE(ctx.out == "emitting_red::on_event(ping 42);");
+        }
+
+        REQUIRE(machine.process_event_by_id(machine_t::event_id<events::color_button_press>(), &color_button_press));
+        REQUIRE(machine.is_active_state<on_region_path, states::emitting_green>());
+
+        ctx.out.clear();
+        REQUIRE(machine.process_event_by_id(machine_t::event_id<events::alert_button_press>(), &alert_button_press));
+        REQUIRE(ctx.out == "on_event(alert_button_press);");
+
+        REQUIRE(!machine.process_event_by_id(machine_t::event_type_count, &power_button_press));
+        REQUIRE(machine.is_active_state<states::on>());
+
+        REQUIRE(machine.process_event_by_id(machine_t::event_id<events::emergency_stop>(), &emergency_stop));
+        REQUIRE(machine.is_active_state<states::off>());
+    }
+}
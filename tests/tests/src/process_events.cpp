@@ -0,0 +1,180 @@
+//Copyright Florian Goujeon 2021 - 2023.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+#include <maki.hpp>
+#include "common.hpp"
+#include <array>
+#include <variant>
+#include <vector>
+
+namespace
+{
+    struct context
+    {
+        std::string out;
+    };
+
+    namespace events
+    {
+        struct append
+        {
+            char c = 0;
+        };
+
+        struct append_twice
+        {
+            char c = 0;
+        };
+
+        struct fail{};
+        struct unhandled{};
+    }
+
+    namespace states
+    {
+        EMPTY_STATE(on);
+    }
+
+    namespace actions
+    {
+        void append(context& ctx, const events::append& event)
+        {
+            ctx.out += event.c;
+        }
+
+        //Recursively process events, in both possible ways
+        constexpr auto append_twice = [](auto& machine, context& ctx, const events::append_twice& event)
+        {
+            ctx.out += '(';
+            machine.process_event(events::append{event.c});
+            const auto evts = std::array<events::append, 1>{{{event.c}}};
+            machine.process_events(evts);
+            ctx.out += ')';
+        };
+
+        void fail(context& /*ctx*/)
+        {
+            throw std::runtime_error{"error"};
+        }
+
+        void append_exception(context& ctx)
+        {
+            ctx.out += '!';
+        }
+    }
+
+    constexpr auto transition_table = maki::empty_transition_table
+        .add_c<states::on, events::append,           maki::null, actions::append>
+        .add_c<states::on, events::append_twice,     maki::null, actions::append_twice>
+        .add_c<states::on, events::fail,             maki::null, actions::fail>
+        .add_c<states::on, maki::events::exception,  maki::null, actions::append_exception>
+    ;
+
+    template<bool RunToCompletion>
+    struct machine_def
+    {
+        static constexpr auto base_conf = maki::default_machine_conf
+            .set_transition_tables(transition_table)
+            .set_context<context>()
+        ;
+
+        static constexpr auto conf = []
+        {
+            if constexpr(RunToCompletion)
+            {
+                return base_conf;
+            }
+            else
+            {
+                return base_conf.disable_run_to_completion();
+            }
+        }();
+    };
+
+    using event_variant = std::variant
+    <
+        events::append,
+        events::append_twice,
+        events::fail
+    >;
+}
+
+TEST_CASE("process_events")
+{
+    using machine_t = maki::machine<machine_def<true>>;
+    auto machine = machine_t{};
+    auto& ctx = machine.context();
+
+    SECTION("iterator range")
+    {
+        const auto evts = std::vector<events::append>{{'a'}, {'b'}, {'c'}};
+        machine.process_events(evts.begin(), evts.end());
+        REQUIRE(ctx.out == "abc");
+    }
+
+    SECTION("unhandled events")
+    {
+        static_assert(!machine_t::handles_event_v<events::unhandled>);
+
+        const auto evts = std::vector<events::unhandled>(3);
+        machine.process_events(evts);
+        REQUIRE(ctx.out.empty());
+
+        const auto variant_evts = std::vector<std::variant<events::unhandled, events::append>>
+        {
+            events::unhandled{},
+            events::append{'a'},
+            events::unhandled{}
+        };
+        machine.process_events(variant_evts);
+        REQUIRE(ctx.out == "a");
+    }
+
+    SECTION("range of variants")
+    {
+        const auto evts = std::vector<event_variant>
+        {
+            events::append{'a'},
+            events::append_twice{'b'},
+            events::append{'c'}
+        };
+        machine.process_events(evts);
+
+        //Enqueued events are processed before the next event of the range
+        REQUIRE(ctx.out == "a()bbc");
+    }
+
+    SECTION("exception")
+    {
+        const auto evts = std::array<event_variant, 4>
+        {
+            events::append{'a'},
+            events::fail{},
+            events::append{'b'},
+            events::fail{}
+        };
+        machine.process_events(evts);
+
+        //Exception event is processed before the next event of the range
+        REQUIRE(ctx.out == "a!b!");
+    }
+}
+
+TEST_CASE("process_events (without run-to-completion)")
+{
+    using machine_t = maki::machine<machine_def<false>>;
+    auto machine = machine_t{};
+    auto& ctx = machine.context();
+
+    const auto evts = std::vector<event_variant>
+    {
+        events::append{'a'},
+        events::fail{},
+        events::append{'b'}
+    };
+    machine.process_events(evts);
+    REQUIRE(ctx.out == "a!b");
+}
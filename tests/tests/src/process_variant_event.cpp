@@ -0,0 +1,107 @@
+//Copyright Florian Goujeon 2021 - 2023.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+#include <maki.hpp>
+#include "common.hpp"
+#include <variant>
+
+namespace
+{
+    struct context
+    {
+        std::string out;
+    };
+
+    namespace events
+    {
+        struct power_button_press{};
+        struct color_button_press{};
+        struct ping{};
+        struct ignored{};
+    }
+
+    namespace states
+    {
+        EMPTY_STATE(off);
+
+        struct emitting_red
+        {
+            static constexpr auto conf = maki::default_state_conf
+                .enable_on_event_for<events::ping>()
+            ;
+
+            void on_event(const events::ping& /*event*/)
+            {
+                ctx.out += "emitting_red::on_event(ping);";
+            }
+
+            context& ctx;
+        };
+
+        EMPTY_STATE(emitting_green);
+
+        constexpr auto on_transition_table = maki::empty_transition_table
+            .add_c<states::emitting_red,   events::color_button_press, states::emitting_green>
+            .add_c<states::emitting_green, events::color_button_press, states::emitting_red>
+        ;
+
+        struct on
+        {
+            static constexpr auto conf = maki::default_submachine_conf
+                .set_transition_tables(on_transition_table)
+            ;
+        };
+    }
+
+    constexpr auto transition_table = maki::empty_transition_table
+        .add_c<states::off, events::power_button_press, states::on>
+        .add_c<states::on,  events::power_button_press, states::off>
+    ;
+
+    struct machine_def
+    {
+        static constexpr auto conf = maki::default_machine_conf
+            .set_transition_tables(transition_table)
+            .set_context<context>()
+        ;
+    };
+
+    using machine_t = maki::machine<machine_def>;
+
+    using event_variant = std::variant
+    <
+        events::power_button_press,
+        events::color_button_press,
+        events::ping,
+        events::ignored
+    >;
+
+    constexpr auto on_region_path = maki::region_path_c<machine_def, 0>.add<states::on, 0>();
+}
+
+TEST_CASE("process_variant_event")
+{
+    auto machine = machine_t{};
+    auto& ctx = machine.context();
+
+    REQUIRE(machine.is_active_state<states::off>());
+
+    machine.process_variant_event(event_variant{events::power_button_press{}});
+    REQUIRE(machine.is_active_state<states::on>());
+    REQUIRE(machine.is_active_state<on_region_path, states::emitting_red>());
+
+    machine.process_variant_event(event_variant{events::ping{}});
+    REQUIRE(ctx.out == "emitting_red::on_event(ping);");
+
+    machine.process_variant_event(event_variant{events::color_button_press{}});
+    REQUIRE(machine.is_active_state<on_region_path, states::emitting_green>());
+
+    machine.process_variant_event(event_variant{events::ignored{}});
+    REQUIRE(machine.is_active_state<on_region_path, states::emitting_green>());
+
+    machine.process_variant_event(event_variant{events::power_button_press{}});
+    REQUIRE(machine.is_active_state<states::off>());
+}
@@ -11,11 +11,12 @@ namespace
 {
     enum class new_operator_type
     {
+        none,
         plain,
         placement
     };
 
-    auto called_new_operator_type = new_operator_type::plain;
+    auto called_new_operator_type = new_operator_type::none;
 
     struct context
     {
@@ -77,6 +78,7 @@ namespace
             .set_context<context>()
             .set_small_event_max_size(SmallEventMaxSize)
             .set_small_event_max_align(SmallEventMaxAlign)
+            .set_post_event_queue_capacity(8)
         ;
     };
 
@@ -95,11 +97,24 @@ namespace
 
         machine.start();
 
+        //The run-to-completion queue stores every event inline, whatever its
+        //size
+        called_new_operator_type = new_operator_type::none;
         machine.process_event(event_processing_request<small_event>{});
-        REQUIRE(called_new_operator_type == expected_new_operator_type_for_small_event);
+        REQUIRE(called_new_operator_type == new_operator_type::none);
 
         machine.process_event(event_processing_request<big_event>{});
+        REQUIRE(called_new_operator_type == new_operator_type::none);
+
+        //The posted event queue stores small events only
+        REQUIRE(machine.post_event(small_event{}));
+        REQUIRE(called_new_operator_type == expected_new_operator_type_for_small_event);
+
+        called_new_operator_type = new_operator_type::none;
+        REQUIRE(machine.post_event(big_event{}));
         REQUIRE(called_new_operator_type == expected_new_operator_type_for_big_event);
+
+        machine.process_enqueued_events();
     }
 }
 
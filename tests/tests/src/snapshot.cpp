@@ -0,0 +1,285 @@
+//Copyright Florian Goujeon 2021 - 2023.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+#include <maki.hpp>
+#include "common.hpp"
+#include <type_traits>
+#include <string>
+#include <cstring>
+
+namespace
+{
+    struct context
+    {
+        std::string out;
+    };
+
+    namespace events
+    {
+        struct power_button_press{};
+        struct color_button_press{};
+        struct beep_button_press{};
+    }
+
+    namespace states
+    {
+        EMPTY_STATE(off);
+        EMPTY_STATE(silent);
+
+        struct beeping
+        {
+            static constexpr auto conf = maki::default_state_conf
+                .enable_on_entry()
+                .enable_on_exit()
+                .enable_lazy_construction()
+            ;
+
+            beeping(context& c):
+                ctx(c)
+            {
+                ctx.out += "construct_beeping;";
+            }
+
+            beeping(const beeping&) = delete;
+            beeping(beeping&&) = delete;
+            beeping& operator=(const beeping&) = delete;
+            beeping& operator=(beeping&&) = delete;
+
+            ~beeping()
+            {
+                ctx.out += "destroy_beeping;";
+            }
+
+            void on_entry()
+            {
+                ctx.out += "beeping;";
+            }
+
+            void on_exit()
+            {
+                ctx.out += "~beeping;";
+            }
+
+            context& ctx;
+        };
+
+        struct emitting_red
+        {
+            static constexpr auto conf = maki::default_state_conf
+                .enable_on_entry()
+                .enable_on_exit()
+            ;
+
+            void on_entry()
+            {
+                ctx.out += "red;";
+            }
+
+            void on_exit()
+            {
+                ctx.out += "~red;";
+            }
+
+            context& ctx;
+        };
+
+        EMPTY_STATE(emitting_green);
+        EMPTY_STATE(emitting_blue);
+
+        constexpr auto on_transition_table = maki::empty_transition_table
+            .add_c<emitting_red,   events::color_button_press, emitting_green>
+            .add_c<emitting_green, events::color_button_press, emitting_blue>
+            .add_c<emitting_blue,  events::color_button_press, emitting_red>
+        ;
+
+        struct on
+        {
+            static constexpr auto conf = maki::default_submachine_conf
+                .set_transition_tables(on_transition_table)
+            ;
+        };
+    }
+
+    constexpr auto power_transition_table = maki::empty_transition_table
+        .add_c<states::off, events::power_button_press, states::on>
+        .add_c<states::on,  events::power_button_press, states::off>
+    ;
+
+    constexpr auto beep_transition_table = maki::empty_transition_table
+        .add_c<states::silent,  events::beep_button_press, states::beeping>
+        .add_c<states::beeping, events::beep_button_press, states::silent>
+    ;
+
+    struct machine_def
+    {
+        static constexpr auto conf = maki::default_machine_conf
+            .set_transition_tables(power_transition_table, beep_transition_table)
+            .set_context<context>()
+        ;
+    };
+
+    using machine_t = maki::machine<machine_def>;
+
+    //Same as machine_def, without the beep region
+    struct other_machine_def
+    {
+        static constexpr auto conf = maki::default_machine_conf
+            .set_transition_tables(power_transition_table)
+            .set_context<context>()
+        ;
+    };
+
+    constexpr auto power_region_path = maki::region_path_c<machine_def, 0>;
+    constexpr auto beep_region_path = maki::region_path_c<machine_def, 1>;
+    constexpr auto on_region_path = power_region_path.add<states::on>();
+
+    using snapshot_t = machine_t::snapshot_type;
+
+    static_assert(std::is_trivially_copyable_v<snapshot_t>);
+    static_assert(std::is_standard_layout_v<snapshot_t>);
+    static_assert(std::tuple_size_v<decltype(snapshot_t::active_state_indexes)> == 3);
+    static_assert(sizeof(snapshot_t::active_state_indexes[0]) == 1);
+}
+
+TEST_CASE("snapshot")
+{
+    auto machine = machine_t{};
+    auto& ctx = machine.context();
+
+    machine.process_event(events::power_button_press{});
+    machine.process_event(events::color_button_press{});
+    machine.process_event(events::beep_button_press{});
+    REQUIRE(machine.is_active_state<on_region_path, states::emitting_green>());
+    REQUIRE(machine.is_active_state<beep_region_path, states::beeping>());
+
+    //Save to a raw buffer, just like a memory-mapped file would
+    unsigned char buffer[sizeof(snapshot_t)] = {}; //NOLINT(cppcoreguidelines-avoid-c-arrays)
+    {
+        const auto snap = machine.snapshot();
+        std::memcpy(buffer, &snap, sizeof(snap));
+    }
+
+    SECTION("restore into a new machine")
+    {
+        auto snap = snapshot_t{};
+        std::memcpy(&snap, buffer, sizeof(snap));
+
+        auto other_machine = machine_t{};
+        auto& other_ctx = other_machine.context();
+        other_ctx.out.clear();
+
+        REQUIRE(other_machine.restore(snap));
+
+        //No on_entry()/on_exit() call, but the lazy state is constructed
+        REQUIRE(other_ctx.out == "construct_beeping;");
+
+        REQUIRE(other_machine.is_active_state<power_region_path, states::on>());
+        REQUIRE(other_machine.is_active_state<on_region_path, states::emitting_green>());
+        REQUIRE(other_machine.is_active_state<beep_region_path, states::beeping>());
+
+        //The restored machine behaves normally
+        other_ctx.out.clear();
+        other_machine.process_event(events::color_button_press{});
+        other_machine.process_event(events::color_button_press{});
+        other_machine.process_event(events::beep_button_press{});
+        REQUIRE(other_machine.is_active_state<on_region_path, states::emitting_red>());
+        REQUIRE(other_machine.is_active_state<beep_region_path, states::silent>());
+        REQUIRE(other_ctx.out == "red;~beeping;destroy_beeping;");
+    }
+
+    SECTION("restore an older configuration")
+    {
+        const auto old_snap = [&buffer]
+        {
+            auto snap = snapshot_t{};
+            std::memcpy(&snap, buffer, sizeof(snap));
+            return snap;
+        }();
+
+        machine.process_event(events::beep_button_press{});
+        machine.process_event(events::power_button_press{});
+        REQUIRE(machine.is_active_state<power_region_path, states::off>());
+        REQUIRE(!machine.is_running<on_region_path>());
+
+        ctx.out.clear();
+        REQUIRE(machine.restore(old_snap));
+        REQUIRE(ctx.out == "construct_beeping;");
+        REQUIRE(machine.is_active_state<on_region_path, states::emitting_green>());
+        REQUIRE(machine.is_active_state<beep_region_path, states::beeping>());
+
+        //Restoring the current configuration of a lazy state gives a new object
+        ctx.out.clear();
+        REQUIRE(machine.restore(machine.snapshot()));
+        REQUIRE(ctx.out == "destroy_beeping;construct_beeping;");
+    }
+
+    SECTION("stopped machine")
+    {
+        machine.stop();
+        const auto snap = machine.snapshot();
+
+        auto other_machine = machine_t{};
+        REQUIRE(other_machine.restore(snap));
+        REQUIRE(!other_machine.is_running<power_region_path>());
+        REQUIRE(!other_machine.is_running<beep_region_path>());
+
+        other_machine.start();
+        REQUIRE(other_machine.is_active_state<power_region_path, states::off>());
+    }
+
+    SECTION("invalid snapshots")
+    {
+        auto snap = machine.snapshot();
+
+        //Layout mismatch
+        {
+            auto other_snap = maki::machine<other_machine_def>{}.snapshot();
+            REQUIRE(other_snap.layout_hash != snap.layout_hash);
+        }
+
+        //Out-of-range state index
+        snap.active_state_indexes[2] = 42;
+        ctx.out.clear();
+        REQUIRE(!machine.restore(snap));
+        REQUIRE(ctx.out.empty());
+        REQUIRE(machine.is_active_state<on_region_path, states::emitting_green>());
+
+        //Wrong hash
+        snap = machine.snapshot();
+        ++snap.layout_hash;
+        REQUIRE(!machine.restore(snap));
+
+        //Flat region indexes: 0 = power, 1 = on, 2 = beep
+        constexpr auto off_index = 0;
+        constexpr auto power_stopped_index = 2;
+        constexpr auto on_stopped_index = 3;
+
+        //Running region of an inactive submachine
+        snap = machine.snapshot();
+        snap.active_state_indexes[0] = off_index;
+        REQUIRE(!machine.restore(snap));
+
+        //Stopped region of an active submachine
+        snap = machine.snapshot();
+        snap.active_state_indexes[1] = on_stopped_index;
+        REQUIRE(!machine.restore(snap));
+
+        //Partially stopped machine
+        snap = machine.snapshot();
+        snap.active_state_indexes[0] = power_stopped_index;
+        snap.active_state_indexes[1] = on_stopped_index;
+        REQUIRE(!machine.restore(snap));
+
+        REQUIRE(ctx.out.empty());
+        REQUIRE(machine.is_active_state<on_region_path, states::emitting_green>());
+
+        //Same as above, with the submachine consistently stopped
+        snap.active_state_indexes[0] = off_index;
+        REQUIRE(machine.restore(snap));
+        REQUIRE(machine.is_active_state<power_region_path, states::off>());
+        REQUIRE(!machine.is_running<on_region_path>());
+    }
+}
@@ -0,0 +1,119 @@
+//Copyright Florian Goujeon 2021 - 2023.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+#include <maki.hpp>
+#include "common.hpp"
+
+namespace
+{
+    //More states than the bits of a single mask word
+    constexpr auto step_state_count = 70;
+
+    struct context
+    {
+        int reset_count = 0;
+    };
+
+    namespace events
+    {
+        struct next{};
+        struct reset{};
+    }
+
+    namespace states
+    {
+        EMPTY_STATE(idle);
+
+        template<int Index>
+        struct step
+        {
+            static constexpr auto conf = maki::default_state_conf;
+        };
+
+        using odd_step = maki::any_of<step<1>, step<33>, step<65>, step<69>>;
+    }
+
+    namespace actions
+    {
+        void count_reset(context& ctx)
+        {
+            ++ctx.reset_count;
+        }
+    }
+
+    //idle -> step<0> -> step<1> -> ... -> step<step_state_count - 1>
+    template<int Index, class TransitionTable>
+    constexpr auto add_steps(const TransitionTable& table)
+    {
+        if constexpr(Index == step_state_count - 1)
+        {
+            return table;
+        }
+        else
+        {
+            return add_steps<Index + 1>
+            (
+                table.template add_c<states::step<Index>, events::next, states::step<Index + 1>>
+            );
+        }
+    }
+
+    constexpr auto transition_table = add_steps<0>
+    (
+        maki::empty_transition_table
+            .add_c<states::idle, events::next, states::step<0>>
+            .add_c<maki::any_but<states::idle>, events::reset, states::idle, actions::count_reset>
+    );
+
+    struct machine_def
+    {
+        static constexpr auto conf = maki::default_machine_conf
+            .set_transition_tables(transition_table)
+            .set_context<context>()
+        ;
+    };
+
+    using machine_t = maki::machine<machine_def>;
+}
+
+TEST_CASE("state_pattern_mask")
+{
+    auto machine = machine_t{};
+    auto& ctx = machine.context();
+
+    REQUIRE(machine.is_active_state<states::idle>());
+    REQUIRE(!machine.is_active_state<maki::any_but<states::idle>>());
+
+    //any_but<idle> doesn't match idle
+    machine.process_event(events::reset{});
+    REQUIRE(ctx.reset_count == 0);
+
+    for(auto i = 0; i < step_state_count; ++i)
+    {
+        machine.process_event(events::next{});
+        REQUIRE(machine.is_active_state<maki::any_but<states::idle>>());
+        REQUIRE(machine.is_active_state<states::odd_step>() == (i == 1 || i == 33 || i == 65 || i == 69));
+    }
+    REQUIRE(machine.is_active_state<states::step<step_state_count - 1>>());
+
+    //From the last state, whose index lies in the second mask word
+    machine.process_event(events::reset{});
+    REQUIRE(machine.is_active_state<states::idle>());
+    REQUIRE(ctx.reset_count == 1);
+
+    //From a state of the first mask word
+    machine.process_event(events::next{});
+    machine.process_event(events::next{});
+    REQUIRE(machine.is_active_state<states::step<1>>());
+    machine.process_event(events::reset{});
+    REQUIRE(machine.is_active_state<states::idle>());
+    REQUIRE(ctx.reset_count == 2);
+
+    //The stopped pseudo-state is covered by the mask as well
+    machine.stop();
+    REQUIRE(machine.is_active_state<maki::any_but<states::idle>>());
+    REQUIRE(!machine.is_active_state<states::odd_step>());
+}
@@ -0,0 +1,407 @@
+//Copyright Florian Goujeon 2021 - 2023.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+#include <maki.hpp>
+#include "common.hpp"
+#include <chrono>
+#include <ratio>
+#include <cstdint>
+#include <string>
+#include <memory>
+#include <type_traits>
+
+namespace
+{
+    //A clock that returns a virtual time
+    struct manual_clock
+    {
+        using duration = std::chrono::milliseconds;
+        using rep = duration::rep;
+        using period = duration::period;
+        using time_point = std::chrono::time_point<manual_clock>;
+        static constexpr bool is_steady = true;
+
+        static time_point now()
+        {
+            return current_time;
+        }
+
+        static void advance(const duration d)
+        {
+            current_time += d;
+        }
+
+        static inline time_point current_time; //NOLINT(cppcoreguidelines-avoid-non-const-global-variables)
+    };
+
+    struct context
+    {
+        std::string out;
+    };
+
+    namespace events
+    {
+        struct connect{};
+        struct connection_success{};
+        struct pairing_success{};
+    }
+
+    namespace actions
+    {
+        void log_connection_timeout(context& ctx)
+        {
+            ctx.out += "connection_timeout;";
+        }
+
+        void log_pairing_timeout(context& ctx)
+        {
+            ctx.out += "pairing_timeout;";
+        }
+    }
+
+    namespace states
+    {
+        EMPTY_STATE(idle);
+
+        struct connecting
+        {
+            static constexpr auto conf = maki::default_state_conf
+                .set_timeout<std::chrono::milliseconds, 500>()
+                .enable_on_entry()
+                .enable_on_exit()
+            ;
+
+            void on_entry()
+            {
+                ctx.out += "connecting;";
+            }
+
+            void on_exit()
+            {
+                ctx.out += "~connecting;";
+            }
+
+            context& ctx;
+        };
+
+        struct pairing
+        {
+            static constexpr auto conf = maki::default_state_conf
+                .set_timeout<std::chrono::seconds, 1>()
+            ;
+        };
+
+        EMPTY_STATE(paired);
+
+        constexpr auto connected_transition_table = maki::empty_transition_table
+            .add_c<pairing, events::pairing_success,        paired>
+            .add_c<pairing, maki::events::timeout<pairing>, pairing, actions::log_pairing_timeout>
+        ;
+
+        //The pairing state is retried every second
+        struct connected
+        {
+            static constexpr auto conf = maki::default_submachine_conf
+                .set_transition_tables(connected_transition_table)
+            ;
+        };
+    }
+
+    constexpr auto transition_table = maki::empty_transition_table
+        .add_c<states::idle,       events::connect,                           states::connecting>
+        .add_c<states::connecting, events::connection_success,                states::connected>
+        .add_c<states::connecting, maki::events::timeout<states::connecting>, states::idle,      actions::log_connection_timeout>
+    ;
+
+    struct machine_def
+    {
+        static constexpr auto conf = maki::default_machine_conf
+            .set_transition_tables(transition_table)
+            .set_context<context>()
+            .set_clock<manual_clock>()
+        ;
+    };
+
+    using machine_t = maki::machine<machine_def>;
+
+    //The same timed state in two regions
+    namespace orthogonal
+    {
+        namespace events
+        {
+            struct blink_0{};
+            struct blink_1{};
+        }
+
+        namespace states
+        {
+            EMPTY_STATE(idle);
+
+            struct blinking
+            {
+                static constexpr auto conf = maki::default_state_conf
+                    .set_timeout<std::chrono::milliseconds, 100>()
+                ;
+            };
+        }
+
+        namespace actions
+        {
+            void log_timeout_0(context& ctx)
+            {
+                ctx.out += "timeout_0;";
+            }
+
+            void log_timeout_1(context& ctx)
+            {
+                ctx.out += "timeout_1;";
+            }
+        }
+
+        constexpr auto transition_table_0 = maki::empty_transition_table
+            .add_c<states::idle,     events::blink_0,                         states::blinking>
+            .add_c<states::blinking, maki::events::timeout<states::blinking>, states::idle,     actions::log_timeout_0>
+        ;
+
+        constexpr auto transition_table_1 = maki::empty_transition_table
+            .add_c<states::idle,     events::blink_1,                         states::blinking>
+            .add_c<states::blinking, maki::events::timeout<states::blinking>, states::idle,     actions::log_timeout_1>
+        ;
+
+        struct machine_def
+        {
+            static constexpr auto conf = maki::default_machine_conf
+                .set_transition_tables(transition_table_0, transition_table_1)
+                .set_context<context>()
+                .set_clock<manual_clock>()
+            ;
+        };
+
+        constexpr auto region_0_path = maki::region_path_c<machine_def, 0>;
+        constexpr auto region_1_path = maki::region_path_c<machine_def, 1>;
+    }
+
+    //Same as machine_def, with a timeout resolution that is longer than the
+    //period of the clock
+    struct coarse_machine_def
+    {
+        static constexpr auto conf = maki::default_machine_conf
+            .set_transition_tables(transition_table)
+            .set_context<context>()
+            .set_clock<manual_clock>()
+            .set_timeout_resolution<std::chrono::duration<std::int64_t, std::ratio<1, 100>>>()
+        ;
+    };
+
+    constexpr auto connected_region_path = maki::region_path_c<machine_def>.add<states::connected>();
+
+    struct no_timeout_machine_def
+    {
+        static constexpr auto conf = maki::default_machine_conf
+            .set_transition_tables(maki::empty_transition_table.add_c<states::idle, events::connect, states::paired>)
+            .set_context<context>()
+        ;
+    };
+
+    using no_timeout_machine_t = maki::machine<no_timeout_machine_def>;
+
+    template<class Derived, class Base>
+    constexpr bool is_empty_base_of()
+    {
+        return std::is_empty_v<Base> && std::is_base_of_v<Base, Derived>;
+    }
+
+    //Without any timed state, neither the machine nor its regions hold any
+    //timeout data: they only derive from empty bases
+    static_assert
+    (
+        is_empty_base_of
+        <
+            no_timeout_machine_t,
+            maki::detail::timeout_scheduler_holder
+            <
+                typename std::decay_t<decltype(no_timeout_machine_def::conf.clock)>::type,
+                typename std::decay_t<decltype(no_timeout_machine_def::conf.timeout_resolution)>::type,
+                false
+            >
+        >()
+    );
+    static_assert(sizeof(no_timeout_machine_t) != 0); //Completes the machine type
+    static_assert
+    (
+        is_empty_base_of
+        <
+            maki::detail::region<maki::detail::submachine<no_timeout_machine_def, void>, 0>,
+            maki::detail::region_timeout_timer<false>
+        >()
+    );
+}
+
+TEST_CASE("state_timeout")
+{
+    using std::chrono::milliseconds;
+
+    auto machine = machine_t{};
+    auto& ctx = machine.context();
+
+    SECTION("timeout")
+    {
+        machine.process_event(events::connect{});
+        REQUIRE(ctx.out == "connecting;");
+
+        manual_clock::advance(milliseconds{499});
+        REQUIRE(machine.process_timeouts() == 0);
+        REQUIRE(machine.is_active_state<states::connecting>());
+
+        manual_clock::advance(milliseconds{1});
+        REQUIRE(machine.process_timeouts() == 1);
+        REQUIRE(machine.is_active_state<states::idle>());
+        REQUIRE(ctx.out == "connecting;~connecting;connection_timeout;");
+
+        manual_clock::advance(milliseconds{1000});
+        REQUIRE(machine.process_timeouts() == 0);
+    }
+
+    SECTION("exit before timeout")
+    {
+        machine.process_event(events::connect{});
+        manual_clock::advance(milliseconds{400});
+        machine.process_event(events::connection_success{});
+        REQUIRE(machine.is_active_state<states::connected>());
+
+        manual_clock::advance(milliseconds{100});
+        REQUIRE(machine.process_timeouts() == 0);
+        REQUIRE(ctx.out == "connecting;~connecting;");
+    }
+
+    SECTION("reentry rearms the timer")
+    {
+        machine.process_event(events::connect{});
+        machine.process_event(events::connection_success{});
+        REQUIRE(machine.is_active_state<connected_region_path, states::pairing>());
+
+        //Timeout of a state of a submachine, whose self-transition rearms the
+        //timer
+        manual_clock::advance(milliseconds{1000});
+        REQUIRE(machine.process_timeouts() == 1);
+        REQUIRE(ctx.out == "connecting;~connecting;pairing_timeout;");
+
+        manual_clock::advance(milliseconds{999});
+        REQUIRE(machine.process_timeouts() == 0);
+
+        manual_clock::advance(milliseconds{1});
+        REQUIRE(machine.process_timeouts() == 1);
+        REQUIRE(ctx.out == "connecting;~connecting;pairing_timeout;pairing_timeout;");
+
+        machine.process_event(events::pairing_success{});
+        manual_clock::advance(milliseconds{5000});
+        REQUIRE(machine.process_timeouts() == 0);
+    }
+
+    SECTION("stop")
+    {
+        machine.process_event(events::connect{});
+        machine.stop();
+
+        manual_clock::advance(milliseconds{1000});
+        REQUIRE(machine.process_timeouts() == 0);
+        REQUIRE(ctx.out == "connecting;~connecting;");
+    }
+
+    SECTION("restore")
+    {
+        machine.process_event(events::connect{});
+        const auto snap = machine.snapshot();
+
+        //The restored state gets a whole new timeout
+        manual_clock::advance(milliseconds{400});
+        auto other_machine = machine_t{maki::warm_start, snap};
+        manual_clock::advance(milliseconds{400});
+        REQUIRE(other_machine.process_timeouts() == 0);
+        manual_clock::advance(milliseconds{100});
+        REQUIRE(other_machine.process_timeouts() == 1);
+        REQUIRE(other_machine.is_active_state<states::idle>());
+    }
+
+    SECTION("fractional resolution")
+    {
+        auto other_machine = maki::machine<coarse_machine_def>{};
+
+        //Enter the state in the middle of a tick (5 ms into a 10 ms tick)
+        manual_clock::advance(milliseconds{5});
+        other_machine.process_event(events::connect{});
+
+        //The timeout hasn't elapsed yet, even though we've reached its tick
+        manual_clock::advance(milliseconds{495});
+        REQUIRE(other_machine.process_timeouts() == 0);
+        REQUIRE(other_machine.is_active_state<states::connecting>());
+
+        //The timeout has elapsed, but the expiry is rounded up to the next
+        //tick
+        manual_clock::advance(milliseconds{9});
+        REQUIRE(other_machine.process_timeouts() == 0);
+
+        manual_clock::advance(milliseconds{1});
+        REQUIRE(other_machine.process_timeouts() == 1);
+        REQUIRE(other_machine.is_active_state<states::idle>());
+    }
+
+    SECTION("same state in two regions")
+    {
+        namespace orth = orthogonal;
+
+        auto other_machine = maki::machine<orth::machine_def>{};
+        auto& other_ctx = other_machine.context();
+
+        other_machine.process_event(orth::events::blink_0{});
+        manual_clock::advance(milliseconds{50});
+        other_machine.process_event(orth::events::blink_1{});
+
+        //The timeout of region 0 doesn't affect region 1
+        manual_clock::advance(milliseconds{50});
+        REQUIRE(other_machine.process_timeouts() == 1);
+        REQUIRE(other_ctx.out == "timeout_0;");
+        REQUIRE(other_machine.is_active_state<orth::region_0_path, orth::states::idle>());
+        REQUIRE(other_machine.is_active_state<orth::region_1_path, orth::states::blinking>());
+
+        manual_clock::advance(milliseconds{50});
+        REQUIRE(other_machine.process_timeouts() == 1);
+        REQUIRE(other_ctx.out == "timeout_0;timeout_1;");
+        REQUIRE(other_machine.is_active_state<orth::region_1_path, orth::states::idle>());
+
+        //A timeout event that doesn't come from a timer is processed by every
+        //region
+        other_machine.process_event(orth::events::blink_0{});
+        other_machine.process_event(orth::events::blink_1{});
+        other_ctx.out.clear();
+        other_machine.process_event(maki::events::timeout<orth::states::blinking>{});
+        REQUIRE(other_ctx.out == "timeout_0;timeout_1;");
+    }
+
+    SECTION("destruction with pending timeout")
+    {
+        //The timers of the regions are disarmed before the regions are
+        //destroyed, so that the scheduler doesn't touch them afterwards
+        auto porth_machine = std::make_unique<maki::machine<orthogonal::machine_def>>();
+        porth_machine->process_event(orthogonal::events::blink_0{});
+        porth_machine->process_event(orthogonal::events::blink_1{});
+        porth_machine.reset();
+
+        //Same with a timed state of a submachine
+        auto pother_machine = std::make_unique<machine_t>();
+        pother_machine->process_event(events::connect{});
+        pother_machine->process_event(events::connection_success{});
+        REQUIRE(pother_machine->is_active_state<connected_region_path, states::pairing>());
+        pother_machine.reset();
+    }
+
+    SECTION("no timeout")
+    {
+        auto other_machine = maki::machine<no_timeout_machine_def>{};
+        other_machine.process_event(events::connect{});
+        REQUIRE(other_machine.process_timeouts() == 0);
+    }
+}
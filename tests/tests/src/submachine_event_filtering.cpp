@@ -0,0 +1,181 @@
+//Copyright Florian Goujeon 2021 - 2023.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+#include <maki.hpp>
+#include "common.hpp"
+#include <string>
+
+namespace
+{
+    struct context
+    {
+        std::string out;
+    };
+
+    namespace events
+    {
+        struct power_button_press{};
+        struct outer_event{};
+        struct outer_def_event{};
+        struct inner_event{};
+        struct unhandled{};
+    }
+
+    namespace actions
+    {
+        void log_outer_event(context& ctx)
+        {
+            ctx.out += "outer_event;";
+        }
+
+        void log_inner_event(context& ctx)
+        {
+            ctx.out += "inner_event;";
+        }
+    }
+
+    namespace states
+    {
+        EMPTY_STATE(off);
+        EMPTY_STATE(outer_idle);
+        EMPTY_STATE(inner_idle);
+        EMPTY_STATE(inner_active);
+
+        constexpr auto inner_transition_table = maki::empty_transition_table
+            .add_c<inner_idle,   events::inner_event, inner_active, actions::log_inner_event>
+            .add_c<inner_active, events::inner_event, inner_idle,   actions::log_inner_event>
+        ;
+
+        struct inner
+        {
+            static constexpr auto conf = maki::default_submachine_conf
+                .set_transition_tables(inner_transition_table)
+            ;
+        };
+
+        constexpr auto outer_transition_table = maki::empty_transition_table
+            .add_c<outer_idle, events::outer_event, inner,      actions::log_outer_event>
+            .add_c<inner,      events::outer_event, outer_idle, actions::log_outer_event>
+        ;
+
+        struct outer
+        {
+            static constexpr auto conf = maki::default_submachine_conf
+                .set_transition_tables(outer_transition_table)
+                .enable_on_event_for<events::outer_def_event>()
+            ;
+
+            void on_event(const events::outer_def_event& /*event*/)
+            {
+                ctx.out += "outer_def_event;";
+            }
+
+            context& ctx;
+        };
+    }
+
+    constexpr auto transition_table = maki::empty_transition_table
+        .add_c<states::off,   events::power_button_press, states::outer>
+        .add_c<states::outer, events::power_button_press, states::off>
+    ;
+
+    struct machine_def
+    {
+        static constexpr auto conf = maki::default_machine_conf
+            .set_transition_tables(transition_table)
+            .set_context<context>()
+            .enable_on_unprocessed()
+        ;
+
+        template<class Event>
+        void on_unprocessed(const Event& /*event*/)
+        {
+            ctx.out += "unprocessed;";
+        }
+
+        context& ctx;
+    };
+
+    using machine_t = maki::machine<machine_def>;
+
+    template<class State, class Event>
+    constexpr bool handles_event()
+    {
+        //The machine type must be complete before its root submachine type
+        static_assert(sizeof(machine_t) != 0);
+        return maki::detail::state_traits::handles_event_v<State, Event>;
+    }
+
+    using root_sm_t = maki::detail::submachine<machine_def, void>;
+    using outer_t = maki::detail::submachine<states::outer, maki::detail::region<root_sm_t, 0>>;
+    using inner_t = maki::detail::submachine<states::inner, maki::detail::region<outer_t, 0>>;
+
+    //Events handled in the subtree, at any depth
+    static_assert(handles_event<outer_t, events::outer_event>());
+    static_assert(handles_event<outer_t, events::outer_def_event>());
+    static_assert(handles_event<outer_t, events::inner_event>());
+    static_assert(handles_event<inner_t, events::inner_event>());
+
+    //Events that the subtree can't handle, even though the machine handles
+    //everything (because of on_unprocessed())
+    static_assert(machine_t::handles_event_v<events::unhandled>);
+    static_assert(!handles_event<outer_t, events::power_button_press>());
+    static_assert(!handles_event<outer_t, events::unhandled>());
+    static_assert(!handles_event<inner_t, events::outer_event>());
+    static_assert(!handles_event<inner_t, events::outer_def_event>());
+    static_assert(!handles_event<inner_t, events::unhandled>());
+
+    constexpr auto outer_region_path = maki::region_path_c<machine_def>.add<states::outer>();
+    constexpr auto inner_region_path = outer_region_path.add<states::inner>();
+}
+
+TEST_CASE("submachine_event_filtering")
+{
+    auto machine = machine_t{};
+    auto& ctx = machine.context();
+
+    machine.process_event(events::power_button_press{});
+    REQUIRE(machine.is_active_state<outer_region_path, states::outer_idle>());
+
+    //Event that no state can handle
+    ctx.out.clear();
+    machine.process_event(events::unhandled{});
+    REQUIRE(ctx.out == "unprocessed;");
+
+    //Event of a nested submachine that isn't active
+    ctx.out.clear();
+    machine.process_event(events::inner_event{});
+    REQUIRE(ctx.out == "unprocessed;");
+
+    //Event of a submachine definition
+    ctx.out.clear();
+    machine.process_event(events::outer_def_event{});
+    REQUIRE(ctx.out == "outer_def_event;");
+
+    //Event of the outer submachine, which activates the inner one
+    ctx.out.clear();
+    machine.process_event(events::outer_event{});
+    REQUIRE(ctx.out == "outer_event;");
+    REQUIRE(machine.is_active_state<inner_region_path, states::inner_idle>());
+
+    //Event of the nested submachine, now active
+    ctx.out.clear();
+    machine.process_event(events::inner_event{});
+    REQUIRE(ctx.out == "inner_event;");
+    REQUIRE(machine.is_active_state<inner_region_path, states::inner_active>());
+
+    //Still unhandled
+    ctx.out.clear();
+    machine.process_event(events::unhandled{});
+    REQUIRE(ctx.out == "unprocessed;");
+    REQUIRE(machine.is_active_state<inner_region_path, states::inner_active>());
+
+    //Event of the root, which isn't dispatched to the submachines
+    ctx.out.clear();
+    machine.process_event(events::power_button_press{});
+    REQUIRE(ctx.out.empty());
+    REQUIRE(machine.is_active_state<states::off>());
+}
@@ -0,0 +1,388 @@
+//Copyright Florian Goujeon 2021 - 2023.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+#include <maki.hpp>
+#include "common.hpp"
+#include <chrono>
+#include <ratio>
+#include <array>
+#include <vector>
+#include <string>
+#include <cstdint>
+
+namespace
+{
+    //A clock that returns a virtual time
+    struct manual_clock
+    {
+        using duration = std::chrono::milliseconds;
+        using rep = duration::rep;
+        using period = duration::period;
+        using time_point = std::chrono::time_point<manual_clock>;
+        static constexpr bool is_steady = true;
+
+        [[nodiscard]] time_point now() const
+        {
+            return *pnow;
+        }
+
+        const time_point* pnow = nullptr;
+    };
+
+    struct timer_service_def
+    {
+        static constexpr auto conf = maki::default_timer_service_conf
+            .set_clock<manual_clock>()
+            .set_capacity(256)
+        ;
+    };
+
+    using timer_service_t = maki::timer_service<timer_service_def>;
+
+    //Timer service whose tick is longer than the period of the clock
+    struct coarse_timer_service_def
+    {
+        static constexpr auto conf = maki::default_timer_service_conf
+            .set_clock<manual_clock>()
+            .set_tick<std::chrono::duration<std::int64_t, std::ratio<1, 100>>>()
+        ;
+    };
+
+    using coarse_timer_service_t = maki::timer_service<coarse_timer_service_def>;
+
+    struct context
+    {
+        context(timer_service_t& t, const manual_clock::time_point& n):
+            timers(t),
+            now(n)
+        {
+        }
+
+        timer_service_t& timers;
+        const manual_clock::time_point& now;
+        std::string out;
+        std::vector<std::pair<int, std::int64_t>> rings; //Ring ID, ring time
+        maki::timer_handle beep_timer;
+    };
+
+    namespace events
+    {
+        struct ring
+        {
+            int id = 0;
+        };
+
+        struct large_ring
+        {
+            std::array<char, 64> text = {};
+        };
+
+        struct power_button_press{};
+        struct beep{};
+    }
+
+    namespace states
+    {
+        EMPTY_STATE(off);
+
+        struct on
+        {
+            static constexpr auto conf = maki::default_state_conf
+                .enable_on_entry()
+                .enable_on_exit()
+            ;
+
+            template<class Machine, class Event>
+            void on_entry(Machine& mach, const Event& /*event*/)
+            {
+                ctx.beep_timer = ctx.timers.schedule_event(mach, std::chrono::seconds{1}, events::beep{});
+            }
+
+            void on_exit()
+            {
+                ctx.timers.cancel(ctx.beep_timer);
+            }
+
+            context& ctx;
+        };
+    }
+
+    namespace actions
+    {
+        void record_ring(context& ctx, const events::ring& event)
+        {
+            ctx.rings.emplace_back(event.id, ctx.now.time_since_epoch().count());
+        }
+
+        void record_large_ring(context& ctx, const events::large_ring& event)
+        {
+            ctx.out += event.text.data();
+        }
+
+        constexpr auto beep = [](auto& mach, context& ctx, const events::beep& /*event*/)
+        {
+            ctx.out += "beep;";
+
+            //Reschedule from within the processing of the event
+            ctx.beep_timer = ctx.timers.schedule_event(mach, std::chrono::seconds{1}, events::beep{});
+        };
+    }
+
+    constexpr auto transition_table = maki::empty_transition_table
+        .add_c<states::off, events::power_button_press, states::on>
+        .add_c<states::on,  events::power_button_press, states::off>
+        .add_c<states::on,  events::beep,               maki::null,  actions::beep>
+        .add_c<maki::any,   events::ring,               maki::null,  actions::record_ring>
+        .add_c<maki::any,   events::large_ring,         maki::null,  actions::record_large_ring>
+    ;
+
+    struct machine_def
+    {
+        static constexpr auto conf = maki::default_machine_conf
+            .set_transition_tables(transition_table)
+            .set_context<context>()
+        ;
+    };
+
+    using machine_t = maki::machine<machine_def>;
+
+    struct fixture
+    {
+        manual_clock::time_point now;
+        timer_service_t timers{manual_clock{&now}};
+        machine_t machine{timers, now};
+
+        void advance(const std::chrono::milliseconds duration)
+        {
+            now += duration;
+            timers.poll();
+        }
+    };
+}
+
+TEST_CASE("timer_service")
+{
+    auto fix = fixture{};
+    auto& timers = fix.timers;
+    auto& machine = fix.machine;
+    auto& ctx = machine.context();
+
+    using std::chrono::milliseconds;
+    using std::chrono::seconds;
+    using std::chrono::hours;
+
+    SECTION("basic scheduling")
+    {
+        const auto handle = timers.schedule_event(machine, milliseconds{100}, events::ring{1});
+        REQUIRE(!handle.is_null());
+        REQUIRE(timers.is_pending(handle));
+        REQUIRE(timers.pending_count() == 1);
+
+        fix.advance(milliseconds{99});
+        REQUIRE(ctx.rings.empty());
+
+        fix.advance(milliseconds{1});
+        REQUIRE(ctx.rings.size() == 1);
+        REQUIRE(ctx.rings[0].first == 1);
+        REQUIRE(ctx.rings[0].second == 100);
+        REQUIRE(!timers.is_pending(handle));
+        REQUIRE(timers.pending_count() == 0);
+
+        //Expired handles can't cancel anything
+        REQUIRE(!timers.cancel(handle));
+    }
+
+    SECTION("cancellation")
+    {
+        const auto handle1 = timers.schedule_event(machine, milliseconds{100}, events::ring{1});
+        const auto handle2 = timers.schedule_event(machine, milliseconds{100}, events::ring{2});
+
+        REQUIRE(timers.cancel(handle1));
+        REQUIRE(!timers.cancel(handle1));
+        REQUIRE(!timers.is_pending(handle1));
+        REQUIRE(timers.is_pending(handle2));
+
+        //The timer of handle1 is reused, but handle1 doesn't refer to it
+        const auto handle3 = timers.schedule_event(machine, milliseconds{50}, events::ring{3});
+        REQUIRE(!timers.is_pending(handle1));
+        REQUIRE(!timers.cancel(handle1));
+        REQUIRE(timers.is_pending(handle3));
+
+        fix.advance(milliseconds{200});
+        REQUIRE(ctx.rings == std::vector<std::pair<int, std::int64_t>>{{3, 200}, {2, 200}});
+
+        REQUIRE(!timers.cancel(maki::timer_handle{}));
+    }
+
+    SECTION("long delays")
+    {
+        //Some of these delays are out of the range of the wheel (2^24 ticks)
+        timers.schedule_event(machine, hours{10}, events::ring{4});
+        timers.schedule_event(machine, seconds{5}, events::ring{2});
+        timers.schedule_event(machine, hours{3}, events::ring{3});
+        timers.schedule_event(machine, milliseconds{10}, events::ring{1});
+
+        fix.advance(hours{2});
+        REQUIRE(ctx.rings == std::vector<std::pair<int, std::int64_t>>{{1, 7'200'000}, {2, 7'200'000}});
+
+        fix.advance(milliseconds{3'600'000 - 1});
+        REQUIRE(ctx.rings.size() == 2);
+
+        fix.advance(milliseconds{1});
+        REQUIRE(ctx.rings.size() == 3);
+        REQUIRE(ctx.rings.back() == std::pair<int, std::int64_t>{3, 10'800'000});
+
+        fix.advance(milliseconds{25'200'000 - 1});
+        REQUIRE(ctx.rings.size() == 3);
+
+        fix.advance(milliseconds{1});
+        REQUIRE(ctx.rings.size() == 4);
+        REQUIRE(ctx.rings.back() == std::pair<int, std::int64_t>{4, 36'000'000});
+    }
+
+    SECTION("expiry order and accuracy")
+    {
+        //Pseudo-random delays and polling intervals
+        auto seed = std::uint32_t{42};
+        auto next_random = [&seed](const std::uint32_t max)
+        {
+            seed = seed * 1'664'525U + 1'013'904'223U;
+            return static_cast<std::int64_t>((seed >> 8U) % max);
+        };
+
+        auto expiries = std::vector<std::int64_t>{};
+        for(auto i = 0; i < 200; ++i)
+        {
+            const auto delay = next_random(2'000'000);
+            expiries.push_back(delay);
+            timers.schedule_event(machine, milliseconds{delay}, events::ring{i});
+        }
+
+        auto last_poll_time = std::int64_t{0};
+        while(timers.pending_count() != 0)
+        {
+            const auto ring_count = ctx.rings.size();
+
+            fix.advance(milliseconds{1 + next_random(20'000)});
+            const auto poll_time = fix.now.time_since_epoch().count();
+
+            for(auto i = ring_count; i < ctx.rings.size(); ++i)
+            {
+                const auto expiry = expiries[static_cast<std::size_t>(ctx.rings[i].first)];
+                REQUIRE(expiry > last_poll_time);
+                REQUIRE(expiry <= poll_time);
+                if(i != 0)
+                {
+                    REQUIRE(expiries[static_cast<std::size_t>(ctx.rings[i - 1].first)] <= expiry);
+                }
+            }
+
+            last_poll_time = poll_time;
+        }
+
+        REQUIRE(ctx.rings.size() == 200);
+    }
+
+    SECTION("same expiry")
+    {
+        using rings_t = std::vector<std::pair<int, std::int64_t>>;
+
+        //Timers that expire on the same tick fire in scheduling order, whether
+        //they're in the lowest level of the wheel...
+        for(auto i = 0; i < 4; ++i)
+        {
+            timers.schedule_event(machine, milliseconds{10}, events::ring{i});
+        }
+        fix.advance(milliseconds{10});
+        REQUIRE(ctx.rings == rings_t{{0, 10}, {1, 10}, {2, 10}, {3, 10}});
+
+        //... or cascaded down from higher levels
+        ctx.rings.clear();
+        for(auto i = 0; i < 4; ++i)
+        {
+            timers.schedule_event(machine, milliseconds{100'000}, events::ring{i});
+        }
+        fix.advance(milliseconds{100'000});
+        REQUIRE(ctx.rings == rings_t{{0, 100'010}, {1, 100'010}, {2, 100'010}, {3, 100'010}});
+
+        //A timer that has been cascaded down fires before a timer that has
+        //been scheduled later for the same tick, directly into the lowest level
+        ctx.rings.clear();
+        timers.schedule_event(machine, milliseconds{1000}, events::ring{0});
+        timers.schedule_event(machine, milliseconds{1000}, events::ring{1});
+        fix.advance(milliseconds{990});
+        timers.schedule_event(machine, milliseconds{10}, events::ring{2});
+        timers.schedule_event(machine, milliseconds{10}, events::ring{3});
+        fix.advance(milliseconds{10});
+        REQUIRE(ctx.rings == rings_t{{0, 101'010}, {1, 101'010}, {2, 101'010}, {3, 101'010}});
+    }
+
+    SECTION("fractional tick")
+    {
+        auto coarse_timers = coarse_timer_service_t{manual_clock{&fix.now}};
+
+        //Schedule in the middle of a tick (5 ms into a 10 ms tick)
+        fix.now += milliseconds{5};
+        coarse_timers.schedule_event(machine, milliseconds{10}, events::ring{1});
+
+        //The delay hasn't elapsed yet, even though we've reached the next tick
+        fix.now += milliseconds{5};
+        REQUIRE(coarse_timers.poll() == 0);
+
+        //The delay has elapsed, but the expiry is rounded up to the next tick
+        fix.now += milliseconds{9};
+        REQUIRE(coarse_timers.poll() == 0);
+
+        fix.now += milliseconds{1};
+        REQUIRE(coarse_timers.poll() == 1);
+        REQUIRE(ctx.rings == std::vector<std::pair<int, std::int64_t>>{{1, 20}});
+    }
+
+    SECTION("capacity")
+    {
+        for(auto i = 0; i < 256; ++i)
+        {
+            REQUIRE(!timers.schedule_event(machine, milliseconds{10}, events::ring{i}).is_null());
+        }
+        REQUIRE(timers.schedule_event(machine, milliseconds{10}, events::ring{256}).is_null());
+
+        fix.advance(milliseconds{10});
+        REQUIRE(ctx.rings.size() == 256);
+        REQUIRE(!timers.schedule_event(machine, milliseconds{10}, events::ring{256}).is_null());
+    }
+
+    SECTION("large event")
+    {
+        auto event = events::large_ring{};
+        event.text[0] = 'a';
+        timers.schedule_event(machine, milliseconds{10}, event);
+
+        fix.advance(milliseconds{10});
+        REQUIRE(ctx.out == "a");
+    }
+
+    SECTION("scheduling from the machine")
+    {
+        machine.process_event(events::power_button_press{});
+        REQUIRE(timers.pending_count() == 1);
+
+        fix.advance(milliseconds{999});
+        REQUIRE(ctx.out.empty());
+
+        fix.advance(milliseconds{1});
+        REQUIRE(ctx.out == "beep;");
+
+        fix.advance(milliseconds{1000});
+        REQUIRE(ctx.out == "beep;beep;");
+
+        //Exiting the state cancels the timer
+        machine.process_event(events::power_button_press{});
+        REQUIRE(timers.pending_count() == 0);
+
+        fix.advance(seconds{10});
+        REQUIRE(ctx.out == "beep;beep;");
+    }
+}
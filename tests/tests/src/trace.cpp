@@ -0,0 +1,168 @@
+//Copyright Florian Goujeon 2021 - 2023.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+#include <maki.hpp>
+#include "common.hpp"
+
+namespace
+{
+    struct context{};
+
+    namespace events
+    {
+        struct power_button_press{};
+        struct color_button_press{};
+        struct beep_button_press{};
+    }
+
+    namespace states
+    {
+        EMPTY_STATE(off);
+        EMPTY_STATE(emitting_red);
+        EMPTY_STATE(emitting_green);
+        EMPTY_STATE(silent);
+        EMPTY_STATE(beeping);
+
+        constexpr auto on_transition_table = maki::empty_transition_table
+            .add_c<states::emitting_red,   events::color_button_press, states::emitting_green>
+            .add_c<states::emitting_green, events::color_button_press, states::emitting_red>
+        ;
+
+        struct on
+        {
+            static constexpr auto conf = maki::default_submachine_conf
+                .set_transition_tables(on_transition_table)
+                .enable_pretty_name()
+            ;
+
+            static auto pretty_name()
+            {
+                return "ON";
+            }
+        };
+    }
+
+    constexpr auto transition_table = maki::empty_transition_table
+        .add_c<states::off, events::power_button_press, states::on>
+        .add_c<states::on,  events::power_button_press, states::off>
+    ;
+
+    constexpr auto beep_transition_table = maki::empty_transition_table
+        .add_c<states::silent,  maki::any_but<events::power_button_press>, states::beeping>
+        .add_c<states::beeping, events::beep_button_press,                states::silent>
+    ;
+
+    template<std::size_t TraceCapacity>
+    struct machine_def_tpl
+    {
+        static constexpr auto conf = maki::default_machine_conf
+            .set_transition_tables(transition_table, beep_transition_table)
+            .set_context<context>()
+            .set_trace_capacity(TraceCapacity)
+        ;
+    };
+
+    std::int64_t sequence_clock()
+    {
+        static auto value = std::int64_t{0};
+        return value++;
+    }
+
+    struct sequence_clock_machine_def
+    {
+        static constexpr auto conf = machine_def_tpl<8>::conf
+            .set_trace_clock(&sequence_clock)
+        ;
+    };
+
+    template<std::size_t TraceCapacity>
+    using machine_tpl = maki::machine<machine_def_tpl<TraceCapacity>>;
+
+    template<class Machine>
+    std::vector<std::string> decoded_trace(const Machine& machine)
+    {
+        auto strs = std::vector<std::string>{};
+        for(const auto& rec: machine.trace_records())
+        {
+            using decoder = maki::trace_decoder<Machine>;
+            strs.push_back
+            (
+                std::to_string(rec.region_index) + ": " +
+                decoder::source_state_name(rec) + " -> " +
+                decoder::target_state_name(rec) + " (" +
+                (rec.event_id == maki::trace_record::unlisted_event_id ? std::string{"-"} : decoder::event_name(rec)) +
+                ")"
+            );
+        }
+        return strs;
+    }
+}
+
+TEST_CASE("trace")
+{
+    SECTION("records")
+    {
+        using machine_t = machine_tpl<16>;
+        auto machine = machine_t{};
+
+        machine.process_event(events::power_button_press{});
+        machine.process_event(events::color_button_press{});
+        machine.process_event(events::beep_button_press{});
+
+        const auto expected_trace = std::vector<std::string>
+        {
+            "0: stopped -> off (-)",
+            "2: stopped -> silent (-)",
+            "0: off -> ON (power_button_press)",
+            "1: stopped -> emitting_red (power_button_press)",
+            "1: emitting_red -> emitting_green (color_button_press)",
+            "2: silent -> beeping (color_button_press)",
+            "2: beeping -> silent (beep_button_press)"
+        };
+        REQUIRE(decoded_trace(machine) == expected_trace);
+
+        const auto records = machine.trace_records();
+        for(auto i = std::size_t{1}; i < records.size(); ++i)
+        {
+            REQUIRE(records[i - 1].timestamp <= records[i].timestamp);
+        }
+
+        const auto last = maki::trace_decoder<machine_t>::to_string(records.back());
+        REQUIRE(last.find("] region 2: beeping -> silent (beep_button_press)") != std::string::npos);
+    }
+
+    SECTION("overwrite")
+    {
+        auto machine = machine_tpl<4>{};
+
+        machine.process_event(events::power_button_press{});
+        machine.process_event(events::color_button_press{});
+        machine.process_event(events::color_button_press{});
+
+        const auto expected_trace = std::vector<std::string>
+        {
+            "1: stopped -> emitting_red (power_button_press)",
+            "1: emitting_red -> emitting_green (color_button_press)",
+            "2: silent -> beeping (color_button_press)",
+            "1: emitting_green -> emitting_red (color_button_press)"
+        };
+        REQUIRE(decoded_trace(machine) == expected_trace);
+    }
+
+    SECTION("custom clock")
+    {
+        auto machine = maki::machine<sequence_clock_machine_def>{};
+
+        machine.process_event(events::power_button_press{});
+
+        const auto records = machine.trace_records();
+        REQUIRE(records.size() == 4);
+        for(auto i = std::size_t{1}; i < records.size(); ++i)
+        {
+            REQUIRE(records[i].timestamp == records[i - 1].timestamp + 1);
+        }
+    }
+}
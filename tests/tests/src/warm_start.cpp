@@ -0,0 +1,193 @@
+//Copyright Florian Goujeon 2021 - 2023.
+//Distributed under the Boost Software License, Version 1.0.
+//(See accompanying file LICENSE or copy at
+//https://www.boost.org/LICENSE_1_0.txt)
+//Official repository: https://github.com/fgoujeon/maki
+
+#include <maki.hpp>
+#include "common.hpp"
+#include <stdexcept>
+#include <string>
+
+namespace
+{
+    struct context
+    {
+        std::string out;
+    };
+
+    namespace events
+    {
+        struct power_button_press{};
+        struct color_button_press{};
+    }
+
+    template<class Derived>
+    struct logging_state
+    {
+        static constexpr auto conf = maki::default_state_conf
+            .enable_on_entry()
+        ;
+
+        void on_entry(const maki::events::start& /*event*/)
+        {
+            ctx.out += Derived::name;
+            ctx.out += "(start);";
+        }
+
+        template<class Event>
+        void on_entry(const Event& /*event*/)
+        {
+            ctx.out += Derived::name;
+            ctx.out += ";";
+        }
+
+        context& ctx;
+    };
+
+#define LOGGING_STATE(NAME) /*NOLINT(cppcoreguidelines-macro-usage)*/ \
+    struct NAME: logging_state<NAME> \
+    { \
+        static constexpr auto name = #NAME; \
+    };
+
+    namespace states
+    {
+        LOGGING_STATE(booting)
+        LOGGING_STATE(off)
+        LOGGING_STATE(emitting_red)
+        LOGGING_STATE(emitting_green)
+
+        constexpr auto on_transition_table = maki::empty_transition_table
+            .add_c<emitting_red,   events::color_button_press, emitting_green>
+            .add_c<emitting_green, events::color_button_press, emitting_red>
+        ;
+
+        struct on
+        {
+            static constexpr auto conf = maki::default_submachine_conf
+                .set_transition_tables(on_transition_table)
+                .enable_on_entry()
+            ;
+
+            void on_entry()
+            {
+                ctx.out += "on;";
+            }
+
+            context& ctx;
+        };
+    }
+
+#undef LOGGING_STATE
+
+    constexpr auto transition_table = maki::empty_transition_table
+        .add_c<states::booting, maki::null,                  states::off>
+        .add_c<states::off,     events::power_button_press, states::on>
+        .add_c<states::on,      events::power_button_press, states::off>
+    ;
+
+    struct machine_def
+    {
+        static constexpr auto conf = maki::default_machine_conf
+            .set_transition_tables(transition_table)
+            .set_context<context>()
+            .enable_on_entry()
+        ;
+
+        void on_entry()
+        {
+            ctx.out += "machine;";
+        }
+
+        context& ctx;
+    };
+
+    using machine_t = maki::machine<machine_def>;
+
+    constexpr auto on_region_path = maki::region_path_c<machine_def>.add<states::on>();
+
+    machine_t::snapshot_type make_green_snapshot()
+    {
+        auto machine = machine_t{};
+        machine.process_event(events::power_button_press{});
+        machine.process_event(events::color_button_press{});
+        return machine.snapshot();
+    }
+}
+
+TEST_CASE("warm_start")
+{
+    const auto snap = make_green_snapshot();
+
+    SECTION("regular constructor")
+    {
+        auto machine = machine_t{};
+        REQUIRE(machine.is_active_state<states::off>());
+        REQUIRE(machine.context().out == "machine;booting(start);off;");
+    }
+
+    SECTION("warm_start")
+    {
+        auto machine = machine_t{maki::warm_start, snap};
+        auto& ctx = machine.context();
+
+        REQUIRE(ctx.out.empty());
+        REQUIRE(machine.is_active_state<states::on>());
+        REQUIRE(machine.is_active_state<on_region_path, states::emitting_green>());
+
+        machine.process_event(events::color_button_press{});
+        REQUIRE(machine.is_active_state<on_region_path, states::emitting_red>());
+        REQUIRE(ctx.out == "emitting_red;");
+    }
+
+    SECTION("warm_start_with_on_entry")
+    {
+        auto machine = machine_t{maki::warm_start_with_on_entry, snap};
+
+        //From the outermost to the innermost, with no transition
+        REQUIRE(machine.context().out == "machine;on;emitting_green(start);");
+        REQUIRE(machine.is_active_state<on_region_path, states::emitting_green>());
+    }
+
+    SECTION("context arguments")
+    {
+        auto machine = machine_t{maki::warm_start, snap, context{"hello;"}};
+        REQUIRE(machine.context().out == "hello;");
+        REQUIRE(machine.is_active_state<on_region_path, states::emitting_green>());
+    }
+
+    SECTION("stopped snapshot")
+    {
+        auto stopped_snap = snap;
+        {
+            auto machine = machine_t{maki::warm_start, snap};
+            machine.stop();
+            stopped_snap = machine.snapshot();
+        }
+
+        auto machine = machine_t{maki::warm_start_with_on_entry, stopped_snap};
+        REQUIRE(machine.context().out.empty());
+        REQUIRE(!machine.is_running());
+    }
+
+    SECTION("invalid snapshot")
+    {
+        auto invalid_snap = snap;
+        ++invalid_snap.layout_hash;
+
+        REQUIRE_THROWS_AS((machine_t{maki::warm_start, invalid_snap}), std::invalid_argument);
+        REQUIRE_THROWS_AS((machine_t{maki::warm_start_with_on_entry, invalid_snap}), std::invalid_argument);
+
+        //Inconsistent configuration
+        auto inconsistent_snap = snap;
+        inconsistent_snap.active_state_indexes[0] = 0; //booting, with the region of on running
+        REQUIRE_THROWS_AS((machine_t{maki::warm_start, inconsistent_snap}), std::invalid_argument);
+
+        //Fallback to a regular start
+        auto machine = machine_t{};
+        REQUIRE(!machine.restore(invalid_snap));
+        REQUIRE(machine.is_active_state<states::off>());
+        REQUIRE(machine.context().out == "machine;booting(start);off;");
+    }
+}